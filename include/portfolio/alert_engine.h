@@ -0,0 +1,80 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALERT_ENGINE_H
+#define ALERT_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "portfolio_core.h"
+
+#define ALERT_CONDITION_LEN 128
+
+
+typedef enum {
+    ALERT_PRICE_ABOVE = 0,   /* price moves up through the threshold */
+    ALERT_PRICE_BELOW,       /* price moves down through the threshold */
+    ALERT_PRICE_CROSS,       /* whichever of the two leads away from the price when first known */
+    ALERT_CONDITION          /* screener expression turns true, e.g. "rsi14_1h < 25" */
+} AlertKind;
+
+
+typedef struct {
+    int id;
+    AlertKind kind;           /* ABOVE or BELOW for a resolved CROSS */
+    const char *symbol;
+    double threshold;
+    double price;             /* price at delivery, 0 when not known */
+    const char *condition;
+} AlertEvent;
+
+typedef void (*AlertCallback)(const AlertEvent *event, void *user_data);
+
+/* Price alerts sit in per-symbol arrays sorted by threshold, one for
+ * upward and one for downward crossings, so a tick from p0 to p1 finds
+ * the crossed range by binary search and touches only the k alerts in
+ * it: O(log n + k). They fire once and are removed.
+ *
+ * Condition alerts are screener expressions over the pair's row of the
+ * portfolio columns. Each records the series its columns come from and
+ * is evaluated only when one of them changes; it fires each time the
+ * expression goes from false to true.
+ *
+ * The callback runs synchronously and must not add or remove alerts. */
+typedef struct AlertEngine AlertEngine;
+
+
+AlertEngine* alert_engine_create(AlertCallback callback, void *user_data);
+void alert_engine_destroy(AlertEngine *engine);
+
+int alert_engine_add_price(AlertEngine *engine, const char *symbol, AlertKind kind, double threshold);
+int alert_engine_add_condition(AlertEngine *engine, const char *symbol, const char *condition,
+                               char *error, size_t error_size);
+bool alert_engine_remove(AlertEngine *engine, int id);
+int alert_engine_count(const AlertEngine *engine);
+
+/* One alert per line: "<symbol> above|below|cross <price>" or
+ * "<symbol> when <expression>"; '#' starts a comment. Returns the number
+ * of alerts added. */
+int alert_engine_load(AlertEngine *engine, const char *path);
+
+int alert_engine_on_price(AlertEngine *engine, const char *symbol, double price);
+int alert_engine_on_series(AlertEngine *engine, const TradingPair *pair, SeriesId series);
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include <stdbool.h>
+#include "portfolio_core.h"
+#include "scalping_bot.h"
+
+#define BACKTEST_CANDLE_MS (5 * 60 * 1000LL)
+
+
+typedef struct {
+    double initial_balance;
+    double trade_amount;
+    int cooldown_seconds;
+    ScalpParams params;
+    int equity_stride;          /* candles per equity point; 0 or 1 keeps every candle */
+    const ExecutionModel *execution;    /* NULL fills at the candle close */
+    const BotStrategy *strategy;        /* NULL for bot_strategy_default() */
+} BacktestConfig;
+
+
+typedef struct {
+    long long time_ms;
+    double equity;
+} EquityPoint;
+
+
+typedef struct {
+    TradeRecord *trades;
+    int trade_count;
+    int trade_capacity;
+    
+    EquityPoint *equity;
+    int equity_count;
+    int equity_capacity;
+    
+    long candles;
+    double final_equity;
+    double roi;                 /* percent */
+    double max_drawdown;        /* fraction of the peak, marked at fills and candle closes */
+    double sharpe;              /* annualized, from per-candle equity returns */
+    int total_trades;
+    int winning_trades;
+    int losing_trades;
+    int cancelled_orders;
+} BacktestResult;
+
+
+/* Replays closed 5m candles through the production scalping analyzer and a
+ * single ScalpingBot, with the bot's clock following candle close times and
+ * its logging silenced. Each candle is handled as the live app sees a
+ * fresh fetch: the candle is the forming one, the signal is re-evaluated
+ * and the bot is offered it. The 15m confirmation series is aggregated
+ * from the 5m candles. After the strategy's on_candle, its on_tick sees
+ * the close. With an execution model, orders still pending settle along
+ * each candle's path from open through the extreme against the order,
+ * then the other extreme, to the close. */
+void backtest_config_default(BacktestConfig *config);
+bool backtest_run(const BacktestConfig *config, const char *symbol,
+                  const Candle *candles, int count, BacktestResult *result);
+void backtest_result_free(BacktestResult *result);
+
+#endif
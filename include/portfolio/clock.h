@@ -0,0 +1,53 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdbool.h>
+#include <time.h>
+
+
+/* Source of wall time in ms since the epoch. set_ms is NULL for clocks
+ * that cannot be moved. */
+typedef struct Clock {
+    long long (*now_ms)(const struct Clock *clock);
+    void (*set_ms)(struct Clock *clock, long long now_ms);
+    void *impl_data;
+} Clock;
+
+
+Clock* clock_real(void);
+
+/* Starts at start_ms and runs at rate times real time; rate 0 keeps it
+ * still between clock_set and clock_advance calls. */
+Clock* clock_virtual_create(long long start_ms, double rate);
+void clock_destroy(Clock *clock);
+
+/* The clock behind NULL arguments, clock_real unless replaced. Swap it
+ * before other threads start reading it. */
+Clock* clock_default(void);
+void clock_set_default(Clock *clock);
+
+long long clock_now_ms(const Clock *clock);
+time_t clock_now(const Clock *clock);
+bool clock_set(Clock *clock, long long now_ms);
+bool clock_advance(Clock *clock, long long delta_ms);
+
+#endif
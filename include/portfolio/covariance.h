@@ -0,0 +1,63 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COVARIANCE_H
+#define COVARIANCE_H
+
+#include <stdbool.h>
+
+
+typedef struct CovarianceMatrix CovarianceMatrix;
+
+
+typedef struct {
+    double portfolio_volatility;   /* per-sample deviation of the weighted return */
+    double weighted_volatility;    /* sum of weight * deviation over the symbols */
+    double diversification_ratio;  /* weighted / portfolio volatility, 1 = no diversification */
+    double effective_bets;         /* diversification_ratio squared */
+    double average_correlation;    /* weight-weighted mean of the off-diagonal correlations */
+    double max_correlation;        /* between most_correlated_a and _b; both 0 with one symbol */
+    int most_correlated_a, most_correlated_b;
+} DiversificationMetrics;
+
+
+/* Rolling covariance of the last window return vectors over symbols.
+ * Each push is a rank-1 update of the raw cross products, plus a rank-1
+ * downdate once the window is full, so it costs O(symbols^2) however long
+ * the window is. */
+CovarianceMatrix* covariance_create(int symbols, int window);
+void covariance_destroy(CovarianceMatrix *matrix);
+void covariance_reset(CovarianceMatrix *matrix);
+
+int covariance_symbols(const CovarianceMatrix *matrix);
+int covariance_samples(const CovarianceMatrix *matrix);
+
+bool covariance_push(CovarianceMatrix *matrix, const double *returns);
+
+double covariance_get(const CovarianceMatrix *matrix, int i, int j);
+double correlation_get(const CovarianceMatrix *matrix, int i, int j);
+double covariance_mean(const CovarianceMatrix *matrix, int i);
+bool covariance_fill(const CovarianceMatrix *matrix, double *out);
+
+/* weights may be NULL for an equal-weight portfolio; a negative weight is
+ * a short position. */
+bool covariance_diversification(const CovarianceMatrix *matrix, const double *weights,
+                                DiversificationMetrics *metrics);
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMA_BANK_H
+#define EMA_BANK_H
+
+#include <stdbool.h>
+
+
+/* EMAs for many periods from a single pass over prices. Each period
+ * gives exactly what calculate_ema(prices, count, period) gives: the SMA
+ * of the first period closes as seed, 0.0 when count < period.
+ *
+ * last[i] receives the EMA for periods[i] over all count prices;
+ * previous[i], when previous is not NULL, the EMA over the first
+ * count - 1. Periods may come in any order and may repeat. */
+bool ema_bank_compute(const double *prices, int count, const int *periods, int period_count,
+                      double *last, double *previous);
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EQUITY_SERIES_H
+#define EQUITY_SERIES_H
+
+#define EQUITY_LEVELS 4
+#define EQUITY_POINTS 128
+#define EQUITY_BASE_MS 10000LL
+#define EQUITY_LEVEL_FACTOR 8
+
+
+/* Equity over one bucket, keyed by the bucket's start. */
+typedef struct {
+    long long time_ms;
+    double close;
+    double low;
+} EquitySample;
+
+
+typedef struct {
+    EquitySample points[EQUITY_POINTS];
+    int head;                   /* oldest point */
+    int count;
+    long long span_ms;
+} EquityLevel;
+
+
+/* The same equity at EQUITY_LEVELS resolutions, each level's buckets
+ * EQUITY_LEVEL_FACTOR times wider than the one below and each a ring of
+ * EQUITY_POINTS. With the defaults that is 10 s buckets over the last
+ * 21 minutes up to 85 minute buckets over a week, in fixed memory. Every
+ * level folds each sample in directly, so a push costs EQUITY_LEVELS
+ * updates and no level is built from another's rounding. */
+typedef struct {
+    EquityLevel levels[EQUITY_LEVELS];
+} EquitySeries;
+
+
+void equity_series_init(EquitySeries *series);
+void equity_series_push(EquitySeries *series, long long time_ms, double equity);
+
+int equity_series_count(const EquitySeries *series, int level);
+const EquitySample* equity_series_point(const EquitySeries *series, int level, int index);
+int equity_series_level_for(const EquitySeries *series, long long from_ms);
+int equity_series_window(const EquitySeries *series, long long from_ms, EquitySample *out, int max_points);
+
+#endif
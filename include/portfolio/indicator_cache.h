@@ -0,0 +1,66 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef INDICATOR_CACHE_H
+#define INDICATOR_CACHE_H
+
+#include <stdbool.h>
+
+#define INDICATOR_CACHE_SLOTS 32
+#define INDICATOR_CACHE_VALUES 5
+
+
+typedef enum {
+    INDICATOR_VOLATILITY = 0,
+    INDICATOR_TREND,
+    INDICATOR_EMA,
+    INDICATOR_MACD,
+    INDICATOR_BOLLINGER,
+    INDICATOR_EMA_CROSS,
+    INDICATOR_DOUBLE_BOTTOM,
+    INDICATOR_DOUBLE_TOP,
+    INDICATOR_HEAD_SHOULDERS,
+    INDICATOR_INV_HEAD_SHOULDERS,
+    INDICATOR_TARGET_SIM
+} IndicatorKind;
+
+
+/* One memoized result. key == 0 marks an empty slot; version is the
+ * series version the values were computed from. */
+typedef struct {
+    unsigned int key;
+    unsigned int version;
+    double values[INDICATOR_CACHE_VALUES];
+} IndicatorCacheEntry;
+
+typedef struct {
+    IndicatorCacheEntry entries[INDICATOR_CACHE_SLOTS];
+    unsigned int hits;
+    unsigned int misses;
+} IndicatorCache;
+
+
+unsigned int indicator_cache_key(IndicatorKind kind, int series, int param);
+bool indicator_cache_get(IndicatorCache *cache, unsigned int key, unsigned int version,
+                         double *values, int count);
+void indicator_cache_put(IndicatorCache *cache, unsigned int key, unsigned int version,
+                         const double *values, int count);
+void indicator_cache_clear(IndicatorCache *cache);
+
+#endif
@@ -26,7 +26,7 @@
 
 typedef void (*PriceUpdateCallback)(int pair_index, double price, void *user_data);
 typedef void (*HistoricalDataCallback)(int pair_index, double *prices, int count, void *user_data);
-typedef void (*MultiTimeframeCallback)(int pair_index, const char *interval, double *prices, int count, void *user_data);
+typedef void (*MultiTimeframeCallback)(int pair_index, const char *interval, const Candle *candles, int count, void *user_data);
 
 
 typedef struct NetworkManager {
@@ -0,0 +1,111 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef OHLC_STREAM_H
+#define OHLC_STREAM_H
+
+#include <stdbool.h>
+
+#define OHLC_MAX_WINDOW 64
+
+
+typedef struct {
+    long long open_time;   /* ms since the epoch, as reported by the exchange */
+    double open;
+    double high;
+    double low;
+    double close;
+    double volume;
+} Candle;
+
+
+typedef struct {
+    double atr;
+    double vwap;
+    double stoch_k, stoch_d;
+    double plus_di, minus_di, adx;
+    double obv;
+    double keltner_upper, keltner_middle, keltner_lower;
+    bool atr_ready;
+    bool stoch_ready;
+    bool adx_ready;
+    bool keltner_ready;
+} OhlcValues;
+
+
+typedef struct {
+    int index;
+    double value;
+} OhlcDequeEntry;
+
+/* Monotonic ring deque holding the window max (or min) candidates. */
+typedef struct {
+    OhlcDequeEntry entries[OHLC_MAX_WINDOW];
+    int head;
+    int count;
+} OhlcDeque;
+
+
+/* Candle-driven indicator state. Every push is O(1): ATR and ADX/DMI use
+ * Wilder smoothing, the stochastic window extremes come from monotonic
+ * deques, VWAP restarts at each UTC day and Keltner channels sit
+ * keltner_mult ATRs around an EMA of the close. */
+typedef struct {
+    int atr_period;
+    int stoch_period;
+    int stoch_smooth;
+    int adx_period;
+    int keltner_period;
+    double keltner_mult;
+    
+    long samples;
+    double prev_close, prev_high, prev_low;
+    
+    double tr_sum, atr;
+    
+    long long session_day;
+    double session_pv, session_volume;
+    
+    OhlcDeque highs, lows;
+    double k_ring[OHLC_MAX_WINDOW];
+    long k_count;
+    double k_sum;
+    
+    double tr_smooth, plus_dm_smooth, minus_dm_smooth;
+    double dx_sum, adx;
+    long dx_count;
+    
+    double obv;
+    
+    double ema_sum, ema;
+} OhlcStream;
+
+
+void ohlc_stream_init(OhlcStream *stream, int atr_period, int stoch_period, int stoch_smooth,
+                      int adx_period, int keltner_period, double keltner_mult);
+void ohlc_stream_reset(OhlcStream *stream);
+void ohlc_stream_push(OhlcStream *stream, const Candle *candle);
+void ohlc_stream_backfill(OhlcStream *stream, const Candle *candles, int count);
+
+void ohlc_stream_values(const OhlcStream *stream, OhlcValues *values);
+void ohlc_stream_peek(const OhlcStream *stream, const Candle *forming, OhlcValues *values);
+
+int ohlc_compute_series(const Candle *candles, int count, OhlcValues *values);
+
+#endif
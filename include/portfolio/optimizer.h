@@ -0,0 +1,52 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <stdbool.h>
+
+
+typedef enum {
+    OPTIMIZER_MIN_VARIANCE = 0,
+    OPTIMIZER_MEAN_VARIANCE,
+    OPTIMIZER_RISK_PARITY
+} OptimizerObjective;
+
+
+typedef struct {
+    OptimizerObjective objective;
+    double risk_aversion;   /* mean-variance: minimizes risk_aversion / 2 * w'Sw - mu'w */
+    int max_iterations;
+    double tolerance;       /* relative KKT gap (quadratic) or weight change (risk parity) */
+} OptimizerOptions;
+
+
+void optimizer_default_options(OptimizerOptions *options, OptimizerObjective objective);
+
+/* Long-only, fully invested target weights for n assets. covariance is
+ * n x n row-major; expected_returns is only read for mean-variance.
+ * Min- and mean-variance run pairwise (SMO) steps on the simplex at O(n)
+ * each; risk parity runs cyclic coordinate descent on the log-barrier
+ * form at O(n^2) per sweep. Returns the steps or sweeps used, or -1 on
+ * bad input. */
+int optimizer_solve(const double *covariance, const double *expected_returns, int n,
+                    const OptimizerOptions *options, double *weights);
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATH_SIM_H
+#define PATH_SIM_H
+
+#include <stdbool.h>
+
+#define PATH_SIM_MAX_STEPS 2048
+
+
+typedef enum {
+    PATH_SIM_BOOTSTRAP = 0,   /* resample the series' own log returns */
+    PATH_SIM_GBM              /* normal log returns with the series' mean and deviation */
+} PathSimModel;
+
+
+/* One first-passage question: how often, and how soon, does a path
+ * starting at start_price touch target_price within steps candles of
+ * step_hours each? closes is the calibration series. */
+typedef struct {
+    PathSimModel model;
+    const double *closes;
+    int count;
+    double step_hours;
+    int steps;
+    int paths;
+    unsigned long long seed;
+    double start_price;
+    double target_price;
+    double sigma;          /* per-step deviation for GBM; 0 estimates it from closes */
+} PathSimJob;
+
+
+/* The hour figures are quantiles of the hitting time over the paths that
+ * reached the target; they are 0 when none did. */
+typedef struct {
+    double probability;
+    double mean_hours;
+    double p25_hours, median_hours, p75_hours;
+    int paths;
+    int hits;
+} PathSimResult;
+
+
+/* Simulates every job on the default worker pool, all in one batch, and
+ * returns how many jobs produced a result. A job whose series has fewer
+ * than two usable closes yields a zeroed result with paths == 0. */
+int path_sim_run(const PathSimJob *jobs, int job_count, PathSimResult *results);
+bool path_sim_first_passage(const PathSimJob *job, PathSimResult *result);
+
+#endif
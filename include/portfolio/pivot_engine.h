@@ -0,0 +1,75 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PIVOT_ENGINE_H
+#define PIVOT_ENGINE_H
+
+#include <stdbool.h>
+
+#define PIVOT_WINDOW 5
+#define PIVOT_MAX_LEVELS 31
+
+
+typedef struct {
+    int *index;
+    int count;
+    int capacity;
+} PivotList;
+
+
+/* Swing pivots over a price series, extended one candle at a time.
+ * A close is a swing high (low) when no close within PIVOT_WINDOW
+ * candles on either side is higher (lower), so a pivot is confirmed
+ * PIVOT_WINDOW candles after it prints. Range max/min queries are served
+ * in O(1) from a sparse table that grows in O(log n) per appended candle.
+ *
+ * The tracker keeps everything appended since the last rebuild; the
+ * live series is the window starting at window_start. Pattern indices
+ * are reported relative to that window. A zeroed tracker is empty and
+ * ready to use. */
+typedef struct {
+    double *prices;
+    int count;
+    int capacity;
+    int window_start;
+    double *range_max[PIVOT_MAX_LEVELS];
+    double *range_min[PIVOT_MAX_LEVELS];
+    PivotList highs;
+    PivotList lows;
+} PivotTracker;
+
+
+void pivot_tracker_free(PivotTracker *tracker);
+void pivot_tracker_clear(PivotTracker *tracker);
+bool pivot_tracker_append(PivotTracker *tracker, double price);
+void pivot_tracker_truncate(PivotTracker *tracker, int count);
+bool pivot_tracker_build(PivotTracker *tracker, const double *prices, int count);
+bool pivot_tracker_sync(PivotTracker *tracker, const double *prices, int count);
+
+int pivot_tracker_window_count(const PivotTracker *tracker);
+double pivot_range_max(const PivotTracker *tracker, int from, int to);
+double pivot_range_min(const PivotTracker *tracker, int from, int to);
+
+
+bool pivot_detect_double_bottom(const PivotTracker *tracker, int *pattern_idx);
+bool pivot_detect_double_top(const PivotTracker *tracker, int *pattern_idx);
+bool pivot_detect_head_shoulders(const PivotTracker *tracker, int *pattern_idx);
+bool pivot_detect_inverse_head_shoulders(const PivotTracker *tracker, int *pattern_idx);
+
+#endif
@@ -22,6 +22,18 @@
 
 #include <time.h>
 #include <stdbool.h>
+#include "indicator_cache.h"
+#include "rsi_stream.h"
+#include "pivot_engine.h"
+#include "ohlc_stream.h"
+#include "trend_consensus.h"
+#include "covariance.h"
+#include "optimizer.h"
+#include "volume_profile.h"
+#include "volatility_stream.h"
+#include "scalp_stream.h"
+#include "screener.h"
+#include "clock.h"
 
 #define MAX_PAIRS 10
 #define MAX_SYMBOL_LEN 16
@@ -34,7 +46,9 @@
 #define HISTORICAL_DATA_SIZE_1H 500   
 #define HISTORICAL_DATA_SIZE_4H 200   
 #define HISTORICAL_DATA_SIZE_1D 100   
-#define MAX_PATTERN_TEXT 256
+#define MAX_PATTERN_TEXT 512
+#define COVARIANCE_WINDOW 168
+#define COVARIANCE_MIN_SAMPLES 24
 
 
 typedef enum {
@@ -43,6 +57,79 @@ typedef enum {
 } PositionType;
 
 
+typedef enum {
+    SERIES_TICK = 0,
+    SERIES_LEGACY,
+    SERIES_5M,
+    SERIES_15M,
+    SERIES_1H,
+    SERIES_4H,
+    SERIES_1D,
+    SERIES_COUNT
+} SeriesId;
+
+
+typedef enum {
+    PATTERN_DOUBLE_BOTTOM = 0,
+    PATTERN_DOUBLE_TOP,
+    PATTERN_INV_HEAD_SHOULDERS,
+    PATTERN_HEAD_SHOULDERS,
+    PATTERN_GOLDEN_CROSS,
+    PATTERN_DEATH_CROSS,
+    PATTERN_KIND_COUNT
+} PatternKind;
+
+
+/* Scalping verdict packed as side, strength and reason bits, so callers
+ * can switch on it or test a single bit; scalp_signal_text gives the label. */
+typedef enum {
+    SCALP_SIDE_BUY = 0x01,
+    SCALP_SIDE_SELL = 0x02,
+    SCALP_STRONG = 0x04,
+    
+    SCALP_REASON_MOMENTUM = 0x10,
+    SCALP_REASON_REVERSAL = 0x20,
+    SCALP_REASON_RANGING = 0x30,
+    SCALP_REASON_HOLD = 0x40,
+    SCALP_REASON_MASK = 0x70
+} ScalpSignalBits;
+
+typedef enum {
+    SCALP_WAIT = 0,
+    SCALP_BUY_NOW = SCALP_SIDE_BUY | SCALP_STRONG | SCALP_REASON_MOMENTUM,
+    SCALP_BUY_SIGNAL = SCALP_SIDE_BUY | SCALP_REASON_MOMENTUM,
+    SCALP_SELL_NOW = SCALP_SIDE_SELL | SCALP_STRONG | SCALP_REASON_MOMENTUM,
+    SCALP_SELL_SIGNAL = SCALP_SIDE_SELL | SCALP_REASON_MOMENTUM,
+    SCALP_BUY_DIP = SCALP_SIDE_BUY | SCALP_REASON_REVERSAL,
+    SCALP_SELL_BOUNCE = SCALP_SIDE_SELL | SCALP_REASON_REVERSAL,
+    SCALP_RANGING = SCALP_REASON_RANGING,
+    SCALP_HOLD = SCALP_REASON_HOLD
+} ScalpSignal;
+
+
+/* Scalping thresholds. The move limits are fractions of the 5m ATR in
+ * percent of price; without an ATR they apply to an assumed ATR of 0.1%. */
+typedef struct {
+    double weak_move;           /* 0.05 */
+    double strong_move;         /* 0.15 */
+    double flat_move;           /* 0.03 */
+    double rsi_overbought;      /* 70: no momentum buys above */
+    double rsi_oversold;        /* 30: no momentum sells below */
+    double rsi_dip;             /* 40: dip buys in an uptrend below */
+    double rsi_bounce;          /* 60: bounce sells in a downtrend above */
+} ScalpParams;
+
+
+/* Patterns found on one series: bit (1u << kind) is set in mask when the
+ * pattern was found, and index[kind] holds the candle that completed it
+ * (-1 for EMA crosses). version is the series version that was scanned. */
+typedef struct {
+    unsigned int mask;
+    int index[PATTERN_KIND_COUNT];
+    unsigned int version;
+} PatternHits;
+
+
 typedef struct {
     char symbol[MAX_SYMBOL_LEN];
     double bought_price;      
@@ -94,17 +181,54 @@ typedef struct {
     
     double scalp_trend;        
     double scalp_momentum;     
-    char scalp_signal[64];     
+    ScalpSignal scalp_signal;
+    ScalpParams scalp_params;
     
     
     double profit_probability;  
-    char detected_patterns[MAX_PATTERN_TEXT];
-    int pattern_count;
+    PatternHits patterns[SERIES_COUNT];
+    
+    
+    unsigned int series_version[SERIES_COUNT];
+    IndicatorCache indicator_cache;
+    RsiStream rsi_stream[SERIES_COUNT];
+    PivotTracker pivots[SERIES_COUNT];
+    
+    
+    Candle candles_5m[HISTORICAL_DATA_SIZE_5M];
+    Candle candles_15m[HISTORICAL_DATA_SIZE_15M];
+    Candle candles_1h[HISTORICAL_DATA_SIZE_1H];
+    Candle candles_4h[HISTORICAL_DATA_SIZE_4H];
+    Candle candles_1d[HISTORICAL_DATA_SIZE_1D];
+    int candle_count[SERIES_COUNT];
+    OhlcStream ohlc_stream[SERIES_COUNT];
+    OhlcValues ohlc[SERIES_COUNT];
+    VolatilityStream volatility[SERIES_COUNT];
+    ScalpStream scalp_5m, scalp_15m;
+    
+    /* Slot in the bot manager's routing table, valid while the
+     * generation matches; see bot_dispatch_signal. */
+    int bot_route;
+    unsigned int bot_route_generation;
+    TrendConsensus trend;
+    VolumeProfile volume_profile;
+    VolumeLevels volume_levels;
 } TradingPair;
 
+/* Return covariance across the pairs over aligned, closed 1h candles.
+ * symbols[i] is the pair behind matrix row i; last_open_time is the
+ * newest candle already pushed. */
+typedef struct {
+    CovarianceMatrix *matrix;
+    char symbols[MAX_PAIRS][MAX_SYMBOL_LEN];
+    int symbol_count;
+    long long last_open_time;
+} PortfolioCovariance;
+
 typedef struct {
     TradingPair pairs[MAX_PAIRS];
     int pair_count;
+    PortfolioCovariance covariance;
 } Portfolio;
 
 typedef struct {
@@ -141,31 +265,63 @@ typedef struct {
     double expected_profit_loss;  
     double expected_profit_pct;   
     int estimated_hours;          
+    int hours_p25, hours_p75;     
     char confidence_level[32];    
     char reasoning[128];          
 } TargetAnalysis;
 
 
+/* Suggested change for one pair; index matches portfolio->pairs. */
+typedef struct {
+    bool optimized;               /* false for shorts and unpriced pairs, which keep their size */
+    double current_weight;
+    double target_weight;
+    double value_delta;           /* quote currency to buy (+) or sell (-) */
+    double quantity_delta;
+} RebalanceSuggestion;
+
+
 Portfolio* portfolio_create(void);
 void portfolio_destroy(Portfolio *portfolio);
 void portfolio_init_default(Portfolio *portfolio);
 bool portfolio_load(Portfolio *portfolio);
 void portfolio_save(Portfolio *portfolio);
 char* portfolio_get_file_path(void);
+char* portfolio_get_config_path(const char *file_name);
 
 
 int portfolio_add_pair(Portfolio *portfolio, const char *symbol, double bought_price, 
                        double quantity, PositionType position_type);
+void portfolio_pair_init(TradingPair *pair, const char *symbol, double bought_price,
+                         double quantity, PositionType position_type);
 void portfolio_remove_pair(Portfolio *portfolio, int index);
 void portfolio_update_pair(Portfolio *portfolio, int index, const char *symbol, 
                           double bought_price, double quantity, PositionType position_type);
 void portfolio_update_current_price(Portfolio *portfolio, int index, double price);
 
 
+SeriesId portfolio_series_from_interval(const char *interval);
+const char* portfolio_series_name(SeriesId series);
+int portfolio_store_series(TradingPair *pair, SeriesId series, const double *prices, int count);
+const double* portfolio_series_data(const TradingPair *pair, SeriesId series, int *count);
+int portfolio_store_candles(TradingPair *pair, SeriesId series, const Candle *candles, int count);
+const Candle* portfolio_series_candles(const TradingPair *pair, SeriesId series, int *count);
+const OhlcValues* portfolio_series_ohlc(const TradingPair *pair, SeriesId series);
+unsigned int portfolio_series_version(const TradingPair *pair, SeriesId series);
+void portfolio_touch_series(TradingPair *pair, SeriesId series);
+IndicatorCache* portfolio_indicator_cache(const TradingPair *pair);
+void portfolio_set_trend_weight(TradingPair *pair, SeriesId series, double weight);
+int portfolio_series_trend(const TradingPair *pair, SeriesId series);
+const VolumeLevels* portfolio_volume_levels(const TradingPair *pair);
+double portfolio_series_volatility(const TradingPair *pair, SeriesId series, VolEstimator estimator);
+double portfolio_annualized_volatility(const TradingPair *pair);
+
+
 int portfolio_calculate_trend(const TradingPair *pair);
 double portfolio_calculate_momentum(const TradingPair *pair);
 double portfolio_calculate_volatility(const TradingPair *pair);
 double portfolio_calculate_rsi(const TradingPair *pair);
+double portfolio_series_rsi(const TradingPair *pair, SeriesId series, int period);
 void portfolio_calculate_support_resistance(const TradingPair *pair, double *support, double *resistance);
 void portfolio_calculate_trade_prices(const TradingPair *pair, double *buy_price, double *sell_price, 
                                        char *buy_reason, char *sell_reason);
@@ -194,17 +350,31 @@ bool detect_inverse_head_shoulders(const double *prices, int count, int *pattern
 int calculate_trend_multi_timeframe(const TradingPair *pair);
 double calculate_profit_probability(const TradingPair *pair);
 void update_all_indicators(TradingPair *pair);
+void scan_all_patterns(TradingPair *pair);
+const char* pattern_kind_name(PatternKind kind);
+int format_pattern_hits(const TradingPair *pair, char *buffer, size_t size);
 
 
+double evaluate_scalping_signals(TradingPair *pair);
 void analyze_scalping_signals(TradingPair *pair);
+bool analyze_scalping_tick(TradingPair *pair, double price, long long now_ms);
 int get_scalping_trend(const TradingPair *pair);
 double get_scalping_momentum(const TradingPair *pair);
 const char* get_scalping_signal(const TradingPair *pair);
+const char* scalp_signal_text(ScalpSignal signal);
+void scalp_params_default(ScalpParams *params);
 bool is_scalp_buy_signal(const TradingPair *pair);
 bool is_scalp_sell_signal(const TradingPair *pair);
 
 
 void portfolio_analyze_performance(Portfolio *portfolio, PerformanceItem *items, int *item_count);
+int portfolio_update_covariance(Portfolio *portfolio);
+bool portfolio_diversification(const Portfolio *portfolio, DiversificationMetrics *metrics);
+int portfolio_optimize(const Portfolio *portfolio, OptimizerObjective objective,
+                       RebalanceSuggestion *suggestions);
+void portfolio_screener_columns(ScreenerTable *table);
+int portfolio_screener_fill_pair(const TradingPair *pair, ScreenerTable *table);
+SeriesId portfolio_screener_column_series(const char *name);
 const char* portfolio_get_recommendation_text(const TradingPair *pair, double profit_percent, 
                                                int trend, double momentum);
 const char* portfolio_get_recommendation_color(const TradingPair *pair, double profit_percent, 
@@ -0,0 +1,51 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RSI_STREAM_H
+#define RSI_STREAM_H
+
+#include <stdbool.h>
+
+#define RSI_STREAM_MAX_PERIODS 4
+
+
+/* Wilder-smoothed RSI for several periods fed from one close stream.
+ * Each period is seeded with the simple mean of its first N deltas and
+ * smoothed with avg = (avg * (N - 1) + x) / N afterwards. */
+typedef struct {
+    int periods[RSI_STREAM_MAX_PERIODS];
+    int period_count;
+    double avg_gain[RSI_STREAM_MAX_PERIODS];
+    double avg_loss[RSI_STREAM_MAX_PERIODS];
+    long samples;
+    double last_close;
+    bool has_close;
+} RsiStream;
+
+
+void rsi_stream_init(RsiStream *stream, const int *periods, int period_count);
+void rsi_stream_reset(RsiStream *stream);
+void rsi_stream_push(RsiStream *stream, double close);
+void rsi_stream_push_many(RsiStream *stream, const double *closes, int count);
+
+bool rsi_stream_ready(const RsiStream *stream, int period);
+double rsi_stream_value(const RsiStream *stream, int period);
+double rsi_stream_peek(const RsiStream *stream, int period, double close);
+
+#endif
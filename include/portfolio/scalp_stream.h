@@ -0,0 +1,63 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCALP_STREAM_H
+#define SCALP_STREAM_H
+
+#include <stdbool.h>
+#include "ohlc_stream.h"
+#include "rsi_stream.h"
+
+#define SCALP_MAX_EMAS 4
+#define SCALP_MOMENTUM_PERIOD 10
+#define SCALP_MAX_ROLLOVER 64
+
+
+/* One timeframe of closes seen as committed candles plus the one still
+ * forming. EMAs, Wilder RSI and the momentum window hold only closed
+ * candles, so each reading folds the forming close in on the fly, and
+ * each price tick is O(1): it moves the forming close, or commits it
+ * when the tick lands past the candle's end. Readings match what the
+ * batch indicators give over the same closes with the forming one last. */
+typedef struct {
+    long long interval_ms;
+    long long open_time;        /* of the forming candle, 0 before the first load */
+    double forming_close;
+    long closed;
+    
+    int ema_periods[SCALP_MAX_EMAS];
+    int ema_count;
+    double ema[SCALP_MAX_EMAS];
+    double ema_seed[SCALP_MAX_EMAS];
+    
+    RsiStream rsi;
+    double recent[SCALP_MOMENTUM_PERIOD];
+} ScalpStream;
+
+
+void scalp_stream_init(ScalpStream *stream, long long interval_ms, const int *ema_periods, int ema_count);
+void scalp_stream_load(ScalpStream *stream, const Candle *candles, int count);
+void scalp_stream_tick(ScalpStream *stream, double price, long long now_ms);
+
+int scalp_stream_count(const ScalpStream *stream);
+double scalp_stream_close(const ScalpStream *stream, int back);
+double scalp_stream_ema(const ScalpStream *stream, int index);
+double scalp_stream_rsi(const ScalpStream *stream, int period);
+
+#endif
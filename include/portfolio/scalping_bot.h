@@ -21,11 +21,17 @@
 #define SCALPING_BOT_H
 
 #include "portfolio_core.h"
+#include "trade_journal.h"
+#include "equity_series.h"
 #include <time.h>
 #include <stdbool.h>
 
-#define MAX_BOTS 5
+#define MAX_BOTS 65536
+#define BOT_CHUNK_SIZE 256
 #define MAX_TRADES_HISTORY 100
+#define BOT_COOLDOWN_SECONDS 30
+#define BOT_JOURNAL_COMPACT_AT 4096
+#define BOT_MAX_STRATEGIES 16
 
 
 #define MAKER_FEE 0.001   
@@ -39,6 +45,60 @@ typedef enum {
 } BotStatus;
 
 
+/* How orders meet the book. FILL_AUTO takes liquidity on strong signals
+ * and posts at the touch otherwise. */
+typedef enum {
+    FILL_TAKER = 0,
+    FILL_MAKER,
+    FILL_AUTO
+} FillPolicy;
+
+
+typedef struct {
+    double spread_bps;          /* full quoted spread around the mid */
+    double level_usd;           /* quote resting at each book level, 0 for unlimited */
+    double level_step_bps;      /* distance between levels */
+    int latency_ms;             /* from signal to the order reaching the book */
+    int maker_timeout_ms;       /* passive orders unfilled after this are cancelled */
+    double maker_fee;
+    double taker_fee;
+    FillPolicy policy;
+} FillParams;
+
+
+typedef struct {
+    double price;               /* average over the levels taken */
+    double quantity;            /* base filled, before fees */
+} Fill;
+
+
+/* take fills a market order of amount (quote to spend on a buy, base to
+ * sell on a sell) against the book around mid. The default walks a
+ * synthetic book built from params; a model with real depth can replace
+ * it and keep its book in impl_data. take must not modify the model. */
+typedef struct ExecutionModel {
+    void (*take)(const struct ExecutionModel *model, bool buy, double mid, double amount, Fill *fill);
+    FillParams params;
+    void *impl_data;
+} ExecutionModel;
+
+
+/* An order waiting out its latency, or resting at limit until it fills
+ * or expires_ms passes. */
+typedef struct {
+    bool pending;
+    bool buy;
+    bool maker;
+    ScalpSignal signal;
+    long long due_ms;
+    long long expires_ms;
+    double limit;
+} BotOrder;
+
+
+typedef struct BotStrategy BotStrategy;
+
+
 typedef struct {
     time_t timestamp;
     char action[16];        
@@ -47,23 +107,39 @@ typedef struct {
     double fee;
     double total_cost;      
     double balance_after;   
-    char signal[64];        
+    ScalpSignal signal;
 } TradeRecord;
 
 
+/* Fields read on every signal or price tick come first so dispatching
+ * over many bots stays within a cache line or two per bot. Trade history lives in a
+ * separate allocation that grows with use up to MAX_TRADES_HISTORY
+ * records, after which it wraps; the journal, when there is one, keeps
+ * every trade. */
 typedef struct {
-    char symbol[MAX_SYMBOL_LEN];
     bool active;
     BotStatus status;
-    
-    
-    double initial_balance;
     double current_balance;
     double trade_amount_usd;    
-    
-    
     double current_position;     
     double avg_buy_price;        
+    double equity;              /* balance plus position at the last marked price */
+    double peak_equity;
+    double max_drawdown;        /* deepest fall from peak_equity, as a fraction */
+    time_t last_trade_time;
+    int cooldown_seconds;
+    BotOrder order;
+    const BotStrategy *strategy;
+    void *strategy_state;       /* strategy->state_size bytes, allocated at bot_add */
+    
+    int route;                  /* slot in BotManager.routes, -1 when inactive */
+    int prev_subscriber;        /* neighbours on the same route, -1 ends the list */
+    int next_subscriber;
+    int next_free;
+    int active_slot;            /* position in BotManager.active */
+    
+    char symbol[MAX_SYMBOL_LEN];
+    double initial_balance;
     
     
     int total_trades;
@@ -71,32 +147,103 @@ typedef struct {
     int losing_trades;
     double total_profit;
     double total_fees_paid;
-    double max_drawdown;
     double win_rate;
+    int cancelled_orders;
     
     
-    TradeRecord trades[MAX_TRADES_HISTORY];
+    TradeRecord *trades;
+    int trade_capacity;
     int trade_count;
     int trade_index;
     
     
     time_t created_at;
-    time_t last_trade_time;
-    
+    TradeJournal *journal;
+    EquitySeries *equity_series;    /* allocated at the first mark */
 } ScalpingBot;
 
 
+/* Decides when a bot trades. on_candle runs when the pair's analysis is
+ * refreshed and on_tick on every price the bot is dispatched; either may
+ * be NULL. Both return a signal that the bot acts on as it would on the
+ * analyzer's: buys when flat, sells when holding, outside cooldown and
+ * with no order pending. SCALP_SELL_NOW from on_tick is a stop and is
+ * not held back by the cooldown. They read the indicators already cached
+ * on pair and must not allocate; anything kept between calls lives in
+ * state, which is zeroed and handed to init when the bot is added, reset
+ * or restored. State is not journaled, so a restored bot may hold a
+ * position its state knows nothing about. on_fill sees every trade the
+ * bot makes. */
+struct BotStrategy {
+    const char *name;           /* unique, shorter than JOURNAL_SYMBOL_LEN */
+    size_t state_size;
+    void (*init)(const BotStrategy *strategy, void *state);
+    ScalpSignal (*on_candle)(const BotStrategy *strategy, void *state, const ScalpingBot *bot,
+                             const TradingPair *pair);
+    ScalpSignal (*on_tick)(const BotStrategy *strategy, void *state, const ScalpingBot *bot,
+                           const TradingPair *pair);
+    void (*on_fill)(const BotStrategy *strategy, void *state, const ScalpingBot *bot, bool buy,
+                    const Fill *fill);
+    void *impl_data;
+};
+
+
+/* Upper-cased symbol and the first of the bots trading it. Routes are
+ * never deleted, so a slot keeps its symbol until the table grows. */
 typedef struct {
-    ScalpingBot bots[MAX_BOTS];
+    char symbol[MAX_SYMBOL_LEN];
+    int first_bot;
+} BotRoute;
+
+
+/* Bots live in fixed-size chunks so their addresses and indices stay put
+ * as the pool grows. Freed slots are reused through a free list, and
+ * active[] lists the live bot indices densely for iteration. */
+typedef struct {
+    ScalpingBot **chunks;
+    int chunk_count;
+    int capacity;
+    int free_head;
+    
+    int *active;
     int bot_count;
+    
+    BotRoute *routes;
+    int route_capacity;
+    int route_count;
+    unsigned int route_generation;
+    
+    bool quiet;                 /* suppress bot logging */
+    Clock *clock;               /* NULL follows clock_default() */
+    const ExecutionModel *execution;    /* NULL fills instantly at the signal price */
+    
+    char *journal_dir;          /* NULL until bot_manager_load, and then no journals */
+    int next_journal_id;
 } BotManager;
 
 
+void fill_params_default(FillParams *params);
+void execution_model_init(ExecutionModel *model, const FillParams *params);
+
+
+/* "scalp" follows the pair's scalp_signal and is the default; "keltner"
+ * buys ticks below the 5m Keltner channel and sells at its middle or an
+ * ATR below the entry. Lookups by name are for setup and restore only. */
+const BotStrategy* bot_strategy_default(void);
+bool bot_strategy_register(const BotStrategy *strategy);
+const BotStrategy* bot_strategy_find(const char *name);
+int bot_strategy_count(void);
+const BotStrategy* bot_strategy_at(int index);
+
+
 BotManager* bot_manager_create(void);
 void bot_manager_destroy(BotManager *manager);
+ScalpingBot* bot_manager_get(BotManager *manager, int bot_index);
 
 
 int bot_add(BotManager *manager, const char *symbol, double initial_balance, double trade_amount);
+int bot_add_strategy(BotManager *manager, const char *symbol, double initial_balance, double trade_amount,
+                     const BotStrategy *strategy);
 void bot_remove(BotManager *manager, int bot_index);
 void bot_start(BotManager *manager, int bot_index);
 void bot_stop(BotManager *manager, int bot_index);
@@ -104,11 +251,18 @@ void bot_pause(BotManager *manager, int bot_index);
 void bot_reset(BotManager *manager, int bot_index);
 
 
+int bot_manager_route(const BotManager *manager, const char *symbol);
+int bot_dispatch_signal(BotManager *manager, TradingPair *pair);
 void bot_process_signal(BotManager *manager, int bot_index, const TradingPair *pair);
-void bot_execute_buy(ScalpingBot *bot, double price, const char *signal);
-void bot_execute_sell(ScalpingBot *bot, double price, const char *signal);
+void bot_process_tick(BotManager *manager, int bot_index, const TradingPair *pair);
+bool bot_on_price(BotManager *manager, int bot_index, double price);
+void bot_mark_to_market(BotManager *manager, int bot_index, double price);
+int bot_dispatch_price(BotManager *manager, TradingPair *pair);
+void bot_execute_buy(ScalpingBot *bot, double price, ScalpSignal signal);
+void bot_execute_sell(ScalpingBot *bot, double price, ScalpSignal signal);
 
 
+const TradeRecord* bot_recent_trade(const ScalpingBot *bot, int back);
 void bot_update_statistics(ScalpingBot *bot);
 double bot_get_total_value(const ScalpingBot *bot, double current_price);
 double bot_get_roi(const ScalpingBot *bot, double current_price);
@@ -116,5 +270,6 @@ double bot_get_roi(const ScalpingBot *bot, double current_price);
 
 void bot_manager_save(const BotManager *manager);
 bool bot_manager_load(BotManager *manager);
+bool bot_manager_load_dir(BotManager *manager, const char *dir);
 
 #endif 
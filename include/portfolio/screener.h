@@ -0,0 +1,78 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCREENER_H
+#define SCREENER_H
+
+#include <stddef.h>
+
+#define SCREENER_MAX_COLUMNS 64
+#define SCREENER_NAME_LEN 24
+#define SCREENER_SYMBOL_LEN 16
+
+
+/* Column store of per-symbol values: one double array per named column,
+ * rows found by symbol through a hash index. Cells never set read as NaN.
+ * A comparison against NaN is NaN, ! passes it through and no filter
+ * matches it, so a symbol missing a column simply does not match a filter
+ * that uses it, negated or not. */
+typedef struct ScreenerTable ScreenerTable;
+
+/* A filter or ranking expression compiled to stack bytecode against the
+ * columns of one table, e.g. "rsi14_1h < 30 && close > ema200_1d".
+ * Operators: || && ! < <= > >= == != + - * / and unary minus; functions
+ * abs(x), min(a, b), max(a, b). */
+typedef struct ScreenerExpr ScreenerExpr;
+
+typedef struct {
+    int row;
+    double rank;
+} ScreenerMatch;
+
+
+ScreenerTable* screener_table_create(int capacity);
+void screener_table_destroy(ScreenerTable *table);
+void screener_table_clear(ScreenerTable *table);
+
+int screener_table_column(ScreenerTable *table, const char *name);
+int screener_table_find_column(const ScreenerTable *table, const char *name);
+int screener_table_row(ScreenerTable *table, const char *symbol);
+int screener_table_find_row(const ScreenerTable *table, const char *symbol);
+int screener_table_rows(const ScreenerTable *table);
+const char* screener_table_symbol(const ScreenerTable *table, int row);
+const char* screener_table_column_name(const ScreenerTable *table, int column);
+void screener_table_set(ScreenerTable *table, int row, int column, double value);
+double screener_table_get(const ScreenerTable *table, int row, int column);
+
+/* Unknown columns are a compile error, so register them first. On
+ * failure returns NULL and describes the problem in error. */
+ScreenerExpr* screener_compile(const ScreenerTable *table, const char *source, char *error, size_t error_size);
+void screener_expr_destroy(ScreenerExpr *expr);
+int screener_expr_columns(const ScreenerExpr *expr, int *columns, int max_columns);
+
+/* Scalar evaluation of one row, for callers that watch a single symbol. */
+double screener_eval(const ScreenerExpr *expr, const ScreenerTable *table, int row);
+
+/* Evaluates filter over every row, a block of rows at a time, and writes
+ * the best max_matches rows by descending rank (row order when rank is
+ * NULL; NaN ranks last). Returns the number written. */
+int screener_run(const ScreenerTable *table, const ScreenerExpr *filter, const ScreenerExpr *rank,
+                 ScreenerMatch *matches, int max_matches);
+
+#endif
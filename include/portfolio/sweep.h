@@ -0,0 +1,92 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdbool.h>
+#include "backtest.h"
+#include "worker_pool.h"
+
+
+typedef enum {
+    SWEEP_WEAK_MOVE = 0,
+    SWEEP_STRONG_MOVE,
+    SWEEP_FLAT_MOVE,
+    SWEEP_RSI_OVERBOUGHT,
+    SWEEP_RSI_OVERSOLD,
+    SWEEP_RSI_DIP,
+    SWEEP_RSI_BOUNCE,
+    SWEEP_COOLDOWN,
+    SWEEP_TRADE_AMOUNT,
+    SWEEP_PARAM_COUNT
+} SweepParam;
+
+
+/* steps values evenly spaced over [min, max]; steps <= 1 pins min. */
+typedef struct {
+    double min;
+    double max;
+    int steps;
+} SweepRange;
+
+
+/* Either the full grid over all ranges or, when samples > 0, that many
+ * uniform draws from the ranges' boxes. */
+typedef struct {
+    SweepRange ranges[SWEEP_PARAM_COUNT];
+    int samples;
+    unsigned int seed;
+    double initial_balance;
+    const ExecutionModel *execution;    /* shared by every run; NULL fills at the close */
+    const BotStrategy *strategy;        /* NULL for bot_strategy_default() */
+} SweepSpace;
+
+
+typedef struct {
+    double values[SWEEP_PARAM_COUNT];
+    double roi;
+    double max_drawdown;
+    double sharpe;
+    int total_trades;
+    bool ok;
+} SweepResult;
+
+
+typedef enum {
+    SWEEP_RANK_ROI = 0,         /* highest first */
+    SWEEP_RANK_DRAWDOWN,        /* shallowest first */
+    SWEEP_RANK_SHARPE           /* highest first */
+} SweepRank;
+
+
+void sweep_space_default(SweepSpace *space);
+void sweep_set_range(SweepSpace *space, SweepParam param, double min, double max, int steps);
+long sweep_size(const SweepSpace *space);
+const char* sweep_param_name(SweepParam param);
+void sweep_config(const double *values, double initial_balance, BacktestConfig *config);
+
+/* Backtests every configuration of space over the shared, read-only
+ * candles on pool (NULL runs inline). Fills up to max_results results in
+ * configuration order and returns how many were run. */
+int sweep_run(WorkerPool *pool, const SweepSpace *space, const char *symbol,
+              const Candle *candles, int count, SweepResult *results, int max_results);
+void sweep_rank(SweepResult *results, int count, SweepRank rank);
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRADE_JOURNAL_H
+#define TRADE_JOURNAL_H
+
+#include <stdbool.h>
+
+#define JOURNAL_MAGIC "PFBOTJ01"
+#define JOURNAL_VERSION 4
+#define JOURNAL_HEADER_SLOT 256
+#define JOURNAL_HEADER_SIZE (2 * JOURNAL_HEADER_SLOT)
+#define JOURNAL_SYMBOL_LEN 16
+#define JOURNAL_INITIAL_RECORDS 256
+#define JOURNAL_MAX_GROW_RECORDS 65536
+
+#define JOURNAL_BUY 1
+#define JOURNAL_SELL 2
+
+
+/* One fill, 64 bytes. The checksum covers every byte before it and the
+ * sequence numbers run on without gaps, so replay stops at the first
+ * torn or stale record. */
+typedef struct {
+    long long timestamp;
+    double price;
+    double quantity;
+    double fee;
+    double total_cost;      /* cash paid on a buy, net proceeds on a sell */
+    double balance_after;
+    unsigned int sequence;
+    unsigned char side;
+    unsigned char reserved;
+    unsigned short signal;
+    unsigned int flags;
+    unsigned int checksum;
+} JournalRecord;
+
+
+/* Bot settings plus the state folded out of compacted records; the
+ * records that follow continue from base_sequence. Replay marks equity
+ * only at fills; the marked_ pair keeps what the bot saw between them as
+ * of its last save and is merged in after replay. The file holds two
+ * slots; in-place updates go to the older one with the next generation,
+ * so a torn write leaves the previous header to fall back on. */
+typedef struct {
+    char magic[8];
+    unsigned int version;
+    unsigned int record_size;
+    char symbol[JOURNAL_SYMBOL_LEN];
+    double initial_balance;
+    double trade_amount;
+    long long created_at;
+    int cooldown_seconds;
+    int status;
+    char strategy[JOURNAL_SYMBOL_LEN];     /* empty for the default */
+    
+    unsigned int base_sequence;
+    int total_trades;
+    int winning_trades;
+    int losing_trades;
+    double current_balance;
+    double current_position;
+    double avg_buy_price;
+    double total_profit;
+    double total_fees_paid;
+    double max_drawdown;
+    double peak_equity;
+    long long last_trade_time;
+    
+    double marked_peak;
+    double marked_drawdown;
+    
+    unsigned int generation;
+    unsigned int checksum;
+} JournalHeader;
+
+
+/* Append-only file of JournalRecords after a JOURNAL_HEADER_SIZE header,
+ * mapped shared and grown by doubling. Appends are plain stores into the
+ * mapping with no locks or syscalls outside growth; there is one writer
+ * per journal. */
+typedef struct TradeJournal TradeJournal;
+
+
+void journal_header_init(JournalHeader *header, const char *symbol, double initial_balance,
+                         double trade_amount, long long created_at);
+void journal_apply(JournalHeader *state, const JournalRecord *record);
+
+TradeJournal* trade_journal_create(const char *path, const JournalHeader *header);
+TradeJournal* trade_journal_open(const char *path);
+void trade_journal_close(TradeJournal *journal);
+void trade_journal_remove(TradeJournal *journal);
+
+bool trade_journal_append(TradeJournal *journal, JournalRecord *record);
+int trade_journal_count(const TradeJournal *journal);
+const JournalRecord* trade_journal_record(const TradeJournal *journal, int index);
+const JournalHeader* trade_journal_header(const TradeJournal *journal);
+const char* trade_journal_path(const TradeJournal *journal);
+
+bool trade_journal_update_settings(TradeJournal *journal, double trade_amount, int cooldown_seconds, int status);
+bool trade_journal_update_marks(TradeJournal *journal, double peak_equity, double max_drawdown);
+bool trade_journal_compact(TradeJournal *journal, int keep);
+bool trade_journal_reset(TradeJournal *journal);
+void trade_journal_sync(TradeJournal *journal);
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TREND_CONSENSUS_H
+#define TREND_CONSENSUS_H
+
+#include <stdbool.h>
+
+#define TREND_MAX_FRAMES 8
+#define TREND_MAX_PERIOD 64
+
+
+/* Early and recent sums over the last 2 * period closes of one timeframe.
+ * Each push moves one close from recent to early and drops the oldest, so
+ * updating the direction is O(1) per candle. Before 2 * period closes the
+ * early sum only holds what has left the recent half. */
+typedef struct {
+    int period;
+    double threshold;   /* fractional move of the recent average over the early one */
+    double ring[2 * TREND_MAX_PERIOD];
+    long samples;
+    double early_sum, recent_sum;
+    int direction;
+} TrendWindow;
+
+
+/* Weighted vote across timeframes. A frame with weight 0 is ignored; the
+ * consensus is +1 or -1 once the weighted score reaches +-min_score. */
+typedef struct {
+    TrendWindow frames[TREND_MAX_FRAMES];
+    double weights[TREND_MAX_FRAMES];
+    double min_score;
+    double score;
+    int consensus;
+} TrendConsensus;
+
+
+void trend_window_init(TrendWindow *window, int period, double threshold);
+void trend_window_reset(TrendWindow *window);
+void trend_window_push(TrendWindow *window, double close);
+void trend_window_load(TrendWindow *window, const double *closes, int count);
+
+void trend_consensus_init(TrendConsensus *trend, int period, double threshold, double min_score);
+void trend_consensus_set_weight(TrendConsensus *trend, int frame, double weight);
+void trend_consensus_load(TrendConsensus *trend, int frame, const double *closes, int count);
+void trend_consensus_push(TrendConsensus *trend, int frame, double close);
+
+int trend_consensus_frame(const TrendConsensus *trend, int frame);
+int trend_consensus_direction(const TrendConsensus *trend);
+
+#endif
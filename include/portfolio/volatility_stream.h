@@ -0,0 +1,75 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLATILITY_STREAM_H
+#define VOLATILITY_STREAM_H
+
+#include <stdbool.h>
+#include "ohlc_stream.h"
+
+#define VOL_MAX_WINDOW 64
+
+
+typedef enum {
+    VOL_PARKINSON = 0,    /* high-low range */
+    VOL_GARMAN_KLASS,     /* range plus open-to-close */
+    VOL_YANG_ZHANG,       /* adds close-to-open gaps and drift-free Rogers-Satchell */
+    VOL_ESTIMATOR_COUNT
+} VolEstimator;
+
+
+typedef struct {
+    double gap;           /* ln(open / previous close) */
+    double body;          /* ln(close / open) */
+    double rogers_satchell;
+    double parkinson;
+    double garman_klass;
+} VolTerms;
+
+
+/* Range-based variance estimators over the last window candles. Each push
+ * stores the candle's log terms in a ring and updates running sums, so it
+ * is O(1); the sums are rebuilt from the ring once per window pushes to
+ * keep rounding from accumulating. periods_per_year annualizes a
+ * per-candle variance on a 24/7 market. */
+typedef struct {
+    int window;
+    double periods_per_year;
+    
+    long samples;
+    double prev_close;
+    
+    VolTerms ring[VOL_MAX_WINDOW];
+    double gap_sum, gap_sq;
+    double body_sum, body_sq;
+    double rs_sum, parkinson_sum, gk_sum;
+    int since_resum;
+} VolatilityStream;
+
+
+void volatility_stream_init(VolatilityStream *stream, int window, double candle_hours);
+void volatility_stream_reset(VolatilityStream *stream);
+void volatility_stream_push(VolatilityStream *stream, const Candle *candle);
+void volatility_stream_backfill(VolatilityStream *stream, const Candle *candles, int count);
+
+bool volatility_stream_ready(const VolatilityStream *stream);
+double volatility_stream_variance(const VolatilityStream *stream, VolEstimator estimator);
+double volatility_stream_annualized(const VolatilityStream *stream, VolEstimator estimator);
+
+#endif
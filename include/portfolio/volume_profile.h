@@ -0,0 +1,75 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLUME_PROFILE_H
+#define VOLUME_PROFILE_H
+
+#include <stdbool.h>
+#include "ohlc_stream.h"
+
+#define VP_MAX_BINS 256
+#define VP_MAX_NODES 16
+
+
+typedef struct {
+    double price;      /* bin centre */
+    double volume;
+    double strength;   /* volume over the mean of the occupied bins */
+} VolumeNode;
+
+
+/* Levels read off a profile: the point of control, the value area that
+ * holds 70% of the volume around it, and the high-volume nodes in
+ * ascending price order. */
+typedef struct {
+    double poc;
+    double value_area_low, value_area_high;
+    double low, high;
+    VolumeNode nodes[VP_MAX_NODES];
+    int node_count;
+} VolumeLevels;
+
+
+/* Volume-by-price histogram. Each candle spreads its volume evenly over
+ * [low, high]; bins it covers completely go through a difference array,
+ * so adding a candle is O(1) and materializing is O(bins). When a candle
+ * falls outside the range the histogram grows into spare bins, or merges
+ * neighbouring bins to double the width, so it never needs the candles
+ * again. */
+typedef struct {
+    double base;        /* lower edge of bin 0 */
+    double width;
+    int bin_count;
+    double volume[VP_MAX_BINS];
+    double spread[VP_MAX_BINS + 1];
+    bool pending;
+    double total_volume;
+    long candles;
+    long long last_open_time;   /* newest candle added, 0 if the caller does not track it */
+} VolumeProfile;
+
+
+void volume_profile_reset(VolumeProfile *profile);
+void volume_profile_prepare(VolumeProfile *profile, double low, double high, double typical_range);
+void volume_profile_add(VolumeProfile *profile, const Candle *candle);
+void volume_profile_levels(VolumeProfile *profile, VolumeLevels *levels);
+
+bool volume_levels_nearest(const VolumeLevels *levels, double price, double *support, double *resistance);
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stddef.h>
+
+#define WORKER_POOL_MAX_THREADS 16
+
+
+typedef void (*WorkerTask)(void *arg);
+
+typedef struct WorkerPool WorkerPool;
+
+
+WorkerPool* worker_pool_create(int thread_count);
+void worker_pool_destroy(WorkerPool *pool);
+int worker_pool_size(const WorkerPool *pool);
+
+/* Runs task on each of count elements of args, arg_size bytes apart, and
+ * returns once all of them have finished. The calling thread takes part.
+ * Tasks must not call back into the same pool. */
+void worker_pool_run(WorkerPool *pool, WorkerTask task, void *args, size_t arg_size, int count);
+
+/* Process-wide pool sized to the online CPUs, created on first use. */
+WorkerPool* worker_pool_default(void);
+
+#endif
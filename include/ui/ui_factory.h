@@ -44,6 +44,7 @@ typedef struct UIInterface {
     void (*update_pair_price)(int pair_index, double price, void *user_data);
     void (*show_error)(const char *message, void *user_data);
     void (*show_info)(const char *message, void *user_data);
+    void (*show_alert)(const char *message, void *user_data);
     void (*cleanup)(void *user_data);
     void *impl_data; 
 } UIInterface;
@@ -0,0 +1,429 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/alert_engine.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    double threshold;
+    int id;
+} AlertLevel;
+
+/* Sorted by ascending threshold; equal thresholds keep insertion order. */
+typedef struct {
+    AlertLevel *items;
+    int count;
+    int capacity;
+} AlertLevels;
+
+typedef struct {
+    int id;
+    ScreenerExpr *expr;
+    unsigned int series_mask;
+    bool state;
+    char source[ALERT_CONDITION_LEN];
+} ConditionAlert;
+
+typedef struct {
+    char symbol[MAX_SYMBOL_LEN];
+    double last_price;
+    AlertLevels above, below;
+    AlertLevels pending;      /* CROSS alerts waiting for a first price */
+    ConditionAlert *conditions;
+    int condition_count;
+    int condition_capacity;
+    int row;
+} AlertBook;
+
+struct AlertEngine {
+    AlertBook *books;
+    int book_count;
+    int book_capacity;
+    ScreenerTable *table;
+    AlertCallback callback;
+    void *user_data;
+    int next_id;
+    int alert_count;
+};
+
+
+static void normalize_symbol(const char *symbol, char *out) {
+    int i = 0;
+    for (; symbol[i] && i < MAX_SYMBOL_LEN - 1; i++) {
+        out[i] = toupper((unsigned char)symbol[i]);
+    }
+    out[i] = '\0';
+}
+
+
+static AlertBook* find_book(AlertEngine *engine, const char *symbol) {
+    char key[MAX_SYMBOL_LEN];
+    normalize_symbol(symbol, key);
+    
+    for (int i = 0; i < engine->book_count; i++) {
+        if (strcmp(engine->books[i].symbol, key) == 0) return &engine->books[i];
+    }
+    return NULL;
+}
+
+
+static AlertBook* book_for(AlertEngine *engine, const char *symbol) {
+    AlertBook *book = find_book(engine, symbol);
+    if (book) return book;
+    
+    if (engine->book_count == engine->book_capacity) {
+        int capacity = engine->book_capacity ? engine->book_capacity * 2 : 8;
+        AlertBook *books = realloc(engine->books, capacity * sizeof(AlertBook));
+        if (!books) return NULL;
+        engine->books = books;
+        engine->book_capacity = capacity;
+    }
+    
+    book = &engine->books[engine->book_count];
+    memset(book, 0, sizeof(*book));
+    normalize_symbol(symbol, book->symbol);
+    book->row = screener_table_row(engine->table, book->symbol);
+    if (book->row < 0) return NULL;
+    engine->book_count++;
+    return book;
+}
+
+
+/* First index whose threshold is > value (or >= value when inclusive). */
+static int bound(const AlertLevels *levels, double value, bool inclusive) {
+    int lo = 0, hi = levels->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        double threshold = levels->items[mid].threshold;
+        if (inclusive ? threshold < value : threshold <= value) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+
+static bool insert_level(AlertLevels *levels, double threshold, int id) {
+    if (levels->count == levels->capacity) {
+        int capacity = levels->capacity ? levels->capacity * 2 : 16;
+        AlertLevel *items = realloc(levels->items, capacity * sizeof(AlertLevel));
+        if (!items) return false;
+        levels->items = items;
+        levels->capacity = capacity;
+    }
+    
+    int at = bound(levels, threshold, false);
+    memmove(&levels->items[at + 1], &levels->items[at], (levels->count - at) * sizeof(AlertLevel));
+    levels->items[at].threshold = threshold;
+    levels->items[at].id = id;
+    levels->count++;
+    return true;
+}
+
+
+static bool remove_level(AlertLevels *levels, int id) {
+    for (int i = 0; i < levels->count; i++) {
+        if (levels->items[i].id != id) continue;
+        
+        memmove(&levels->items[i], &levels->items[i + 1], (levels->count - i - 1) * sizeof(AlertLevel));
+        levels->count--;
+        return true;
+    }
+    return false;
+}
+
+
+AlertEngine* alert_engine_create(AlertCallback callback, void *user_data) {
+    AlertEngine *engine = calloc(1, sizeof(AlertEngine));
+    if (!engine) {
+        return NULL;
+    }
+    
+    engine->table = screener_table_create(MAX_PAIRS);
+    if (!engine->table) {
+        free(engine);
+        return NULL;
+    }
+    portfolio_screener_columns(engine->table);
+    
+    engine->callback = callback;
+    engine->user_data = user_data;
+    engine->next_id = 1;
+    return engine;
+}
+
+
+void alert_engine_destroy(AlertEngine *engine) {
+    if (!engine) return;
+    
+    for (int b = 0; b < engine->book_count; b++) {
+        AlertBook *book = &engine->books[b];
+        free(book->above.items);
+        free(book->below.items);
+        free(book->pending.items);
+        for (int c = 0; c < book->condition_count; c++) {
+            screener_expr_destroy(book->conditions[c].expr);
+        }
+        free(book->conditions);
+    }
+    free(engine->books);
+    screener_table_destroy(engine->table);
+    free(engine);
+}
+
+
+int alert_engine_add_price(AlertEngine *engine, const char *symbol, AlertKind kind, double threshold) {
+    if (!engine || !symbol || !symbol[0] || threshold <= 0 || kind == ALERT_CONDITION) return -1;
+    
+    AlertBook *book = book_for(engine, symbol);
+    if (!book) return -1;
+    
+    if (kind == ALERT_PRICE_CROSS && book->last_price > 0) {
+        kind = (threshold >= book->last_price) ? ALERT_PRICE_ABOVE : ALERT_PRICE_BELOW;
+    }
+    
+    AlertLevels *levels = (kind == ALERT_PRICE_ABOVE) ? &book->above :
+                          (kind == ALERT_PRICE_BELOW) ? &book->below : &book->pending;
+    int id = engine->next_id;
+    if (!insert_level(levels, threshold, id)) return -1;
+    
+    engine->next_id++;
+    engine->alert_count++;
+    return id;
+}
+
+
+int alert_engine_add_condition(AlertEngine *engine, const char *symbol, const char *condition,
+                               char *error, size_t error_size) {
+    if (error && error_size > 0) error[0] = '\0';
+    if (!engine || !symbol || !symbol[0] || !condition) return -1;
+    if (strlen(condition) >= ALERT_CONDITION_LEN) {
+        if (error) snprintf(error, error_size, "condition too long");
+        return -1;
+    }
+    
+    ScreenerExpr *expr = screener_compile(engine->table, condition, error, error_size);
+    if (!expr) return -1;
+    
+    int columns[SCREENER_MAX_COLUMNS];
+    int column_count = screener_expr_columns(expr, columns, SCREENER_MAX_COLUMNS);
+    unsigned int mask = 0;
+    for (int i = 0; i < column_count; i++) {
+        SeriesId series = portfolio_screener_column_series(screener_table_column_name(engine->table, columns[i]));
+        if (series < SERIES_COUNT) mask |= 1u << series;
+    }
+    
+    AlertBook *book = book_for(engine, symbol);
+    if (!book) {
+        screener_expr_destroy(expr);
+        return -1;
+    }
+    
+    if (book->condition_count == book->condition_capacity) {
+        int capacity = book->condition_capacity ? book->condition_capacity * 2 : 4;
+        ConditionAlert *conditions = realloc(book->conditions, capacity * sizeof(ConditionAlert));
+        if (!conditions) {
+            screener_expr_destroy(expr);
+            return -1;
+        }
+        book->conditions = conditions;
+        book->condition_capacity = capacity;
+    }
+    
+    ConditionAlert *alert = &book->conditions[book->condition_count++];
+    memset(alert, 0, sizeof(*alert));
+    alert->id = engine->next_id++;
+    alert->expr = expr;
+    alert->series_mask = mask;
+    strcpy(alert->source, condition);
+    engine->alert_count++;
+    return alert->id;
+}
+
+
+bool alert_engine_remove(AlertEngine *engine, int id) {
+    if (!engine || id <= 0) return false;
+    
+    for (int b = 0; b < engine->book_count; b++) {
+        AlertBook *book = &engine->books[b];
+        if (remove_level(&book->above, id) || remove_level(&book->below, id) ||
+            remove_level(&book->pending, id)) {
+            engine->alert_count--;
+            return true;
+        }
+        
+        for (int c = 0; c < book->condition_count; c++) {
+            if (book->conditions[c].id != id) continue;
+            
+            screener_expr_destroy(book->conditions[c].expr);
+            memmove(&book->conditions[c], &book->conditions[c + 1],
+                    (book->condition_count - c - 1) * sizeof(ConditionAlert));
+            book->condition_count--;
+            engine->alert_count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+int alert_engine_count(const AlertEngine *engine) {
+    return engine ? engine->alert_count : 0;
+}
+
+
+int alert_engine_load(AlertEngine *engine, const char *path) {
+    if (!engine || !path) return 0;
+    
+    FILE *file = fopen(path, "r");
+    if (!file) return 0;
+    
+    int loaded = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n#")] = '\0';
+        
+        char symbol[MAX_SYMBOL_LEN], verb[16];
+        int offset = 0;
+        if (sscanf(line, "%15s %15s %n", symbol, verb, &offset) < 2) continue;
+        const char *rest = line + offset;
+        
+        int id = -1;
+        char error[128] = "";
+        if (strcmp(verb, "when") == 0) {
+            id = alert_engine_add_condition(engine, symbol, rest, error, sizeof(error));
+        } else {
+            char *end = NULL;
+            double threshold = strtod(rest, &end);
+            AlertKind kind = ALERT_CONDITION;
+            if (strcmp(verb, "above") == 0) kind = ALERT_PRICE_ABOVE;
+            else if (strcmp(verb, "below") == 0) kind = ALERT_PRICE_BELOW;
+            else if (strcmp(verb, "cross") == 0) kind = ALERT_PRICE_CROSS;
+            if (end != rest) id = alert_engine_add_price(engine, symbol, kind, threshold);
+        }
+        
+        if (id > 0) {
+            loaded++;
+        } else {
+            printf("Skipping alert '%s'%s%s\n", line, error[0] ? ": " : "", error);
+        }
+    }
+    
+    fclose(file);
+    return loaded;
+}
+
+
+static void deliver(AlertEngine *engine, const AlertBook *book, int id, AlertKind kind,
+                    double threshold, double price, const char *condition) {
+    if (!engine->callback) return;
+    
+    AlertEvent event = { id, kind, book->symbol, threshold, price, condition };
+    engine->callback(&event, engine->user_data);
+}
+
+
+/* Fires levels [from, to) and drops them from the array. */
+static int fire_levels(AlertEngine *engine, const AlertBook *book, AlertLevels *levels,
+                       int from, int to, AlertKind kind, double price) {
+    int fired = to - from;
+    if (fired <= 0) return 0;
+    
+    for (int i = from; i < to; i++) {
+        deliver(engine, book, levels->items[i].id, kind, levels->items[i].threshold, price, NULL);
+    }
+    memmove(&levels->items[from], &levels->items[to], (levels->count - to) * sizeof(AlertLevel));
+    levels->count -= fired;
+    engine->alert_count -= fired;
+    return fired;
+}
+
+
+static int evaluate_conditions(AlertEngine *engine, AlertBook *book, unsigned int mask) {
+    int fired = 0;
+    
+    for (int c = 0; c < book->condition_count; c++) {
+        ConditionAlert *alert = &book->conditions[c];
+        if (!(alert->series_mask & mask)) continue;
+        
+        double value = screener_eval(alert->expr, engine->table, book->row);
+        bool state = (value != 0.0 && !isnan(value));
+        if (state && !alert->state) {
+            deliver(engine, book, alert->id, ALERT_CONDITION, 0.0, book->last_price, alert->source);
+            fired++;
+        }
+        alert->state = state;
+    }
+    return fired;
+}
+
+
+int alert_engine_on_price(AlertEngine *engine, const char *symbol, double price) {
+    if (!engine || !symbol || price <= 0) return 0;
+    
+    AlertBook *book = find_book(engine, symbol);
+    if (!book) return 0;
+    
+    double previous = book->last_price;
+    book->last_price = price;
+    int fired = 0;
+    
+    if (previous <= 0) {
+        for (int i = 0; i < book->pending.count; i++) {
+            AlertLevel *level = &book->pending.items[i];
+            insert_level((level->threshold >= price) ? &book->above : &book->below, level->threshold, level->id);
+        }
+        book->pending.count = 0;
+    } else if (price > previous) {
+        int from = bound(&book->above, previous, false);
+        int to = bound(&book->above, price, false);
+        fired += fire_levels(engine, book, &book->above, from, to, ALERT_PRICE_ABOVE, price);
+    } else if (price < previous) {
+        int from = bound(&book->below, price, true);
+        int to = bound(&book->below, previous, true);
+        fired += fire_levels(engine, book, &book->below, from, to, ALERT_PRICE_BELOW, price);
+    }
+    
+    if (book->condition_count > 0) {
+        screener_table_set(engine->table, book->row, screener_table_find_column(engine->table, "close"), price);
+        fired += evaluate_conditions(engine, book, 1u << SERIES_TICK);
+    }
+    return fired;
+}
+
+
+int alert_engine_on_series(AlertEngine *engine, const TradingPair *pair, SeriesId series) {
+    if (!engine || !pair || series < 0 || series >= SERIES_COUNT) return 0;
+    
+    AlertBook *book = find_book(engine, pair->symbol);
+    if (!book || book->condition_count == 0) return 0;
+    
+    unsigned int mask = 1u << series;
+    bool watched = false;
+    for (int c = 0; c < book->condition_count && !watched; c++) {
+        watched = (book->conditions[c].series_mask & mask) != 0;
+    }
+    if (!watched) return 0;
+    
+    portfolio_screener_fill_pair(pair, engine->table);
+    return evaluate_conditions(engine, book, mask);
+}
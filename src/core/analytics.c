@@ -18,6 +18,9 @@
  */
 
 #include "portfolio/portfolio_core.h"
+#include "portfolio/path_sim.h"
+#include "portfolio/ema_bank.h"
+#include <ctype.h>
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
@@ -31,6 +34,13 @@ int portfolio_calculate_trend(const TradingPair *pair) {
         return 0; 
     }
     
+    unsigned int key = indicator_cache_key(INDICATOR_TREND, SERIES_TICK, 0);
+    unsigned int version = pair->series_version[SERIES_TICK];
+    double cached;
+    if (indicator_cache_get(portfolio_indicator_cache(pair), key, version, &cached, 1)) {
+        return (int)cached;
+    }
+    
     int recent_count = (pair->history_count < 5) ? pair->history_count : 5;
     double sum = 0.0;
     int start_idx = (pair->history_index - recent_count + PRICE_HISTORY_SIZE) % PRICE_HISTORY_SIZE;
@@ -41,12 +51,16 @@ int portfolio_calculate_trend(const TradingPair *pair) {
     }
     double recent_avg = sum / recent_count;
     
+    int trend = 0;
     if (pair->current_price > recent_avg * 1.02) {
-        return 1; 
+        trend = 1; 
     } else if (pair->current_price < recent_avg * 0.98) {
-        return -1; 
+        trend = -1; 
     }
-    return 0; 
+    
+    cached = trend;
+    indicator_cache_put(portfolio_indicator_cache(pair), key, version, &cached, 1);
+    return trend; 
 }
 
 double portfolio_calculate_momentum(const TradingPair *pair) {
@@ -74,90 +88,78 @@ double portfolio_calculate_momentum(const TradingPair *pair) {
     return (sum_denominator > 0) ? (sum_numerator / sum_denominator) : 0.0;
 }
 
+/* Daily volatility of log returns from the range-based estimators; until
+ * a candle series fills its window, the coefficient of variation of the
+ * close history stands in. */
 double portfolio_calculate_volatility(const TradingPair *pair) {
     if (!pair) return 0.0;
     
+    double annualized = portfolio_annualized_volatility(pair);
+    if (annualized > 0) {
+        return annualized / sqrt(365.0);
+    }
+    
     int count = 0;
-    double sum = 0.0;
+    const double *prices = NULL;
+    SeriesId series;
     
     if (pair->historical_loaded && pair->historical_count > 0) {
         count = pair->historical_count;
-        for (int i = 0; i < count; i++) {
-            sum += pair->historical_prices[i];
-        }
+        prices = pair->historical_prices;
+        series = SERIES_LEGACY;
     } else if (pair->history_count > 0) {
         count = pair->history_count;
-        for (int i = 0; i < count; i++) {
-            sum += pair->price_history[i];
-        }
+        prices = pair->price_history;
+        series = SERIES_TICK;
     } else {
         return 0.0;
     }
     
-    if (count == 0) return 0.0;
+    unsigned int key = indicator_cache_key(INDICATOR_VOLATILITY, series, 0);
+    unsigned int version = pair->series_version[series];
+    double cached;
+    if (indicator_cache_get(portfolio_indicator_cache(pair), key, version, &cached, 1)) {
+        return cached;
+    }
+    
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) {
+        sum += prices[i];
+    }
     
     double mean = sum / count;
     double variance = 0.0;
     
-    if (pair->historical_loaded && pair->historical_count > 0) {
-        for (int i = 0; i < pair->historical_count; i++) {
-            double diff = pair->historical_prices[i] - mean;
-            variance += diff * diff;
-        }
-    } else {
-        for (int i = 0; i < pair->history_count; i++) {
-            double diff = pair->price_history[i] - mean;
-            variance += diff * diff;
-        }
+    for (int i = 0; i < count; i++) {
+        double diff = prices[i] - mean;
+        variance += diff * diff;
     }
     
     variance /= count;
     double std_dev = sqrt(variance);
     
-    return (mean > 0) ? (std_dev / mean) : 0.0;
+    cached = (mean > 0) ? (std_dev / mean) : 0.0;
+    indicator_cache_put(portfolio_indicator_cache(pair), key, version, &cached, 1);
+    return cached;
 }
 
 double portfolio_calculate_rsi(const TradingPair *pair) {
     if (!pair) return 50.0;
     
     int period = 14;
-    int count = 0;
-    const double *prices = NULL;
     
     if (pair->historical_loaded && pair->historical_count >= period) {
-        count = pair->historical_count;
-        prices = pair->historical_prices;
+        return portfolio_series_rsi(pair, SERIES_LEGACY, period);
     } else if (pair->history_count >= period) {
-        count = pair->history_count;
-        prices = pair->price_history;
-    } else {
-        return 50.0;
-    }
-    
-    double gains = 0.0;
-    double losses = 0.0;
-    
-    int start_idx = count - period;
-    for (int i = start_idx; i < count - 1; i++) {
-        double change = prices[i + 1] - prices[i];
-        if (change > 0) {
-            gains += change;
-        } else {
-            losses += fabs(change);
-        }
+        return portfolio_series_rsi(pair, SERIES_TICK, period);
     }
+    return 50.0;
+}
+
+double portfolio_series_rsi(const TradingPair *pair, SeriesId series, int period) {
+    if (!pair || series < 0 || series >= SERIES_COUNT) return 50.0;
     
-    double avg_gain = gains / period;
-    double avg_loss = losses / period;
-    
-    if (avg_loss == 0) {
-        return 100.0;
-    }
-    
-    double rs = avg_gain / avg_loss;
-    double rsi = 100.0 - (100.0 / (1.0 + rs));
-    
-    return rsi;
+    return rsi_stream_value(&pair->rsi_stream[series], period);
 }
 
 void portfolio_calculate_support_resistance(const TradingPair *pair, double *support, double *resistance) {
@@ -166,6 +168,11 @@ void portfolio_calculate_support_resistance(const TradingPair *pair, double *sup
     *support = 0.0;
     *resistance = 0.0;
     
+    const VolumeLevels *levels = portfolio_volume_levels(pair);
+    if (levels && volume_levels_nearest(levels, pair->current_price, support, resistance)) {
+        return;
+    }
+    
     int count = 0;
     const double *prices = NULL;
     
@@ -430,6 +437,295 @@ void portfolio_analyze_performance(Portfolio *portfolio, PerformanceItem *items,
 }
 
 
+#define MS_PER_HOUR 3600000LL
+
+
+static int find_candle(const Candle *candles, int count, long long open_time) {
+    int lo = 0, hi = count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (candles[mid].open_time == open_time) return mid;
+        if (candles[mid].open_time < open_time) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+
+static bool same_pairs(const Portfolio *portfolio) {
+    const PortfolioCovariance *cov = &portfolio->covariance;
+    if (!cov->matrix || cov->symbol_count != portfolio->pair_count) return false;
+    
+    for (int i = 0; i < portfolio->pair_count; i++) {
+        if (strcmp(cov->symbols[i], portfolio->pairs[i].symbol) != 0) return false;
+    }
+    return true;
+}
+
+
+/* Pushes one return vector per hour that every pair has closed since the
+ * last call, so a new candle costs a single rank-1 update. A change in the
+ * pair list rebuilds the matrix from the last COVARIANCE_WINDOW hours.
+ * Returns the number of vectors pushed. */
+int portfolio_update_covariance(Portfolio *portfolio) {
+    if (!portfolio || portfolio->pair_count < 2) return 0;
+    
+    PortfolioCovariance *cov = &portfolio->covariance;
+    int n = portfolio->pair_count;
+    
+    if (!same_pairs(portfolio)) {
+        covariance_destroy(cov->matrix);
+        cov->matrix = covariance_create(n, COVARIANCE_WINDOW);
+        cov->symbol_count = cov->matrix ? n : 0;
+        cov->last_open_time = 0;
+        for (int i = 0; i < cov->symbol_count; i++) {
+            memcpy(cov->symbols[i], portfolio->pairs[i].symbol, MAX_SYMBOL_LEN);
+        }
+        if (!cov->matrix) return 0;
+    }
+    
+    const Candle *candles[MAX_PAIRS];
+    int closed[MAX_PAIRS];
+    long long newest = 0;
+    
+    for (int i = 0; i < n; i++) {
+        int count = 0;
+        candles[i] = portfolio_series_candles(&portfolio->pairs[i], SERIES_1H, &count);
+        /* The last candle is still forming. */
+        closed[i] = count - 1;
+        if (!candles[i] || closed[i] < 2) return 0;
+        
+        long long last = candles[i][closed[i] - 1].open_time;
+        if (i == 0 || last < newest) newest = last;
+    }
+    
+    long long first = newest - (COVARIANCE_WINDOW - 1) * MS_PER_HOUR;
+    if (first <= cov->last_open_time) first = cov->last_open_time + MS_PER_HOUR;
+    
+    int pushed = 0;
+    double returns[MAX_PAIRS];
+    for (long long t = first; t <= newest; t += MS_PER_HOUR) {
+        bool complete = true;
+        for (int i = 0; i < n; i++) {
+            int index = find_candle(candles[i], closed[i], t);
+            if (index < 1 || candles[i][index - 1].open_time != t - MS_PER_HOUR ||
+                candles[i][index - 1].close <= 0 || candles[i][index].close <= 0) {
+                complete = false;
+                break;
+            }
+            returns[i] = log(candles[i][index].close / candles[i][index - 1].close);
+        }
+        
+        if (complete && covariance_push(cov->matrix, returns)) {
+            pushed++;
+        }
+    }
+    
+    if (newest > cov->last_open_time) cov->last_open_time = newest;
+    return pushed;
+}
+
+
+/* Weights are the signed position values, so a short hedges a long. */
+bool portfolio_diversification(const Portfolio *portfolio, DiversificationMetrics *metrics) {
+    if (!portfolio || !metrics || !same_pairs(portfolio)) return false;
+    if (covariance_samples(portfolio->covariance.matrix) < COVARIANCE_MIN_SAMPLES) return false;
+    
+    double weights[MAX_PAIRS];
+    double gross = 0.0;
+    for (int i = 0; i < portfolio->pair_count; i++) {
+        const TradingPair *pair = &portfolio->pairs[i];
+        double price = pair->current_price > 0 ? pair->current_price : pair->bought_price;
+        double value = price * pair->quantity;
+        weights[i] = (pair->position_type == POSITION_SHORT) ? -value : value;
+        gross += fabs(value);
+    }
+    if (gross <= 0) return false;
+    
+    for (int i = 0; i < portfolio->pair_count; i++) {
+        weights[i] /= gross;
+    }
+    return covariance_diversification(portfolio->covariance.matrix, weights, metrics);
+}
+
+
+/* Target weights for the long positions, solved on the covariance of
+ * their hourly returns; the long book's total value stays the same.
+ * Returns the number of pairs optimized, 0 when there is too little data. */
+int portfolio_optimize(const Portfolio *portfolio, OptimizerObjective objective,
+                       RebalanceSuggestion *suggestions) {
+    if (!portfolio || !suggestions) return 0;
+    
+    memset(suggestions, 0, portfolio->pair_count * sizeof(RebalanceSuggestion));
+    if (!same_pairs(portfolio)) return 0;
+    
+    const CovarianceMatrix *matrix = portfolio->covariance.matrix;
+    if (covariance_samples(matrix) < COVARIANCE_MIN_SAMPLES) return 0;
+    
+    int n = portfolio->pair_count;
+    double full[MAX_PAIRS * MAX_PAIRS];
+    if (!covariance_fill(matrix, full)) return 0;
+    
+    int assets[MAX_PAIRS];
+    double values[MAX_PAIRS];
+    int count = 0;
+    double book = 0.0;
+    for (int i = 0; i < n; i++) {
+        const TradingPair *pair = &portfolio->pairs[i];
+        if (pair->position_type != POSITION_LONG || pair->current_price <= 0 || pair->quantity <= 0) continue;
+        
+        assets[count] = i;
+        values[count] = pair->current_price * pair->quantity;
+        book += values[count];
+        count++;
+    }
+    if (count == 0 || book <= 0) return 0;
+    
+    double covariance[MAX_PAIRS * MAX_PAIRS];
+    double expected[MAX_PAIRS];
+    for (int a = 0; a < count; a++) {
+        expected[a] = covariance_mean(matrix, assets[a]);
+        for (int b = 0; b < count; b++) {
+            covariance[a * count + b] = full[assets[a] * n + assets[b]];
+        }
+    }
+    
+    OptimizerOptions options;
+    optimizer_default_options(&options, objective);
+    double weights[MAX_PAIRS];
+    if (optimizer_solve(covariance, expected, count, &options, weights) < 0) return 0;
+    
+    for (int a = 0; a < count; a++) {
+        RebalanceSuggestion *suggestion = &suggestions[assets[a]];
+        double price = portfolio->pairs[assets[a]].current_price;
+        
+        suggestion->optimized = true;
+        suggestion->current_weight = values[a] / book;
+        suggestion->target_weight = weights[a];
+        suggestion->value_delta = weights[a] * book - values[a];
+        suggestion->quantity_delta = suggestion->value_delta / price;
+    }
+    return count;
+}
+
+
+#define SCREENER_FRAMES 5
+#define SCREENER_FIELDS 8
+
+static const SeriesId screener_frames[SCREENER_FRAMES] = { SERIES_5M, SERIES_15M, SERIES_1H, SERIES_4H, SERIES_1D };
+
+typedef struct {
+    int close, change, volume;
+    int frames[SCREENER_FRAMES][SCREENER_FIELDS];
+} ScreenerColumns;
+
+
+/* Timeframe columns are named <field>_<5m|15m|1h|4h|1d>: rsi14, ema20,
+ * ema50, ema200, atr, adx, vol (annualized Yang-Zhang) and trend. */
+static void register_screener_columns(ScreenerTable *table, ScreenerColumns *columns) {
+    static const char *fields[SCREENER_FIELDS] = { "rsi14", "ema20", "ema50", "ema200", "atr", "adx", "vol", "trend" };
+    
+    columns->close = screener_table_column(table, "close");
+    columns->change = screener_table_column(table, "change24h");
+    columns->volume = screener_table_column(table, "vol24h");
+    for (int f = 0; f < SCREENER_FRAMES; f++) {
+        for (int k = 0; k < SCREENER_FIELDS; k++) {
+            char name[SCREENER_NAME_LEN];
+            snprintf(name, sizeof(name), "%s_%s", fields[k], portfolio_series_name(screener_frames[f]));
+            columns->frames[f][k] = screener_table_column(table, name);
+        }
+    }
+}
+
+
+/* Rows are keyed by the upper-case symbol the exchange uses. Values that
+ * are not available yet stay NaN. */
+static int fill_screener_row(const TradingPair *pair, ScreenerTable *table, const ScreenerColumns *columns) {
+    static const int ema_periods[] = { 20, 50, 200 };
+    
+    char symbol[MAX_SYMBOL_LEN];
+    int length = 0;
+    for (; pair->symbol[length] && length < MAX_SYMBOL_LEN - 1; length++) {
+        symbol[length] = toupper((unsigned char)pair->symbol[length]);
+    }
+    symbol[length] = '\0';
+    
+    int row = screener_table_row(table, symbol);
+    if (row < 0) return -1;
+    
+    if (pair->current_price > 0) screener_table_set(table, row, columns->close, pair->current_price);
+    
+    int count = 0;
+    const Candle *hourly = portfolio_series_candles(pair, SERIES_1H, &count);
+    if (hourly && count > 24) {
+        double quote_volume = 0.0;
+        for (int i = count - 24; i < count; i++) {
+            quote_volume += hourly[i].volume * hourly[i].close;
+        }
+        screener_table_set(table, row, columns->volume, quote_volume);
+        screener_table_set(table, row, columns->change,
+                           (hourly[count - 1].close / hourly[count - 25].close - 1.0) * 100.0);
+    }
+    
+    for (int f = 0; f < SCREENER_FRAMES; f++) {
+        SeriesId series = screener_frames[f];
+        const int *column = columns->frames[f];
+        int n = 0;
+        const double *closes = portfolio_series_data(pair, series, &n);
+        if (!closes || n == 0) continue;
+        
+        if (rsi_stream_ready(&pair->rsi_stream[series], 14)) {
+            screener_table_set(table, row, column[0], portfolio_series_rsi(pair, series, 14));
+        }
+        
+        double emas[3];
+        ema_bank_compute(closes, n, ema_periods, 3, emas, NULL);
+        for (int e = 0; e < 3; e++) {
+            if (n >= ema_periods[e]) screener_table_set(table, row, column[1 + e], emas[e]);
+        }
+        
+        const OhlcValues *ohlc = portfolio_series_ohlc(pair, series);
+        if (ohlc && ohlc->atr_ready) screener_table_set(table, row, column[4], ohlc->atr);
+        if (ohlc && ohlc->adx_ready) screener_table_set(table, row, column[5], ohlc->adx);
+        
+        double volatility = portfolio_series_volatility(pair, series, VOL_YANG_ZHANG);
+        if (volatility > 0) screener_table_set(table, row, column[6], volatility);
+        
+        screener_table_set(table, row, column[7], portfolio_series_trend(pair, series));
+    }
+    return row;
+}
+
+
+void portfolio_screener_columns(ScreenerTable *table) {
+    if (!table) return;
+    
+    ScreenerColumns columns;
+    register_screener_columns(table, &columns);
+}
+
+
+int portfolio_screener_fill_pair(const TradingPair *pair, ScreenerTable *table) {
+    if (!pair || !table) return -1;
+    
+    ScreenerColumns columns;
+    register_screener_columns(table, &columns);
+    return fill_screener_row(pair, table, &columns);
+}
+
+
+/* The series a screener column is computed from: the timeframe suffix,
+ * the tick price for close, and the 1h candles for the 24h figures. */
+SeriesId portfolio_screener_column_series(const char *name) {
+    if (!name) return SERIES_COUNT;
+    
+    const char *suffix = strrchr(name, '_');
+    if (suffix) return portfolio_series_from_interval(suffix + 1);
+    if (strcmp(name, "close") == 0) return SERIES_TICK;
+    if (strcmp(name, "change24h") == 0 || strcmp(name, "vol24h") == 0) return SERIES_1H;
+    return SERIES_COUNT;
+}
+
 double calculate_target_probability(const TradingPair *pair, double target_price, 
                                     double current_price, int trend, double volatility) {
     if (!pair || current_price <= 0 || target_price <= 0) return 0.5;
@@ -495,8 +791,12 @@ int estimate_time_to_target(const TradingPair *pair, double target_price,
     
     
     double avg_daily_movement = 0.03;  
+    double annualized = portfolio_annualized_volatility(pair);
     
-    if (pair->historical_1d_loaded && pair->historical_1d_count > 5) {
+    if (annualized > 0) {
+        /* Mean absolute daily log return, E|X| = sigma * sqrt(2 / pi). */
+        avg_daily_movement = annualized / sqrt(365.0) * sqrt(2.0 / M_PI);
+    } else if (pair->historical_1d_loaded && pair->historical_1d_count > 5) {
         
         double total_movement = 0.0;
         int movement_count = 0;
@@ -536,6 +836,92 @@ int estimate_time_to_target(const TradingPair *pair, double target_price,
 }
 
 
+#define TARGET_SIM_PATHS 5000
+#define TARGET_SIM_HORIZON_HOURS 720
+#define TARGET_SIM_MIN_CLOSES 30
+#define TARGET_SIM_BOOTSTRAP_CLOSES 100
+#define TARGET_SIM_BUCKET 0.001
+
+
+/* Prefers 4h candles: a 30 day horizon is then 180 steps, and the bridge
+ * test in the simulator covers crossings between closes. Short series
+ * run GBM rather than resampling a handful of returns. The seed depends
+ * only on symbol and target, so a refresh shows stable numbers. */
+static bool setup_target_sim(const TradingPair *pair, double current_price, double target_price,
+                             PathSimJob *job, SeriesId *series) {
+    static const SeriesId order[] = { SERIES_4H, SERIES_1H, SERIES_1D };
+    static const double step_hours[] = { 4.0, 1.0, 24.0 };
+    
+    for (int i = 0; i < 3; i++) {
+        int count = 0;
+        const double *closes = portfolio_series_data(pair, order[i], &count);
+        if (!closes || count < TARGET_SIM_MIN_CLOSES) continue;
+        
+        unsigned long long seed = 1469598103934665603ULL;
+        for (const char *c = pair->symbol; *c; c++) {
+            seed = (seed ^ (unsigned char)*c) * 1099511628211ULL;
+        }
+        unsigned long long target_bits;
+        memcpy(&target_bits, &target_price, sizeof(target_bits));
+        
+        memset(job, 0, sizeof(*job));
+        /* The last candle is still forming. */
+        job->closes = closes;
+        job->count = count - 1;
+        job->model = (job->count >= TARGET_SIM_BOOTSTRAP_CLOSES) ? PATH_SIM_BOOTSTRAP : PATH_SIM_GBM;
+        job->step_hours = step_hours[i];
+        job->steps = (int)(TARGET_SIM_HORIZON_HOURS / step_hours[i]);
+        job->paths = TARGET_SIM_PATHS;
+        job->seed = seed ^ target_bits;
+        job->start_price = current_price;
+        job->target_price = target_price;
+        job->sigma = portfolio_series_volatility(pair, order[i], VOL_YANG_ZHANG) *
+                     sqrt(step_hours[i] / (365.0 * 24.0));
+        *series = order[i];
+        return true;
+    }
+    return false;
+}
+
+
+/* Paths move in log returns, so the outcome depends on the target only
+ * through its log distance from the start price. Each side keeps one
+ * cache entry holding that distance in TARGET_SIM_BUCKET steps, and
+ * price ticks reuse it until the calibration candles change or the
+ * target moves to another bucket. values gets the probability and the
+ * p25, median and p75 hours. */
+static bool simulate_target(const TradingPair *pair, double current_price, double target_price,
+                            bool is_sell_target, double values[4]) {
+    double bucket = round(log(target_price / current_price) / TARGET_SIM_BUCKET);
+    double bucket_target = current_price * exp(bucket * TARGET_SIM_BUCKET);
+    
+    PathSimJob job;
+    SeriesId series;
+    if (!setup_target_sim(pair, current_price, bucket_target, &job, &series)) return false;
+    
+    IndicatorCache *cache = portfolio_indicator_cache(pair);
+    unsigned int key = indicator_cache_key(INDICATOR_TARGET_SIM, series, is_sell_target);
+    unsigned int version = pair->series_version[series];
+    double cached[INDICATOR_CACHE_VALUES];
+    if (indicator_cache_get(cache, key, version, cached, INDICATOR_CACHE_VALUES) && cached[0] == bucket) {
+        memcpy(values, &cached[1], 4 * sizeof(double));
+        return true;
+    }
+    
+    PathSimResult sim;
+    if (!path_sim_first_passage(&job, &sim)) return false;
+    
+    cached[0] = bucket;
+    cached[1] = sim.probability;
+    cached[2] = (sim.hits > 0) ? sim.p25_hours : TARGET_SIM_HORIZON_HOURS;
+    cached[3] = (sim.hits > 0) ? sim.median_hours : TARGET_SIM_HORIZON_HOURS;
+    cached[4] = (sim.hits > 0) ? sim.p75_hours : TARGET_SIM_HORIZON_HOURS;
+    indicator_cache_put(cache, key, version, cached, INDICATOR_CACHE_VALUES);
+    memcpy(values, &cached[1], 4 * sizeof(double));
+    return true;
+}
+
+
 void portfolio_analyze_target(const TradingPair *pair, double target_price, 
                               bool is_sell_target, TargetAnalysis *analysis) {
     if (!pair || !analysis || target_price <= 0) return;
@@ -549,8 +935,20 @@ void portfolio_analyze_target(const TradingPair *pair, double target_price,
     analysis->target_price = target_price;
     
     
-    analysis->probability = calculate_target_probability(pair, target_price, 
-                                                         current_price, trend, volatility);
+    double sim[4];
+    if (current_price > 0 && simulate_target(pair, current_price, target_price, is_sell_target, sim)) {
+        analysis->probability = sim[0];
+        analysis->hours_p25 = (int)ceil(sim[1]);
+        analysis->estimated_hours = (int)ceil(sim[2]);
+        analysis->hours_p75 = (int)ceil(sim[3]);
+    } else {
+        analysis->probability = calculate_target_probability(pair, target_price, 
+                                                             current_price, trend, volatility);
+        analysis->estimated_hours = estimate_time_to_target(pair, target_price, 
+                                                            current_price, volatility);
+        analysis->hours_p25 = analysis->estimated_hours;
+        analysis->hours_p75 = analysis->estimated_hours;
+    }
     
     
     if (is_sell_target) {
@@ -579,10 +977,6 @@ void portfolio_analyze_target(const TradingPair *pair, double target_price,
     }
     
     
-    analysis->estimated_hours = estimate_time_to_target(pair, target_price, 
-                                                        current_price, volatility);
-    
-    
     if (analysis->probability >= 0.75) {
         strcpy(analysis->confidence_level, "High");
     } else if (analysis->probability >= 0.55) {
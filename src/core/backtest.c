@@ -0,0 +1,268 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/backtest.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CONFIRM_CANDLE_MS (15 * 60 * 1000LL)
+#define CANDLES_PER_YEAR (365.0 * 24.0 * 12.0)
+
+
+void backtest_config_default(BacktestConfig *config) {
+    if (!config) return;
+    
+    config->initial_balance = 1000.0;
+    config->trade_amount = 100.0;
+    config->cooldown_seconds = BOT_COOLDOWN_SECONDS;
+    scalp_params_default(&config->params);
+    config->equity_stride = 1;
+    config->execution = NULL;
+    config->strategy = NULL;
+}
+
+
+static bool append_trade(BacktestResult *result, const TradeRecord *trade) {
+    if (result->trade_count == result->trade_capacity) {
+        int capacity = result->trade_capacity ? result->trade_capacity * 2 : 64;
+        TradeRecord *trades = realloc(result->trades, (size_t)capacity * sizeof(TradeRecord));
+        if (!trades) return false;
+        result->trades = trades;
+        result->trade_capacity = capacity;
+    }
+    result->trades[result->trade_count++] = *trade;
+    return true;
+}
+
+
+static bool append_equity(BacktestResult *result, long long time_ms, double equity) {
+    if (result->equity_count == result->equity_capacity) {
+        int capacity = result->equity_capacity ? result->equity_capacity * 2 : 1024;
+        EquityPoint *points = realloc(result->equity, (size_t)capacity * sizeof(EquityPoint));
+        if (!points) return false;
+        result->equity = points;
+        result->equity_capacity = capacity;
+    }
+    result->equity[result->equity_count].time_ms = time_ms;
+    result->equity[result->equity_count].equity = equity;
+    result->equity_count++;
+    return true;
+}
+
+
+/* Feeds candle as the forming 5m candle, the way portfolio_store_candles and
+ * the price ticks leave a live pair after a fetch. Only the forming candle
+ * is kept in the pair's 5m storage; the streams carry the history. */
+static void feed_candle(TradingPair *pair, const Candle *candle, bool first) {
+    if (first) {
+        Candle confirm = *candle;
+        confirm.open_time -= confirm.open_time % CONFIRM_CANDLE_MS;
+        scalp_stream_load(&pair->scalp_5m, candle, 1);
+        scalp_stream_load(&pair->scalp_15m, &confirm, 1);
+    } else {
+        scalp_stream_tick(&pair->scalp_5m, candle->close, candle->open_time);
+        scalp_stream_tick(&pair->scalp_15m, candle->close, candle->open_time);
+    }
+    
+    ohlc_stream_push(&pair->ohlc_stream[SERIES_5M], candle);
+    ohlc_stream_values(&pair->ohlc_stream[SERIES_5M], &pair->ohlc[SERIES_5M]);
+    pair->candles_5m[0] = *candle;
+    pair->candle_count[SERIES_5M] = 1;
+    pair->current_price = candle->close;
+}
+
+
+/* The path a candle is assumed to take as seen by an order: open, the
+ * extreme against the order, the other extreme, close, evenly spaced in
+ * time. Ordering by the close instead would let fills peek at where the
+ * candle ends up. */
+static void candle_path(const Candle *candle, bool buy, long long times[4], double prices[4]) {
+    prices[0] = candle->open;
+    prices[1] = buy ? candle->high : candle->low;
+    prices[2] = buy ? candle->low : candle->high;
+    prices[3] = candle->close;
+    for (int k = 0; k < 4; k++) {
+        times[k] = candle->open_time + k * BACKTEST_CANDLE_MS / 3;
+    }
+}
+
+
+static double path_price(const long long times[2], const double prices[2], long long t) {
+    if (times[1] <= times[0]) return prices[1];
+    return prices[0] + (prices[1] - prices[0]) * (double)(t - times[0]) / (double)(times[1] - times[0]);
+}
+
+
+/* First time in [start, end] the segment reaches limit from the order's
+ * side, or -1. */
+static long long crossing_time(const long long times[2], const double prices[2], long long start, long long end,
+                               double limit, bool buy) {
+    double from = path_price(times, prices, start);
+    double to = path_price(times, prices, end);
+    if (buy ? (from <= limit) : (from >= limit)) return start;
+    if (buy ? (to > limit) : (to < limit)) return -1;
+    
+    double t = start + (end - start) * (from - limit) / (from - to);
+    long long hit = (long long)ceil(t);
+    return (hit > end) ? end : hit;
+}
+
+
+/* Runs the bot's pending order along candle's path: a market order fills
+ * at the path price when it becomes due, a resting one when the path
+ * touches its limit, and it is cancelled if it expires first. */
+static void settle_in_candle(BotManager *manager, Clock *clock, int bot_index, const Candle *candle) {
+    const ScalpingBot *bot = bot_manager_get(manager, bot_index);
+    long long times[4];
+    double prices[4];
+    candle_path(candle, bot->order.buy, times, prices);
+    
+    for (int s = 0; s < 3 && bot->order.pending; s++) {
+        const BotOrder *order = &bot->order;
+        long long start = (order->due_ms > times[s]) ? order->due_ms : times[s];
+        long long end = times[s + 1];
+        
+        if (!order->maker) {
+            if (start > end) continue;
+            clock_set(clock, start);
+            bot_on_price(manager, bot_index, path_price(&times[s], &prices[s], start));
+            continue;
+        }
+        
+        if (order->expires_ms > 0 && order->expires_ms < end) end = order->expires_ms;
+        if (start <= end) {
+            long long hit = crossing_time(&times[s], &prices[s], start, end, order->limit, order->buy);
+            if (hit >= 0) {
+                clock_set(clock, hit);
+                bot_on_price(manager, bot_index, order->limit);
+                continue;
+            }
+        }
+        if (order->expires_ms > 0 && order->expires_ms <= times[s + 1]) {
+            clock_set(clock, order->expires_ms);
+            bot_on_price(manager, bot_index, path_price(&times[s], &prices[s], order->expires_ms));
+        }
+    }
+}
+
+
+bool backtest_run(const BacktestConfig *config, const char *symbol,
+                  const Candle *candles, int count, BacktestResult *result) {
+    if (!config || !symbol || !candles || count <= 0 || !result) return false;
+    
+    memset(result, 0, sizeof(*result));
+    
+    TradingPair *pair = calloc(1, sizeof(TradingPair));
+    BotManager *manager = bot_manager_create();
+    Clock *clock = clock_virtual_create(candles[0].open_time, 0.0);
+    if (!pair || !manager || !clock) {
+        free(pair);
+        bot_manager_destroy(manager);
+        clock_destroy(clock);
+        return false;
+    }
+    
+    portfolio_pair_init(pair, symbol, 0.0, 0.0, POSITION_LONG);
+    pair->scalp_params = config->params;
+    pair->historical_5m_loaded = true;
+    
+    manager->quiet = true;
+    manager->clock = clock;
+    manager->execution = config->execution;
+    int bot_index = bot_add_strategy(manager, symbol, config->initial_balance, config->trade_amount,
+                                     config->strategy);
+    ScalpingBot *bot = bot_manager_get(manager, bot_index);
+    if (!bot) {
+        free(pair);
+        bot_manager_destroy(manager);
+        clock_destroy(clock);
+        return false;
+    }
+    bot->cooldown_seconds = config->cooldown_seconds;
+    bot_start(manager, bot_index);
+    
+    int stride = (config->equity_stride > 1) ? config->equity_stride : 1;
+    double previous = config->initial_balance;
+    double return_mean = 0.0, return_m2 = 0.0;
+    bool ok = true;
+    
+    for (int i = 0; i < count && ok; i++) {
+        const Candle *candle = &candles[i];
+        long long close_time = candle->open_time + BACKTEST_CANDLE_MS;
+        
+        int trades_before = bot->total_trades;
+        if (bot->order.pending) {
+            settle_in_candle(manager, clock, bot_index, candle);
+        }
+        
+        feed_candle(pair, candle, i == 0);
+        evaluate_scalping_signals(pair);
+        
+        clock_set(clock, close_time);
+        bot_process_signal(manager, bot_index, pair);
+        bot_process_tick(manager, bot_index, pair);
+        for (int back = bot->total_trades - trades_before - 1; back >= 0 && ok; back--) {
+            ok = append_trade(result, bot_recent_trade(bot, back));
+        }
+        
+        bot_mark_to_market(manager, bot_index, candle->close);
+        double equity = bot->equity;
+        double change = (previous > 0) ? equity / previous - 1.0 : 0.0;
+        double delta = change - return_mean;
+        return_mean += delta / (i + 1);
+        return_m2 += delta * (change - return_mean);
+        previous = equity;
+        
+        if (ok && (i % stride == 0 || i == count - 1)) {
+            ok = append_equity(result, close_time, equity);
+        }
+    }
+    
+    result->candles = count;
+    result->final_equity = bot_get_total_value(bot, candles[count - 1].close);
+    result->roi = bot_get_roi(bot, candles[count - 1].close);
+    result->max_drawdown = bot->max_drawdown;
+    result->total_trades = bot->total_trades;
+    result->winning_trades = bot->winning_trades;
+    result->losing_trades = bot->losing_trades;
+    result->cancelled_orders = bot->cancelled_orders;
+    
+    double return_sd = (count > 1) ? sqrt(return_m2 / (count - 1)) : 0.0;
+    result->sharpe = (return_sd > 0) ? return_mean / return_sd * sqrt(CANDLES_PER_YEAR) : 0.0;
+    
+    for (int s = 0; s < SERIES_COUNT; s++) {
+        pivot_tracker_free(&pair->pivots[s]);
+    }
+    free(pair);
+    bot_manager_destroy(manager);
+    clock_destroy(clock);
+    
+    if (!ok) backtest_result_free(result);
+    return ok;
+}
+
+
+void backtest_result_free(BacktestResult *result) {
+    if (!result) return;
+    
+    free(result->trades);
+    free(result->equity);
+    memset(result, 0, sizeof(*result));
+}
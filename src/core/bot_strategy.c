@@ -0,0 +1,129 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/scalping_bot.h"
+#include <string.h>
+
+#define KELTNER_STOP_ATRS 1.0
+
+
+typedef struct {
+    double atr;         /* 5m ATR when the entry was signalled */
+    double stop;        /* sell at or below while holding, 0 when flat or not yet known */
+} KeltnerState;
+
+
+static ScalpSignal scalp_on_candle(const BotStrategy *strategy, void *state, const ScalpingBot *bot,
+                                   const TradingPair *pair) {
+    (void)strategy;
+    (void)state;
+    (void)bot;
+    return pair->scalp_signal;
+}
+
+
+static ScalpSignal keltner_on_tick(const BotStrategy *strategy, void *state, const ScalpingBot *bot,
+                                   const TradingPair *pair) {
+    (void)strategy;
+    KeltnerState *keltner = state;
+    const OhlcValues *values = portfolio_series_ohlc(pair, SERIES_5M);
+    bool ready = values && values->keltner_ready;
+    double price = pair->current_price;
+    
+    if (bot->current_position > 0.0001) {
+        /* Holding without a stop, as after a restore: set it from the
+         * entry price and the current ATR */
+        if (keltner->stop <= 0 && ready) {
+            keltner->atr = values->atr;
+            keltner->stop = bot->avg_buy_price - KELTNER_STOP_ATRS * keltner->atr;
+        }
+        if (keltner->stop > 0 && price <= keltner->stop) return SCALP_SELL_NOW;
+        if (ready && price >= values->keltner_middle) return SCALP_SELL_SIGNAL;
+        return SCALP_HOLD;
+    }
+    
+    if (ready && price <= values->keltner_lower) {
+        keltner->atr = values->atr;
+        return SCALP_BUY_DIP;
+    }
+    return SCALP_WAIT;
+}
+
+
+static void keltner_on_fill(const BotStrategy *strategy, void *state, const ScalpingBot *bot, bool buy,
+                            const Fill *fill) {
+    (void)strategy;
+    (void)bot;
+    KeltnerState *keltner = state;
+    keltner->stop = buy ? fill->price - KELTNER_STOP_ATRS * keltner->atr : 0.0;
+}
+
+
+static const BotStrategy scalp_strategy = {
+    .name = "scalp",
+    .on_candle = scalp_on_candle
+};
+
+static const BotStrategy keltner_strategy = {
+    .name = "keltner",
+    .state_size = sizeof(KeltnerState),
+    .on_tick = keltner_on_tick,
+    .on_fill = keltner_on_fill
+};
+
+static const BotStrategy *strategies[BOT_MAX_STRATEGIES] = { &scalp_strategy, &keltner_strategy };
+static int strategy_count = 2;
+
+
+const BotStrategy* bot_strategy_default(void) {
+    return &scalp_strategy;
+}
+
+
+/* Meant for startup: lookups take no lock against a concurrent register. */
+bool bot_strategy_register(const BotStrategy *strategy) {
+    if (!strategy || !strategy->name || !strategy->name[0]) return false;
+    if (strlen(strategy->name) >= JOURNAL_SYMBOL_LEN) return false;
+    if (strategy_count >= BOT_MAX_STRATEGIES || bot_strategy_find(strategy->name)) return false;
+    
+    strategies[strategy_count++] = strategy;
+    return true;
+}
+
+
+/* A NULL or empty name is the default; an unknown one gives NULL. */
+const BotStrategy* bot_strategy_find(const char *name) {
+    if (!name || !name[0]) return &scalp_strategy;
+    
+    for (int i = 0; i < strategy_count; i++) {
+        if (strcmp(strategies[i]->name, name) == 0) return strategies[i];
+    }
+    return NULL;
+}
+
+
+int bot_strategy_count(void) {
+    return strategy_count;
+}
+
+
+const BotStrategy* bot_strategy_at(int index) {
+    if (index < 0 || index >= strategy_count) return NULL;
+    return strategies[index];
+}
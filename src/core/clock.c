@@ -0,0 +1,133 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "portfolio/clock.h"
+#include <stdlib.h>
+
+typedef struct {
+    long long base_ms;
+    double anchor_real_ms;
+    double rate;
+} VirtualClock;
+
+static Clock *default_clock = NULL;
+
+
+static double real_now_precise_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (double)ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+
+static long long real_now_ms(const Clock *clock) {
+    (void)clock;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+static Clock real_clock = { real_now_ms, NULL, NULL };
+
+
+Clock* clock_real(void) {
+    return &real_clock;
+}
+
+
+static long long virtual_now_ms(const Clock *clock) {
+    const VirtualClock *state = clock->impl_data;
+    if (state->rate <= 0) return state->base_ms;
+    
+    double elapsed = real_now_precise_ms() - state->anchor_real_ms;
+    return state->base_ms + (long long)(elapsed * state->rate);
+}
+
+
+static void virtual_set_ms(Clock *clock, long long now_ms) {
+    VirtualClock *state = clock->impl_data;
+    state->base_ms = now_ms;
+    state->anchor_real_ms = real_now_precise_ms();
+}
+
+
+Clock* clock_virtual_create(long long start_ms, double rate) {
+    Clock *clock = calloc(1, sizeof(Clock));
+    VirtualClock *state = calloc(1, sizeof(VirtualClock));
+    if (!clock || !state) {
+        free(clock);
+        free(state);
+        return NULL;
+    }
+    
+    state->rate = (rate > 0) ? rate : 0.0;
+    clock->now_ms = virtual_now_ms;
+    clock->set_ms = virtual_set_ms;
+    clock->impl_data = state;
+    virtual_set_ms(clock, start_ms);
+    return clock;
+}
+
+
+void clock_destroy(Clock *clock) {
+    if (!clock || clock == &real_clock) return;
+    
+    if (default_clock == clock) default_clock = NULL;
+    free(clock->impl_data);
+    free(clock);
+}
+
+
+Clock* clock_default(void) {
+    return default_clock ? default_clock : &real_clock;
+}
+
+
+void clock_set_default(Clock *clock) {
+    default_clock = clock;
+}
+
+
+long long clock_now_ms(const Clock *clock) {
+    if (!clock) clock = clock_default();
+    return clock->now_ms(clock);
+}
+
+
+time_t clock_now(const Clock *clock) {
+    return (time_t)(clock_now_ms(clock) / 1000);
+}
+
+
+bool clock_set(Clock *clock, long long now_ms) {
+    if (!clock) clock = clock_default();
+    if (!clock->set_ms) return false;
+    
+    clock->set_ms(clock, now_ms);
+    return true;
+}
+
+
+bool clock_advance(Clock *clock, long long delta_ms) {
+    if (!clock) clock = clock_default();
+    return clock_set(clock, clock_now_ms(clock) + delta_ms);
+}
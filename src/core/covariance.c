@@ -0,0 +1,301 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/covariance.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COV_LANES 4
+#define COV_TILE 256
+
+
+struct CovarianceMatrix {
+    int symbols;
+    int stride;          /* symbols rounded up to COV_LANES */
+    int window;
+    
+    double *ring;        /* window rows of stride returns */
+    int head;
+    int samples;
+    int pushes_since_resum;
+    
+    double *sums;
+    double *cross;       /* upper triangle of the raw cross products, row-major */
+    double *zeros;
+    double *dropped;
+};
+
+
+#if defined(__GNUC__)
+typedef double CovLanes __attribute__((vector_size(COV_LANES * sizeof(double))));
+
+static inline void update_lanes(double *row, double add_scale, const double *add,
+                                double drop_scale, const double *drop) {
+    CovLanes r, a, d;
+    CovLanes as = { add_scale, add_scale, add_scale, add_scale };
+    CovLanes ds = { drop_scale, drop_scale, drop_scale, drop_scale };
+    memcpy(&r, row, sizeof(r));
+    memcpy(&a, add, sizeof(a));
+    memcpy(&d, drop, sizeof(d));
+    r += as * a - ds * d;
+    memcpy(row, &r, sizeof(r));
+}
+#else
+static void update_lanes(double *row, double add_scale, const double *add,
+                         double drop_scale, const double *drop) {
+    for (int k = 0; k < COV_LANES; k++) {
+        row[k] += add_scale * add[k] - drop_scale * drop[k];
+    }
+}
+#endif
+
+
+CovarianceMatrix* covariance_create(int symbols, int window) {
+    if (symbols <= 0 || window < 2) return NULL;
+    
+    CovarianceMatrix *matrix = calloc(1, sizeof(CovarianceMatrix));
+    if (!matrix) {
+        return NULL;
+    }
+    
+    matrix->symbols = symbols;
+    matrix->stride = (symbols + COV_LANES - 1) / COV_LANES * COV_LANES;
+    matrix->window = window;
+    
+    size_t stride = (size_t)matrix->stride;
+    matrix->ring = calloc((size_t)window * stride, sizeof(double));
+    matrix->sums = calloc(stride, sizeof(double));
+    matrix->cross = calloc((size_t)symbols * stride, sizeof(double));
+    matrix->zeros = calloc(stride, sizeof(double));
+    matrix->dropped = calloc(stride, sizeof(double));
+    if (!matrix->ring || !matrix->sums || !matrix->cross || !matrix->zeros || !matrix->dropped) {
+        covariance_destroy(matrix);
+        return NULL;
+    }
+    
+    return matrix;
+}
+
+
+void covariance_destroy(CovarianceMatrix *matrix) {
+    if (!matrix) return;
+    
+    free(matrix->ring);
+    free(matrix->sums);
+    free(matrix->cross);
+    free(matrix->zeros);
+    free(matrix->dropped);
+    free(matrix);
+}
+
+
+void covariance_reset(CovarianceMatrix *matrix) {
+    if (!matrix) return;
+    
+    size_t stride = (size_t)matrix->stride;
+    memset(matrix->ring, 0, (size_t)matrix->window * stride * sizeof(double));
+    memset(matrix->sums, 0, stride * sizeof(double));
+    memset(matrix->cross, 0, (size_t)matrix->symbols * stride * sizeof(double));
+    matrix->head = 0;
+    matrix->samples = 0;
+    matrix->pushes_since_resum = 0;
+}
+
+
+int covariance_symbols(const CovarianceMatrix *matrix) {
+    return matrix ? matrix->symbols : 0;
+}
+
+
+int covariance_samples(const CovarianceMatrix *matrix) {
+    return matrix ? matrix->samples : 0;
+}
+
+
+/* cross += add add^T - drop drop^T over the upper triangle. Columns go in
+ * tiles of COV_TILE so the add/drop slice stays in L1 for every row, and
+ * each row starts at the lane block holding its diagonal. The few entries
+ * left of the diagonal in that block are scratch and never read. */
+static void rank_update(CovarianceMatrix *matrix, const double *add, const double *drop) {
+    int n = matrix->symbols;
+    int stride = matrix->stride;
+    
+    for (int tile = 0; tile < stride; tile += COV_TILE) {
+        int tile_end = (tile + COV_TILE < stride) ? tile + COV_TILE : stride;
+        int row_end = (tile_end < n) ? tile_end : n;
+        
+        for (int i = 0; i < row_end; i++) {
+            double *row = matrix->cross + (size_t)i * stride;
+            int start = i / COV_LANES * COV_LANES;
+            if (start < tile) start = tile;
+            
+            double a = add[i];
+            double d = drop[i];
+            for (int j = start; j < tile_end; j += COV_LANES) {
+                update_lanes(row + j, a, add + j, d, drop + j);
+            }
+        }
+    }
+}
+
+
+/* Re-adds the window from the ring so rounding from the downdates cannot
+ * pile up; run every window pushes, it costs one extra update per push. */
+static void resum(CovarianceMatrix *matrix) {
+    size_t stride = (size_t)matrix->stride;
+    memset(matrix->sums, 0, stride * sizeof(double));
+    memset(matrix->cross, 0, (size_t)matrix->symbols * stride * sizeof(double));
+    
+    for (int s = 0; s < matrix->samples; s++) {
+        int slot = (matrix->head - matrix->samples + s + matrix->window) % matrix->window;
+        const double *row = matrix->ring + (size_t)slot * stride;
+        
+        for (int i = 0; i < matrix->symbols; i++) {
+            matrix->sums[i] += row[i];
+        }
+        rank_update(matrix, row, matrix->zeros);
+    }
+    matrix->pushes_since_resum = 0;
+}
+
+
+bool covariance_push(CovarianceMatrix *matrix, const double *returns) {
+    if (!matrix || !returns) return false;
+    
+    size_t stride = (size_t)matrix->stride;
+    double *slot = matrix->ring + (size_t)matrix->head * stride;
+    bool full = (matrix->samples == matrix->window);
+    
+    /* The slot about to be overwritten holds the oldest sample. */
+    double *drop = matrix->zeros;
+    if (full) {
+        drop = matrix->dropped;
+        memcpy(drop, slot, stride * sizeof(double));
+    }
+    
+    memcpy(slot, returns, (size_t)matrix->symbols * sizeof(double));
+    for (int i = 0; i < matrix->symbols; i++) {
+        matrix->sums[i] += returns[i] - drop[i];
+    }
+    rank_update(matrix, slot, drop);
+    
+    matrix->head = (matrix->head + 1) % matrix->window;
+    if (!full) matrix->samples++;
+    
+    if (++matrix->pushes_since_resum >= matrix->window) {
+        resum(matrix);
+    }
+    return true;
+}
+
+
+double covariance_get(const CovarianceMatrix *matrix, int i, int j) {
+    if (!matrix || i < 0 || j < 0 || i >= matrix->symbols || j >= matrix->symbols) return 0.0;
+    if (matrix->samples < 2) return 0.0;
+    
+    if (i > j) {
+        int t = i;
+        i = j;
+        j = t;
+    }
+    
+    double k = matrix->samples;
+    double cross = matrix->cross[(size_t)i * matrix->stride + j];
+    return (cross - matrix->sums[i] * matrix->sums[j] / k) / (k - 1.0);
+}
+
+
+double correlation_get(const CovarianceMatrix *matrix, int i, int j) {
+    double var_i = covariance_get(matrix, i, i);
+    double var_j = covariance_get(matrix, j, j);
+    if (var_i <= 0 || var_j <= 0) return 0.0;
+    
+    double rho = covariance_get(matrix, i, j) / sqrt(var_i * var_j);
+    if (rho > 1.0) rho = 1.0;
+    if (rho < -1.0) rho = -1.0;
+    return rho;
+}
+
+
+double covariance_mean(const CovarianceMatrix *matrix, int i) {
+    if (!matrix || i < 0 || i >= matrix->symbols || matrix->samples == 0) return 0.0;
+    return matrix->sums[i] / matrix->samples;
+}
+
+
+/* Writes the full symbols x symbols covariance, row-major. */
+bool covariance_fill(const CovarianceMatrix *matrix, double *out) {
+    if (!matrix || !out || matrix->samples < 2) return false;
+    
+    int n = matrix->symbols;
+    for (int i = 0; i < n; i++) {
+        for (int j = i; j < n; j++) {
+            double value = covariance_get(matrix, i, j);
+            out[(size_t)i * n + j] = value;
+            out[(size_t)j * n + i] = value;
+        }
+    }
+    return true;
+}
+
+
+bool covariance_diversification(const CovarianceMatrix *matrix, const double *weights,
+                                DiversificationMetrics *metrics) {
+    if (!matrix || !metrics || matrix->samples < 2) return false;
+    
+    memset(metrics, 0, sizeof(*metrics));
+    int n = matrix->symbols;
+    double equal = 1.0 / n;
+    
+    double variance = 0.0;
+    double weighted_volatility = 0.0;
+    double correlation_sum = 0.0;
+    double pair_weight = 0.0;
+    
+    for (int i = 0; i < n; i++) {
+        double wi = weights ? weights[i] : equal;
+        double var_i = covariance_get(matrix, i, i);
+        variance += wi * wi * var_i;
+        weighted_volatility += fabs(wi) * sqrt(var_i > 0 ? var_i : 0.0);
+        
+        for (int j = i + 1; j < n; j++) {
+            double wj = weights ? weights[j] : equal;
+            double rho = correlation_get(matrix, i, j);
+            variance += 2.0 * wi * wj * covariance_get(matrix, i, j);
+            correlation_sum += wi * wj * rho;
+            pair_weight += fabs(wi * wj);
+            
+            if (metrics->most_correlated_a == metrics->most_correlated_b || rho > metrics->max_correlation) {
+                metrics->max_correlation = rho;
+                metrics->most_correlated_a = i;
+                metrics->most_correlated_b = j;
+            }
+        }
+    }
+    
+    metrics->portfolio_volatility = (variance > 0) ? sqrt(variance) : 0.0;
+    metrics->weighted_volatility = weighted_volatility;
+    if (metrics->portfolio_volatility > 0) {
+        metrics->diversification_ratio = weighted_volatility / metrics->portfolio_volatility;
+        metrics->effective_bets = metrics->diversification_ratio * metrics->diversification_ratio;
+    }
+    metrics->average_correlation = (pair_weight > 0) ? correlation_sum / pair_weight : 0.0;
+    return true;
+}
@@ -0,0 +1,143 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/ema_bank.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EMA_BANK_LANES 4
+#define EMA_BANK_STACK_PERIODS 32
+
+
+typedef struct {
+    int period;
+    int slot;
+} BankEntry;
+
+
+#if defined(__GNUC__)
+typedef double EmaLanes __attribute__((vector_size(EMA_BANK_LANES * sizeof(double))));
+
+static inline void update_lanes(double *ema, const double *alpha, double x) {
+    EmaLanes e, a;
+    EmaLanes xs = { x, x, x, x };
+    memcpy(&e, ema, sizeof(e));
+    memcpy(&a, alpha, sizeof(a));
+    e = (xs - e) * a + e;
+    memcpy(ema, &e, sizeof(e));
+}
+#else
+static void update_lanes(double *ema, const double *alpha, double x) {
+    for (int k = 0; k < EMA_BANK_LANES; k++) {
+        ema[k] = (x - ema[k]) * alpha[k] + ema[k];
+    }
+}
+#endif
+
+
+static int compare_entries(const void *a, const void *b) {
+    const BankEntry *x = a;
+    const BankEntry *y = b;
+    if (x->period != y->period) return (x->period < y->period) ? -1 : 1;
+    return x->slot - y->slot;
+}
+
+
+/* Periods are processed shortest first, so at candle i the seeded EMAs
+ * are always a prefix of the bank. That prefix is updated in blocks of
+ * EMA_BANK_LANES lanes with GCC vector types, so each block is a couple
+ * of SIMD multiply-adds. Lanes past the prefix hold scratch values until
+ * their seed overwrites them. */
+bool ema_bank_compute(const double *prices, int count, const int *periods, int period_count,
+                      double *last, double *previous) {
+    if (!prices || !periods || !last || period_count <= 0 || count < 0) {
+        return false;
+    }
+    
+    int padded = (period_count + EMA_BANK_LANES - 1) / EMA_BANK_LANES * EMA_BANK_LANES;
+    
+    BankEntry stack_entries[EMA_BANK_STACK_PERIODS];
+    double stack_lanes[2 * EMA_BANK_STACK_PERIODS];
+    BankEntry *entries = stack_entries;
+    double *lanes = stack_lanes;
+    
+    if (padded > EMA_BANK_STACK_PERIODS) {
+        entries = malloc(padded * sizeof(BankEntry));
+        lanes = malloc(2 * padded * sizeof(double));
+        if (!entries || !lanes) {
+            free(entries);
+            free(lanes);
+            return false;
+        }
+    }
+    
+    double *ema = lanes;
+    double *alpha = lanes + padded;
+    
+    for (int i = 0; i < period_count; i++) {
+        entries[i].period = periods[i];
+        entries[i].slot = i;
+        last[i] = 0.0;
+        if (previous) previous[i] = 0.0;
+    }
+    qsort(entries, period_count, sizeof(BankEntry), compare_entries);
+    
+    for (int i = 0; i < padded; i++) {
+        ema[i] = 0.0;
+        alpha[i] = (i < period_count && entries[i].period > 0) ? 2.0 / (entries[i].period + 1.0) : 0.0;
+    }
+    
+    int active = 0;
+    while (active < period_count && entries[active].period < 1) {
+        active++;
+    }
+    int first_valid = active;
+    
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) {
+        double x = prices[i];
+        int blocks = (active + EMA_BANK_LANES - 1) / EMA_BANK_LANES * EMA_BANK_LANES;
+        
+        for (int j = 0; j < blocks; j += EMA_BANK_LANES) {
+            update_lanes(ema + j, alpha + j, x);
+        }
+        
+        sum += x;
+        while (active < period_count && entries[active].period == i + 1) {
+            ema[active] = sum / entries[active].period;
+            active++;
+        }
+        
+        if (previous && i == count - 2) {
+            for (int j = first_valid; j < active; j++) {
+                previous[entries[j].slot] = ema[j];
+            }
+        }
+    }
+    
+    for (int j = first_valid; j < active; j++) {
+        last[entries[j].slot] = ema[j];
+    }
+    
+    if (entries != stack_entries) {
+        free(entries);
+        free(lanes);
+    }
+    return true;
+}
@@ -18,10 +18,14 @@
  */
 
 #include "portfolio/portfolio_core.h"
+#include "portfolio/worker_pool.h"
+#include "portfolio/ema_bank.h"
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
 
+#define EMA_CACHE_BATCH 8
+
 
 double calculate_ema(const double *prices, int count, int period) {
     if (!prices || count < period || period < 1) {
@@ -47,6 +51,67 @@ double calculate_ema(const double *prices, int count, int period) {
 }
 
 
+/* Fills out[i] with the EMA for periods[i], computing the periods the
+ * cache does not already hold in one bank pass per EMA_CACHE_BATCH. */
+static void cached_emas(const TradingPair *pair, SeriesId series, const double *prices, int count,
+                        const int *periods, int period_count, double *out) {
+    while (period_count > EMA_CACHE_BATCH) {
+        cached_emas(pair, series, prices, count, periods, EMA_CACHE_BATCH, out);
+        periods += EMA_CACHE_BATCH;
+        out += EMA_CACHE_BATCH;
+        period_count -= EMA_CACHE_BATCH;
+    }
+    
+    unsigned int version = pair->series_version[series];
+    int missing[EMA_CACHE_BATCH];
+    int missing_slot[EMA_CACHE_BATCH];
+    int missing_count = 0;
+    
+    for (int i = 0; i < period_count; i++) {
+        unsigned int key = indicator_cache_key(INDICATOR_EMA, series, periods[i]);
+        if (!indicator_cache_get(portfolio_indicator_cache(pair), key, version, &out[i], 1)) {
+            missing[missing_count] = periods[i];
+            missing_slot[missing_count++] = i;
+        }
+    }
+    if (missing_count == 0) return;
+    
+    double computed[EMA_CACHE_BATCH];
+    ema_bank_compute(prices, count, missing, missing_count, computed, NULL);
+    
+    for (int m = 0; m < missing_count; m++) {
+        int i = missing_slot[m];
+        out[i] = computed[m];
+        unsigned int key = indicator_cache_key(INDICATOR_EMA, series, periods[i]);
+        indicator_cache_put(portfolio_indicator_cache(pair), key, version, &out[i], 1);
+    }
+}
+
+
+static bool cached_pattern(const TradingPair *pair, IndicatorKind kind, SeriesId series,
+                           bool (*detector)(const PivotTracker *, int *), int *pattern_idx) {
+    unsigned int key = indicator_cache_key(kind, series, 0);
+    unsigned int version = pair->series_version[series];
+    double values[2];
+    
+    if (!indicator_cache_get(portfolio_indicator_cache(pair), key, version, values, 2)) {
+        int idx = -1;
+        
+        values[0] = detector(&pair->pivots[series], &idx) ? 1.0 : 0.0;
+        values[1] = idx;
+        indicator_cache_put(portfolio_indicator_cache(pair), key, version, values, 2);
+    }
+    
+    if (pattern_idx) *pattern_idx = (int)values[1];
+    return values[0] != 0.0;
+}
+
+
+static SeriesId pattern_series(const TradingPair *pair) {
+    return pair->historical_1h_loaded ? SERIES_1H : SERIES_LEGACY;
+}
+
+
 void calculate_macd(const TradingPair *pair, double *macd, double *signal, double *histogram) {
     if (!pair || !macd || !signal || !histogram) {
         return;
@@ -58,30 +123,49 @@ void calculate_macd(const TradingPair *pair, double *macd, double *signal, doubl
     
     const double *prices = NULL;
     int count = 0;
+    SeriesId series;
     
     
     if (pair->historical_1h_loaded && pair->historical_1h_count >= 26) {
         prices = pair->historical_1h;
         count = pair->historical_1h_count;
+        series = SERIES_1H;
     } else if (pair->historical_loaded && pair->historical_count >= 26) {
         prices = pair->historical_prices;
         count = pair->historical_count;
+        series = SERIES_LEGACY;
     } else {
         return;
     }
     
+    unsigned int key = indicator_cache_key(INDICATOR_MACD, series, 0);
+    unsigned int version = pair->series_version[series];
+    double values[3];
+    if (indicator_cache_get(portfolio_indicator_cache(pair), key, version, values, 3)) {
+        *macd = values[0];
+        *signal = values[1];
+        *histogram = values[2];
+        return;
+    }
+    
     
-    double ema12 = calculate_ema(prices, count, 12);
-    double ema26 = calculate_ema(prices, count, 26);
+    static const int MACD_PERIODS[2] = { 12, 26 };
+    double emas[2];
+    cached_emas(pair, series, prices, count, MACD_PERIODS, 2, emas);
     
     
-    *macd = ema12 - ema26;
+    *macd = emas[0] - emas[1];
     
     
     *signal = *macd * 0.9;  
     
     
     *histogram = *macd - *signal;
+    
+    values[0] = *macd;
+    values[1] = *signal;
+    values[2] = *histogram;
+    indicator_cache_put(portfolio_indicator_cache(pair), key, version, values, 3);
 }
 
 
@@ -97,18 +181,31 @@ void calculate_bollinger_bands(const TradingPair *pair, double *upper, double *m
     const double *prices = NULL;
     int count = 0;
     int period = 20;
+    SeriesId series;
     
     
     if (pair->historical_1h_loaded && pair->historical_1h_count >= period) {
         prices = pair->historical_1h;
         count = pair->historical_1h_count;
+        series = SERIES_1H;
     } else if (pair->historical_loaded && pair->historical_count >= period) {
         prices = pair->historical_prices;
         count = pair->historical_count;
+        series = SERIES_LEGACY;
     } else {
         return;
     }
     
+    unsigned int key = indicator_cache_key(INDICATOR_BOLLINGER, series, period);
+    unsigned int version = pair->series_version[series];
+    double values[3];
+    if (indicator_cache_get(portfolio_indicator_cache(pair), key, version, values, 3)) {
+        *upper = values[0];
+        *middle = values[1];
+        *lower = values[2];
+        return;
+    }
+    
     
     double sum = 0.0;
     int start_idx = count - period;
@@ -129,6 +226,22 @@ void calculate_bollinger_bands(const TradingPair *pair, double *upper, double *m
     
     *upper = *middle + (2.0 * std_dev);
     *lower = *middle - (2.0 * std_dev);
+    
+    values[0] = *upper;
+    values[1] = *middle;
+    values[2] = *lower;
+    indicator_cache_put(portfolio_indicator_cache(pair), key, version, values, 3);
+}
+
+
+static SeriesId ema_cross_series(const TradingPair *pair, int slow_period) {
+    if (pair->historical_1d_loaded && pair->historical_1d_count >= slow_period) {
+        return SERIES_1D;
+    }
+    if (pair->historical_1h_loaded && pair->historical_1h_count >= slow_period) {
+        return SERIES_1H;
+    }
+    return SERIES_COUNT;
 }
 
 
@@ -137,302 +250,91 @@ int detect_ema_cross(const TradingPair *pair, int fast_period, int slow_period)
         return 0;
     }
     
-    const double *prices = NULL;
-    int count = 0;
-    
-    
-    if (pair->historical_1d_loaded && pair->historical_1d_count >= slow_period) {
-        prices = pair->historical_1d;
-        count = pair->historical_1d_count;
-    } else if (pair->historical_1h_loaded && pair->historical_1h_count >= slow_period) {
-        prices = pair->historical_1h;
-        count = pair->historical_1h_count;
-    } else {
+    SeriesId series = ema_cross_series(pair, slow_period);
+    if (series == SERIES_COUNT) {
         return 0;
     }
     
+    int count = 0;
+    const double *prices = portfolio_series_data(pair, series, &count);
     
-    double fast_ema = calculate_ema(prices, count, fast_period);
-    double slow_ema = calculate_ema(prices, count, slow_period);
-    
-    
-    if (count < slow_period + 1) {
-        return 0;
+    unsigned int key = indicator_cache_key(INDICATOR_EMA_CROSS, series, (fast_period << 8) | slow_period);
+    unsigned int version = pair->series_version[series];
+    double cached;
+    if (indicator_cache_get(portfolio_indicator_cache(pair), key, version, &cached, 1)) {
+        return (int)cached;
     }
-    double fast_ema_prev = calculate_ema(prices, count - 1, fast_period);
-    double slow_ema_prev = calculate_ema(prices, count - 1, slow_period);
     
     
-    if (fast_ema > slow_ema && fast_ema_prev <= slow_ema_prev) {
-        return 1;  
-    } else if (fast_ema < slow_ema && fast_ema_prev >= slow_ema_prev) {
-        return -1; 
-    }
-    
-    return 0; 
-}
-
-
-bool detect_double_bottom(const double *prices, int count, int *pattern_idx) {
-    if (!prices || count < 20 || !pattern_idx) {
-        return false;
-    }
+    int cross_periods[2] = { fast_period, slow_period };
+    double emas[2], emas_prev[2];
+    ema_bank_compute(prices, count, cross_periods, 2, emas, emas_prev);
     
-    *pattern_idx = -1;
+    double fast_ema = emas[0];
+    double slow_ema = emas[1];
     
     
-    for (int i = 10; i < count - 10; i++) {
-        double current_price = prices[i];
+    int cross = 0;
+    if (count >= slow_period + 1) {
+        double fast_ema_prev = emas_prev[0];
+        double slow_ema_prev = emas_prev[1];
         
         
-        bool is_local_min = true;
-        for (int j = i - 5; j <= i + 5; j++) {
-            if (j != i && prices[j] < current_price) {
-                is_local_min = false;
-                break;
-            }
-        }
-        
-        if (!is_local_min) continue;
-        
-        
-        for (int j = i + 10; j < count - 5; j++) {
-            double potential_match = prices[j];
-            
-            
-            double diff_percent = fabs(potential_match - current_price) / current_price;
-            if (diff_percent < 0.02) {
-                
-                double max_between = current_price;
-                for (int k = i; k <= j; k++) {
-                    if (prices[k] > max_between) {
-                        max_between = prices[k];
-                    }
-                }
-                
-                
-                if ((max_between - current_price) / current_price > 0.03) {
-                    *pattern_idx = j;
-                    return true;
-                }
-            }
+        if (fast_ema > slow_ema && fast_ema_prev <= slow_ema_prev) {
+            cross = 1;  
+        } else if (fast_ema < slow_ema && fast_ema_prev >= slow_ema_prev) {
+            cross = -1; 
         }
     }
     
-    return false;
+    cached = cross;
+    indicator_cache_put(portfolio_indicator_cache(pair), key, version, &cached, 1);
+    return cross; 
 }
 
 
-bool detect_double_top(const double *prices, int count, int *pattern_idx) {
-    if (!prices || count < 20 || !pattern_idx) {
+static bool detect_on_series(const double *prices, int count, int min_count,
+                             bool (*detector)(const PivotTracker *, int *), int *pattern_idx) {
+    if (!prices || count < min_count || !pattern_idx) {
         return false;
     }
     
-    *pattern_idx = -1;
-    
-    
-    for (int i = 10; i < count - 10; i++) {
-        double current_price = prices[i];
-        
-        
-        bool is_local_max = true;
-        for (int j = i - 5; j <= i + 5; j++) {
-            if (j != i && prices[j] > current_price) {
-                is_local_max = false;
-                break;
-            }
-        }
-        
-        if (!is_local_max) continue;
-        
-        
-        for (int j = i + 10; j < count - 5; j++) {
-            double potential_match = prices[j];
-            
-            
-            double diff_percent = fabs(potential_match - current_price) / current_price;
-            if (diff_percent < 0.02) {
-                
-                double min_between = current_price;
-                for (int k = i; k <= j; k++) {
-                    if (prices[k] < min_between) {
-                        min_between = prices[k];
-                    }
-                }
-                
-                
-                if ((current_price - min_between) / current_price > 0.03) {
-                    *pattern_idx = j;
-                    return true;
-                }
-            }
-        }
-    }
-    
-    return false;
+    PivotTracker tracker = {0};
+    bool found = pivot_tracker_build(&tracker, prices, count) &&
+                 detector(&tracker, pattern_idx);
+    pivot_tracker_free(&tracker);
+    return found;
+}
+
+
+bool detect_double_bottom(const double *prices, int count, int *pattern_idx) {
+    return detect_on_series(prices, count, 20, pivot_detect_double_bottom, pattern_idx);
+}
+
+
+bool detect_double_top(const double *prices, int count, int *pattern_idx) {
+    return detect_on_series(prices, count, 20, pivot_detect_double_top, pattern_idx);
 }
 
 
 bool detect_head_shoulders(const double *prices, int count, int *pattern_idx) {
-    if (!prices || count < 30 || !pattern_idx) {
-        return false;
-    }
-    
-    *pattern_idx = -1;
-    
-    
-    for (int head = 15; head < count - 15; head++) {
-        double head_price = prices[head];
-        
-        
-        bool is_local_max = true;
-        for (int j = head - 5; j <= head + 5; j++) {
-            if (j != head && prices[j] > head_price) {
-                is_local_max = false;
-                break;
-            }
-        }
-        
-        if (!is_local_max) continue;
-        
-        
-        for (int left = head - 15; left < head - 5; left++) {
-            if (prices[left] < head_price * 0.95) continue; 
-            
-            
-            for (int right = head + 5; right < head + 15 && right < count; right++) {
-                if (prices[right] < head_price * 0.95) continue;
-                
-                
-                double shoulder_diff = fabs(prices[left] - prices[right]) / prices[left];
-                if (shoulder_diff < 0.03) {
-                    *pattern_idx = right;
-                    return true;
-                }
-            }
-        }
-    }
-    
-    return false;
+    return detect_on_series(prices, count, 30, pivot_detect_head_shoulders, pattern_idx);
 }
 
 
 bool detect_inverse_head_shoulders(const double *prices, int count, int *pattern_idx) {
-    if (!prices || count < 30 || !pattern_idx) {
-        return false;
-    }
-    
-    *pattern_idx = -1;
-    
-    
-    for (int head = 15; head < count - 15; head++) {
-        double head_price = prices[head];
-        
-        
-        bool is_local_min = true;
-        for (int j = head - 5; j <= head + 5; j++) {
-            if (j != head && prices[j] < head_price) {
-                is_local_min = false;
-                break;
-            }
-        }
-        
-        if (!is_local_min) continue;
-        
-        
-        for (int left = head - 15; left < head - 5; left++) {
-            if (prices[left] > head_price * 1.05) continue; 
-            
-            
-            for (int right = head + 5; right < head + 15 && right < count; right++) {
-                if (prices[right] > head_price * 1.05) continue;
-                
-                
-                double shoulder_diff = fabs(prices[left] - prices[right]) / prices[left];
-                if (shoulder_diff < 0.03) {
-                    *pattern_idx = right;
-                    return true;
-                }
-            }
-        }
-    }
-    
-    return false;
+    return detect_on_series(prices, count, 30, pivot_detect_inverse_head_shoulders, pattern_idx);
 }
 
 
+/* Kept current by portfolio_store_series; see init_trend_consensus for the
+ * timeframes and weights that take part. */
 int calculate_trend_multi_timeframe(const TradingPair *pair) {
     if (!pair) {
         return 0;
     }
     
-    int trend_1h = 0, trend_4h = 0, trend_1d = 0;
-    
-    
-    if (pair->historical_1h_loaded && pair->historical_1h_count >= 10) {
-        int count = pair->historical_1h_count;
-        double avg_early = 0.0, avg_recent = 0.0;
-        int period = 10;
-        
-        for (int i = count - period * 2; i < count - period; i++) {
-            if (i >= 0) avg_early += pair->historical_1h[i];
-        }
-        avg_early /= period;
-        
-        for (int i = count - period; i < count; i++) {
-            if (i >= 0) avg_recent += pair->historical_1h[i];
-        }
-        avg_recent /= period;
-        
-        if (avg_recent > avg_early * 1.01) trend_1h = 1;
-        else if (avg_recent < avg_early * 0.99) trend_1h = -1;
-    }
-    
-    
-    if (pair->historical_4h_loaded && pair->historical_4h_count >= 10) {
-        int count = pair->historical_4h_count;
-        double avg_early = 0.0, avg_recent = 0.0;
-        int period = 10;
-        
-        for (int i = count - period * 2; i < count - period; i++) {
-            if (i >= 0) avg_early += pair->historical_4h[i];
-        }
-        avg_early /= period;
-        
-        for (int i = count - period; i < count; i++) {
-            if (i >= 0) avg_recent += pair->historical_4h[i];
-        }
-        avg_recent /= period;
-        
-        if (avg_recent > avg_early * 1.01) trend_4h = 1;
-        else if (avg_recent < avg_early * 0.99) trend_4h = -1;
-    }
-    
-    
-    if (pair->historical_1d_loaded && pair->historical_1d_count >= 10) {
-        int count = pair->historical_1d_count;
-        double avg_early = 0.0, avg_recent = 0.0;
-        int period = 10;
-        
-        for (int i = count - period * 2; i < count - period; i++) {
-            if (i >= 0) avg_early += pair->historical_1d[i];
-        }
-        avg_early /= period;
-        
-        for (int i = count - period; i < count; i++) {
-            if (i >= 0) avg_recent += pair->historical_1d[i];
-        }
-        avg_recent /= period;
-        
-        if (avg_recent > avg_early * 1.01) trend_1d = 1;
-        else if (avg_recent < avg_early * 0.99) trend_1d = -1;
-    }
-    
-    
-    int total = trend_1h + trend_4h + trend_1d;
-    if (total >= 2) return 1;      
-    if (total <= -2) return -1;    
-    return 0;                       
+    return trend_consensus_direction(&pair->trend);
 }
 
 
@@ -478,22 +380,21 @@ double calculate_profit_probability(const TradingPair *pair) {
     
     
     int pattern_idx;
-    const double *prices = pair->historical_1h_loaded ? pair->historical_1h : pair->historical_prices;
-    int count = pair->historical_1h_loaded ? pair->historical_1h_count : pair->historical_count;
+    SeriesId series = pattern_series(pair);
     
-    if (detect_double_bottom(prices, count, &pattern_idx)) {
+    if (cached_pattern(pair, INDICATOR_DOUBLE_BOTTOM, series, pivot_detect_double_bottom, &pattern_idx)) {
         score += 25.0 * 1.8;
         total_weight += 1.8;
     }
-    if (detect_inverse_head_shoulders(prices, count, &pattern_idx)) {
+    if (cached_pattern(pair, INDICATOR_INV_HEAD_SHOULDERS, series, pivot_detect_inverse_head_shoulders, &pattern_idx)) {
         score += 30.0 * 2.0;
         total_weight += 2.0;
     }
-    if (detect_double_top(prices, count, &pattern_idx)) {
+    if (cached_pattern(pair, INDICATOR_DOUBLE_TOP, series, pivot_detect_double_top, &pattern_idx)) {
         score -= 25.0 * 1.8;
         total_weight += 1.8;
     }
-    if (detect_head_shoulders(prices, count, &pattern_idx)) {
+    if (cached_pattern(pair, INDICATOR_HEAD_SHOULDERS, series, pivot_detect_head_shoulders, &pattern_idx)) {
         score -= 30.0 * 2.0;
         total_weight += 2.0;
     }
@@ -538,100 +439,230 @@ double calculate_profit_probability(const TradingPair *pair) {
 }
 
 
+typedef struct {
+    const PivotTracker *tracker;
+    PatternHits hits;
+} PatternScan;
+
+static const struct {
+    PatternKind kind;
+    IndicatorKind indicator;
+    bool (*detector)(const PivotTracker *, int *);
+} CHART_PATTERNS[] = {
+    { PATTERN_DOUBLE_BOTTOM, INDICATOR_DOUBLE_BOTTOM, pivot_detect_double_bottom },
+    { PATTERN_DOUBLE_TOP, INDICATOR_DOUBLE_TOP, pivot_detect_double_top },
+    { PATTERN_INV_HEAD_SHOULDERS, INDICATOR_INV_HEAD_SHOULDERS, pivot_detect_inverse_head_shoulders },
+    { PATTERN_HEAD_SHOULDERS, INDICATOR_HEAD_SHOULDERS, pivot_detect_head_shoulders }
+};
+
+#define CHART_PATTERN_COUNT ((int)(sizeof(CHART_PATTERNS) / sizeof(CHART_PATTERNS[0])))
+
+
+/* Runs on a pool thread; only reads the tracker, which stays untouched
+ * until worker_pool_run returns. */
+static void scan_patterns_task(void *arg) {
+    PatternScan *scan = arg;
+    
+    for (int i = 0; i < CHART_PATTERN_COUNT; i++) {
+        int idx = -1;
+        if (CHART_PATTERNS[i].detector(scan->tracker, &idx)) {
+            scan->hits.mask |= 1u << CHART_PATTERNS[i].kind;
+            scan->hits.index[CHART_PATTERNS[i].kind] = idx;
+        }
+    }
+}
+
+
+void scan_all_patterns(TradingPair *pair) {
+    if (!pair) return;
+    
+    PatternScan scans[SERIES_COUNT];
+    SeriesId scanned[SERIES_COUNT];
+    int pending = 0;
+    
+    for (int s = SERIES_LEGACY; s < SERIES_COUNT; s++) {
+        PatternHits *hits = &pair->patterns[s];
+        unsigned int version = pair->series_version[s];
+        if (hits->version == version) continue;
+        
+        int count = 0;
+        if (!portfolio_series_data(pair, (SeriesId)s, &count) || count == 0) {
+            memset(hits, 0, sizeof(*hits));
+            hits->version = version;
+            continue;
+        }
+        
+        PatternScan *scan = &scans[pending];
+        scan->tracker = &pair->pivots[s];
+        scan->hits.mask = 0;
+        scan->hits.version = version;
+        for (int k = 0; k < PATTERN_KIND_COUNT; k++) {
+            scan->hits.index[k] = -1;
+        }
+        scanned[pending++] = (SeriesId)s;
+    }
+    
+    worker_pool_run(worker_pool_default(), scan_patterns_task, scans, sizeof(PatternScan), pending);
+    
+    /* Feed the results to the indicator cache so calculate_profit_probability
+     * does not scan the same series again. */
+    for (int i = 0; i < pending; i++) {
+        SeriesId series = scanned[i];
+        pair->patterns[series] = scans[i].hits;
+        
+        for (int p = 0; p < CHART_PATTERN_COUNT; p++) {
+            PatternKind kind = CHART_PATTERNS[p].kind;
+            double values[2] = {
+                (scans[i].hits.mask & (1u << kind)) ? 1.0 : 0.0,
+                scans[i].hits.index[kind]
+            };
+            unsigned int key = indicator_cache_key(CHART_PATTERNS[p].indicator, series, 0);
+            indicator_cache_put(&pair->indicator_cache, key, scans[i].hits.version, values, 2);
+        }
+    }
+    
+    unsigned int cross_bits = (1u << PATTERN_GOLDEN_CROSS) | (1u << PATTERN_DEATH_CROSS);
+    for (int s = 0; s < SERIES_COUNT; s++) {
+        pair->patterns[s].mask &= ~cross_bits;
+        pair->patterns[s].index[PATTERN_GOLDEN_CROSS] = -1;
+        pair->patterns[s].index[PATTERN_DEATH_CROSS] = -1;
+    }
+    
+    SeriesId cross_series = ema_cross_series(pair, 200);
+    int ema_cross = detect_ema_cross(pair, 50, 200);
+    if (cross_series != SERIES_COUNT && ema_cross != 0) {
+        PatternKind kind = (ema_cross == 1) ? PATTERN_GOLDEN_CROSS : PATTERN_DEATH_CROSS;
+        int count = 0;
+        portfolio_series_data(pair, cross_series, &count);
+        pair->patterns[cross_series].mask |= 1u << kind;
+        pair->patterns[cross_series].index[kind] = count - 1;
+    }
+}
+
+
+const char* pattern_kind_name(PatternKind kind) {
+    switch (kind) {
+        case PATTERN_DOUBLE_BOTTOM: return "Double Bottom";
+        case PATTERN_DOUBLE_TOP: return "Double Top";
+        case PATTERN_INV_HEAD_SHOULDERS: return "Inv H&S";
+        case PATTERN_HEAD_SHOULDERS: return "H&S";
+        case PATTERN_GOLDEN_CROSS: return "Golden Cross";
+        case PATTERN_DEATH_CROSS: return "Death Cross";
+        default: return "?";
+    }
+}
+
+
+/* Lists each pattern once with the timeframes it was found on, e.g.
+ * "Double Bottom (1h, 4h), Golden Cross (1h)". Returns how many patterns
+ * were listed; the buffer holds "None" when there are none. */
+int format_pattern_hits(const TradingPair *pair, char *buffer, size_t size) {
+    if (!buffer || size == 0) return 0;
+    
+    buffer[0] = '\0';
+    int listed = 0;
+    size_t used = 0;
+    
+    for (int kind = 0; pair && kind < PATTERN_KIND_COUNT; kind++) {
+        size_t start = used;
+        int found = 0;
+        
+        for (int s = 0; s < SERIES_COUNT; s++) {
+            if (!(pair->patterns[s].mask & (1u << kind))) continue;
+            
+            const char *series_name = portfolio_series_name((SeriesId)s);
+            int written;
+            if (found == 0) {
+                written = snprintf(buffer + used, size - used, "%s%s (%s",
+                                   listed > 0 ? ", " : "", pattern_kind_name((PatternKind)kind), series_name);
+            } else {
+                written = snprintf(buffer + used, size - used, ", %s", series_name);
+            }
+            if (written < 0 || (size_t)written >= size - used) {
+                buffer[start] = '\0';
+                return listed;
+            }
+            used += written;
+            found++;
+        }
+        
+        if (found > 0) {
+            if (used + 1 >= size) {
+                buffer[start] = '\0';
+                return listed;
+            }
+            buffer[used++] = ')';
+            buffer[used] = '\0';
+            listed++;
+        }
+    }
+    
+    if (listed == 0) {
+        snprintf(buffer, size, "None");
+    }
+    return listed;
+}
+
+
 void update_all_indicators(TradingPair *pair) {
     if (!pair) {
         return;
     }
     
     
-    const double *prices = pair->historical_1h_loaded ? pair->historical_1h : pair->historical_prices;
-    int count = pair->historical_1h_loaded ? pair->historical_1h_count : pair->historical_count;
+    SeriesId series = pattern_series(pair);
+    int count = 0;
+    const double *prices = portfolio_series_data(pair, series, &count);
     
     if (count > 0) {
-        pair->ema_12 = calculate_ema(prices, count, 12);
-        pair->ema_26 = calculate_ema(prices, count, 26);
-        pair->ema_50 = calculate_ema(prices, count, 50);
-        pair->ema_200 = calculate_ema(prices, count, 200);
+        static const int PAIR_EMA_PERIODS[4] = { 12, 26, 50, 200 };
+        double emas[4];
+        cached_emas(pair, series, prices, count, PAIR_EMA_PERIODS, 4, emas);
+        pair->ema_12 = emas[0];
+        pair->ema_26 = emas[1];
+        pair->ema_50 = emas[2];
+        pair->ema_200 = emas[3];
     }
     
     
-    calculate_macd(pair, &pair->macd, &pair->macd_signal, NULL);
+    double macd_histogram;
+    calculate_macd(pair, &pair->macd, &pair->macd_signal, &macd_histogram);
     
     
     calculate_bollinger_bands(pair, &pair->bb_upper, &pair->bb_middle, &pair->bb_lower);
     
     
+    scan_all_patterns(pair);
     pair->profit_probability = calculate_profit_probability(pair);
     
     
-    pair->detected_patterns[0] = '\0';
-    pair->pattern_count = 0;
-    
-    int pattern_idx;
-    if (detect_double_bottom(prices, count, &pattern_idx)) {
-        if (pair->pattern_count > 0) strcat(pair->detected_patterns, ", ");
-        strcat(pair->detected_patterns, "Double Bottom");
-        pair->pattern_count++;
-    }
-    if (detect_double_top(prices, count, &pattern_idx)) {
-        if (pair->pattern_count > 0) strcat(pair->detected_patterns, ", ");
-        strcat(pair->detected_patterns, "Double Top");
-        pair->pattern_count++;
-    }
-    if (detect_inverse_head_shoulders(prices, count, &pattern_idx)) {
-        if (pair->pattern_count > 0) strcat(pair->detected_patterns, ", ");
-        strcat(pair->detected_patterns, "Inv H&amp;S");  
-        pair->pattern_count++;
-    }
-    if (detect_head_shoulders(prices, count, &pattern_idx)) {
-        if (pair->pattern_count > 0) strcat(pair->detected_patterns, ", ");
-        strcat(pair->detected_patterns, "H&amp;S");  
-        pair->pattern_count++;
-    }
-    
-    int ema_cross = detect_ema_cross(pair, 50, 200);
-    if (ema_cross == 1) {
-        if (pair->pattern_count > 0) strcat(pair->detected_patterns, ", ");
-        strcat(pair->detected_patterns, "Golden Cross");
-        pair->pattern_count++;
-    } else if (ema_cross == -1) {
-        if (pair->pattern_count > 0) strcat(pair->detected_patterns, ", ");
-        strcat(pair->detected_patterns, "Death Cross");
-        pair->pattern_count++;
-    }
-    
-    if (pair->pattern_count == 0) {
-        strcpy(pair->detected_patterns, "None");
-    }
-    
-    
     analyze_scalping_signals(pair);
 }
 
 
 
 
-void analyze_scalping_signals(TradingPair *pair) {
-    if (!pair) return;
-    
+/* Reads everything from the scalp streams, whose forming candle tracks the
+ * latest price, so a tick re-evaluates without touching the close arrays.
+ * Sets the scalp fields without logging and returns the 5m RSI. */
+double evaluate_scalping_signals(TradingPair *pair) {
+    if (!pair) return 50.0;
     
     pair->scalp_trend = 0.0;
     pair->scalp_momentum = 0.0;
-    strcpy(pair->scalp_signal, "WAIT");
+    pair->scalp_signal = SCALP_WAIT;
     
     
-    if (!pair->historical_5m_loaded || pair->historical_5m_count < 20) {
-        return;
+    const ScalpStream *fast = &pair->scalp_5m;
+    if (scalp_stream_count(fast) < 20) {
+        return 50.0;
     }
     
-    const double *prices_5m = pair->historical_5m;
-    int count_5m = pair->historical_5m_count;
-    
     
-    double ema_5 = calculate_ema(prices_5m, count_5m, 5);   
-    double ema_10 = calculate_ema(prices_5m, count_5m, 10); 
-    double ema_20 = calculate_ema(prices_5m, count_5m, 20); 
-    double ema_50 = calculate_ema(prices_5m, count_5m, 50); 
+    double ema_5 = scalp_stream_ema(fast, 0);
+    double ema_10 = scalp_stream_ema(fast, 1);
+    double ema_20 = scalp_stream_ema(fast, 2);
+    double ema_50 = scalp_stream_ema(fast, 3);
     
     
     double trend_score = 0.0;
@@ -643,40 +674,35 @@ void analyze_scalping_signals(TradingPair *pair) {
     pair->scalp_trend = (trend_score >= 0.5) ? 1.0 : (trend_score <= 0.25) ? -1.0 : 0.0;
     
     
-    if (count_5m >= 10) {
-        double sum_changes = 0.0;
-        int momentum_period = 10;
-        for (int i = count_5m - momentum_period; i < count_5m - 1; i++) {
-            if (i >= 0) {
-                sum_changes += prices_5m[i + 1] - prices_5m[i];
-            }
-        }
-        pair->scalp_momentum = sum_changes / (prices_5m[count_5m - 1] * momentum_period) * 100.0;
+    /* Summed moves over the last momentum period telescope to one difference. */
+    int momentum_period = SCALP_MOMENTUM_PERIOD;
+    double latest = scalp_stream_close(fast, 0);
+    if (latest > 0) {
+        double change = latest - scalp_stream_close(fast, momentum_period - 1);
+        pair->scalp_momentum = change / (latest * momentum_period) * 100.0;
     }
     
     
-    double scalp_rsi = 50.0;
-    if (count_5m >= 14) {
-        double gains = 0.0, losses = 0.0;
-        for (int i = count_5m - 14; i < count_5m - 1; i++) {
-            if (i >= 0) {
-                double change = prices_5m[i + 1] - prices_5m[i];
-                if (change > 0) gains += change;
-                else losses += fabs(change);
-            }
-        }
-        double avg_gain = gains / 14.0;
-        double avg_loss = losses / 14.0;
-        if (avg_loss > 0) {
-            scalp_rsi = 100.0 - (100.0 / (1.0 + (avg_gain / avg_loss)));
-        }
+    double scalp_rsi = scalp_stream_rsi(fast, 14);
+    
+    
+    /* Momentum is the mean per-candle move in percent; scale the
+     * thresholds by the 5m ATR so they fit the current volatility. */
+    const ScalpParams *params = &pair->scalp_params;
+    double atr_percent = 0.1;
+    const OhlcValues *ohlc_5m = portfolio_series_ohlc(pair, SERIES_5M);
+    if (ohlc_5m && ohlc_5m->atr_ready && pair->current_price > 0) {
+        atr_percent = ohlc_5m->atr / pair->current_price * 100.0;
     }
+    double weak_move = params->weak_move * atr_percent;
+    double strong_move = params->strong_move * atr_percent;
+    double flat_move = params->flat_move * atr_percent;
     
     
     bool confirmed_15m = false;
-    if (pair->historical_15m_loaded && pair->historical_15m_count >= 20) {
-        double ema_15m_fast = calculate_ema(pair->historical_15m, pair->historical_15m_count, 10);
-        double ema_15m_slow = calculate_ema(pair->historical_15m, pair->historical_15m_count, 20);
+    if (scalp_stream_count(&pair->scalp_15m) >= 20) {
+        double ema_15m_fast = scalp_stream_ema(&pair->scalp_15m, 0);
+        double ema_15m_slow = scalp_stream_ema(&pair->scalp_15m, 1);
         
         if (pair->scalp_trend > 0 && ema_15m_fast > ema_15m_slow) {
             confirmed_15m = true;
@@ -686,38 +712,69 @@ void analyze_scalping_signals(TradingPair *pair) {
     }
     
     
-    if (pair->scalp_trend > 0 && scalp_rsi < 70 && pair->scalp_momentum > 0.005) {
+    if (pair->scalp_trend > 0 && scalp_rsi < params->rsi_overbought && pair->scalp_momentum > weak_move) {
         
-        if (confirmed_15m || pair->scalp_momentum > 0.015) {
-            strcpy(pair->scalp_signal, "BUY NOW");
+        if (confirmed_15m || pair->scalp_momentum > strong_move) {
+            pair->scalp_signal = SCALP_BUY_NOW;
         } else {
-            strcpy(pair->scalp_signal, "BUY SIGNAL");
+            pair->scalp_signal = SCALP_BUY_SIGNAL;
         }
-    } else if (pair->scalp_trend < 0 && scalp_rsi > 30 && pair->scalp_momentum < -0.005) {
+    } else if (pair->scalp_trend < 0 && scalp_rsi > params->rsi_oversold && pair->scalp_momentum < -weak_move) {
         
-        if (confirmed_15m || pair->scalp_momentum < -0.015) {
-            strcpy(pair->scalp_signal, "SELL NOW");
+        if (confirmed_15m || pair->scalp_momentum < -strong_move) {
+            pair->scalp_signal = SCALP_SELL_NOW;
         } else {
-            strcpy(pair->scalp_signal, "SELL SIGNAL");
+            pair->scalp_signal = SCALP_SELL_SIGNAL;
         }
-    } else if (pair->scalp_trend > 0 && scalp_rsi < 40) {
-        strcpy(pair->scalp_signal, "OVERSOLD - BUY DIP");
-    } else if (pair->scalp_trend < 0 && scalp_rsi > 60) {
-        strcpy(pair->scalp_signal, "OVERBOUGHT - SELL BOUNCE");
-    } else if (fabs(pair->scalp_momentum) < 0.003) {
+    } else if (pair->scalp_trend > 0 && scalp_rsi < params->rsi_dip) {
+        pair->scalp_signal = SCALP_BUY_DIP;
+    } else if (pair->scalp_trend < 0 && scalp_rsi > params->rsi_bounce) {
+        pair->scalp_signal = SCALP_SELL_BOUNCE;
+    } else if (fabs(pair->scalp_momentum) < flat_move) {
         
-        strcpy(pair->scalp_signal, "RANGING - WAIT");
+        pair->scalp_signal = SCALP_RANGING;
     } else {
-        strcpy(pair->scalp_signal, "HOLD POSITION");
+        pair->scalp_signal = SCALP_HOLD;
     }
     
-    
+    return scalp_rsi;
+}
+
+
+static void print_scalping_signal(const TradingPair *pair, double scalp_rsi) {
     printf("Scalp: %s | Trend: %.2f | Mom: %.2f%% | RSI: %.1f | Signal: %s\n",
-           pair->symbol, pair->scalp_trend, pair->scalp_momentum * 100, scalp_rsi, pair->scalp_signal);
+           pair->symbol, pair->scalp_trend, pair->scalp_momentum * 100, scalp_rsi,
+           scalp_signal_text(pair->scalp_signal));
     fflush(stdout);
 }
 
 
+void analyze_scalping_signals(TradingPair *pair) {
+    if (!pair) return;
+    
+    double scalp_rsi = evaluate_scalping_signals(pair);
+    print_scalping_signal(pair, scalp_rsi);
+}
+
+
+/* Moves the forming 5m and 15m candles to price, rolling them over once
+ * now_ms passes their end, and re-evaluates the signal. Logs only on a
+ * change; returns true when the signal changed. */
+bool analyze_scalping_tick(TradingPair *pair, double price, long long now_ms) {
+    if (!pair || price <= 0) return false;
+    
+    scalp_stream_tick(&pair->scalp_5m, price, now_ms);
+    scalp_stream_tick(&pair->scalp_15m, price, now_ms);
+    
+    ScalpSignal previous = pair->scalp_signal;
+    double scalp_rsi = evaluate_scalping_signals(pair);
+    if (pair->scalp_signal == previous) return false;
+    
+    print_scalping_signal(pair, scalp_rsi);
+    return true;
+}
+
+
 int get_scalping_trend(const TradingPair *pair) {
     if (!pair) return 0;
     return (int)pair->scalp_trend;
@@ -732,17 +789,46 @@ double get_scalping_momentum(const TradingPair *pair) {
 
 const char* get_scalping_signal(const TradingPair *pair) {
     if (!pair) return "NO DATA";
-    return pair->scalp_signal;
+    return scalp_signal_text(pair->scalp_signal);
+}
+
+
+void scalp_params_default(ScalpParams *params) {
+    if (!params) return;
+    
+    params->weak_move = 0.05;
+    params->strong_move = 0.15;
+    params->flat_move = 0.03;
+    params->rsi_overbought = 70.0;
+    params->rsi_oversold = 30.0;
+    params->rsi_dip = 40.0;
+    params->rsi_bounce = 60.0;
+}
+
+
+const char* scalp_signal_text(ScalpSignal signal) {
+    switch (signal) {
+        case SCALP_WAIT: return "WAIT";
+        case SCALP_BUY_NOW: return "BUY NOW";
+        case SCALP_BUY_SIGNAL: return "BUY SIGNAL";
+        case SCALP_SELL_NOW: return "SELL NOW";
+        case SCALP_SELL_SIGNAL: return "SELL SIGNAL";
+        case SCALP_BUY_DIP: return "OVERSOLD - BUY DIP";
+        case SCALP_SELL_BOUNCE: return "OVERBOUGHT - SELL BOUNCE";
+        case SCALP_RANGING: return "RANGING - WAIT";
+        case SCALP_HOLD: return "HOLD POSITION";
+    }
+    return "UNKNOWN";
 }
 
 
 bool is_scalp_buy_signal(const TradingPair *pair) {
     if (!pair) return false;
-    return (strstr(pair->scalp_signal, "BUY") != NULL);
+    return (pair->scalp_signal & SCALP_SIDE_BUY) != 0;
 }
 
 
 bool is_scalp_sell_signal(const TradingPair *pair) {
     if (!pair) return false;
-    return (strstr(pair->scalp_signal, "SELL") != NULL);
+    return (pair->scalp_signal & SCALP_SIDE_SELL) != 0;
 }
@@ -0,0 +1,116 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/equity_series.h"
+#include <string.h>
+
+
+void equity_series_init(EquitySeries *series) {
+    if (!series) return;
+    
+    memset(series, 0, sizeof(*series));
+    long long span = EQUITY_BASE_MS;
+    for (int level = 0; level < EQUITY_LEVELS; level++) {
+        series->levels[level].span_ms = span;
+        span *= EQUITY_LEVEL_FACTOR;
+    }
+}
+
+
+void equity_series_push(EquitySeries *series, long long time_ms, double equity) {
+    if (!series) return;
+    
+    for (int level = 0; level < EQUITY_LEVELS; level++) {
+        EquityLevel *ring = &series->levels[level];
+        long long bucket = time_ms - time_ms % ring->span_ms;
+        
+        if (ring->count > 0) {
+            EquitySample *newest = &ring->points[(ring->head + ring->count - 1) % EQUITY_POINTS];
+            if (newest->time_ms >= bucket) {
+                newest->close = equity;
+                if (equity < newest->low) newest->low = equity;
+                continue;
+            }
+        }
+        
+        EquitySample *slot;
+        if (ring->count < EQUITY_POINTS) {
+            slot = &ring->points[(ring->head + ring->count) % EQUITY_POINTS];
+            ring->count++;
+        } else {
+            slot = &ring->points[ring->head];
+            ring->head = (ring->head + 1) % EQUITY_POINTS;
+        }
+        slot->time_ms = bucket;
+        slot->close = equity;
+        slot->low = equity;
+    }
+}
+
+
+int equity_series_count(const EquitySeries *series, int level) {
+    if (!series || level < 0 || level >= EQUITY_LEVELS) return 0;
+    return series->levels[level].count;
+}
+
+
+/* index 0 is the oldest point held at level. */
+const EquitySample* equity_series_point(const EquitySeries *series, int level, int index) {
+    if (!series || level < 0 || level >= EQUITY_LEVELS) return NULL;
+    
+    const EquityLevel *ring = &series->levels[level];
+    if (index < 0 || index >= ring->count) return NULL;
+    return &ring->points[(ring->head + index) % EQUITY_POINTS];
+}
+
+
+/* Finest level that still reaches back to from_ms, or the coarsest. */
+int equity_series_level_for(const EquitySeries *series, long long from_ms) {
+    if (!series) return 0;
+    
+    for (int level = 0; level < EQUITY_LEVELS; level++) {
+        const EquityLevel *ring = &series->levels[level];
+        if (ring->count > 0 && ring->points[ring->head].time_ms <= from_ms) return level;
+    }
+    return EQUITY_LEVELS - 1;
+}
+
+
+/* Copies the points from from_ms on at the finest level covering them.
+ * Returns how many were copied, at most max_points of the newest. */
+int equity_series_window(const EquitySeries *series, long long from_ms, EquitySample *out, int max_points) {
+    if (!series || !out || max_points <= 0) return 0;
+    
+    int level = equity_series_level_for(series, from_ms);
+    const EquityLevel *ring = &series->levels[level];
+    
+    int first = 0;
+    while (first < ring->count) {
+        const EquitySample *point = &ring->points[(ring->head + first) % EQUITY_POINTS];
+        if (point->time_ms + ring->span_ms > from_ms) break;
+        first++;
+    }
+    if (ring->count - first > max_points) first = ring->count - max_points;
+    
+    int copied = 0;
+    for (int i = first; i < ring->count; i++) {
+        out[copied++] = ring->points[(ring->head + i) % EQUITY_POINTS];
+    }
+    return copied;
+}
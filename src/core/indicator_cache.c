@@ -0,0 +1,94 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/indicator_cache.h"
+#include <string.h>
+
+
+unsigned int indicator_cache_key(IndicatorKind kind, int series, int param) {
+    return ((unsigned int)(kind + 1) << 24) |
+           ((unsigned int)(series & 0xFF) << 16) |
+           ((unsigned int)param & 0xFFFF);
+}
+
+
+static unsigned int slot_for_key(unsigned int key) {
+    unsigned int h = key * 2654435761u;
+    return (h >> 16) % INDICATOR_CACHE_SLOTS;
+}
+
+
+bool indicator_cache_get(IndicatorCache *cache, unsigned int key, unsigned int version,
+                         double *values, int count) {
+    if (!cache || key == 0) return false;
+    
+    if (count > INDICATOR_CACHE_VALUES) count = INDICATOR_CACHE_VALUES;
+    
+    unsigned int slot = slot_for_key(key);
+    for (int probe = 0; probe < INDICATOR_CACHE_SLOTS; probe++) {
+        const IndicatorCacheEntry *entry = &cache->entries[slot];
+        if (entry->key == 0) break;
+        
+        if (entry->key == key) {
+            if (entry->version != version) break;
+            
+            if (values && count > 0) {
+                memcpy(values, entry->values, count * sizeof(double));
+            }
+            cache->hits++;
+            return true;
+        }
+        slot = (slot + 1) % INDICATOR_CACHE_SLOTS;
+    }
+    
+    cache->misses++;
+    return false;
+}
+
+
+void indicator_cache_put(IndicatorCache *cache, unsigned int key, unsigned int version,
+                         const double *values, int count) {
+    if (!cache || key == 0 || !values) return;
+    
+    if (count > INDICATOR_CACHE_VALUES) count = INDICATOR_CACHE_VALUES;
+    
+    unsigned int home = slot_for_key(key);
+    unsigned int slot = home;
+    IndicatorCacheEntry *target = &cache->entries[home];
+    
+    for (int probe = 0; probe < INDICATOR_CACHE_SLOTS; probe++) {
+        IndicatorCacheEntry *entry = &cache->entries[slot];
+        if (entry->key == 0 || entry->key == key) {
+            target = entry;
+            break;
+        }
+        slot = (slot + 1) % INDICATOR_CACHE_SLOTS;
+    }
+    
+    target->key = key;
+    target->version = version;
+    memset(target->values, 0, sizeof(target->values));
+    memcpy(target->values, values, count * sizeof(double));
+}
+
+
+void indicator_cache_clear(IndicatorCache *cache) {
+    if (!cache) return;
+    memset(cache, 0, sizeof(*cache));
+}
@@ -231,25 +231,28 @@ static void timeframe_fetch_callback(SoupSession *session, SoupMessage *msg, gpo
         array_len = max_len;
     }
     
-    double *prices = malloc(array_len * sizeof(double));
+    Candle *candles = malloc(array_len * sizeof(Candle));
     int count = 0;
     
     for (int i = 0; i < array_len; i++) {
-        struct json_object *candle = json_object_array_get_idx(root, i);
-        if (json_object_get_type(candle) == json_type_array) {
-            struct json_object *close_price_obj = json_object_array_get_idx(candle, 4);
-            if (close_price_obj) {
-                const char *close_str = json_object_get_string(close_price_obj);
-                prices[count++] = atof(close_str);
-            }
+        struct json_object *kline = json_object_array_get_idx(root, i);
+        if (json_object_get_type(kline) == json_type_array &&
+            json_object_array_length(kline) >= 6) {
+            Candle *candle = &candles[count++];
+            candle->open_time = json_object_get_int64(json_object_array_get_idx(kline, 0));
+            candle->open = atof(json_object_get_string(json_object_array_get_idx(kline, 1)));
+            candle->high = atof(json_object_get_string(json_object_array_get_idx(kline, 2)));
+            candle->low = atof(json_object_get_string(json_object_array_get_idx(kline, 3)));
+            candle->close = atof(json_object_get_string(json_object_array_get_idx(kline, 4)));
+            candle->volume = atof(json_object_get_string(json_object_array_get_idx(kline, 5)));
         }
     }
     
     if (count > 0 && data->callback) {
-        data->callback(data->pair_index, data->interval, prices, count, data->user_data);
+        data->callback(data->pair_index, data->interval, candles, count, data->user_data);
     }
     
-    free(prices);
+    free(candles);
     json_object_put(root);
     free(data);
 }
@@ -0,0 +1,277 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/ohlc_stream.h"
+#include <math.h>
+#include <string.h>
+
+#define MS_PER_DAY 86400000LL
+
+
+static int clamp_period(int period, int fallback) {
+    if (period <= 0) period = fallback;
+    if (period > OHLC_MAX_WINDOW) period = OHLC_MAX_WINDOW;
+    return period;
+}
+
+
+void ohlc_stream_init(OhlcStream *stream, int atr_period, int stoch_period, int stoch_smooth,
+                      int adx_period, int keltner_period, double keltner_mult) {
+    if (!stream) return;
+    
+    memset(stream, 0, sizeof(*stream));
+    stream->atr_period = clamp_period(atr_period, 14);
+    stream->stoch_period = clamp_period(stoch_period, 14);
+    stream->stoch_smooth = clamp_period(stoch_smooth, 3);
+    stream->adx_period = clamp_period(adx_period, 14);
+    stream->keltner_period = (keltner_period > 0) ? keltner_period : 20;
+    stream->keltner_mult = (keltner_mult > 0) ? keltner_mult : 2.0;
+}
+
+
+void ohlc_stream_reset(OhlcStream *stream) {
+    if (!stream) return;
+    
+    if (stream->atr_period == 0) {
+        ohlc_stream_init(stream, 0, 0, 0, 0, 0, 0.0);
+        return;
+    }
+    
+    ohlc_stream_init(stream, stream->atr_period, stream->stoch_period, stream->stoch_smooth,
+                     stream->adx_period, stream->keltner_period, stream->keltner_mult);
+}
+
+
+static void deque_push(OhlcDeque *deque, int index, double value, bool keep_max, int window) {
+    while (deque->count > 0) {
+        const OhlcDequeEntry *back = &deque->entries[(deque->head + deque->count - 1) % OHLC_MAX_WINDOW];
+        if (keep_max ? (back->value > value) : (back->value < value)) break;
+        deque->count--;
+    }
+    
+    while (deque->count > 0 && deque->entries[deque->head].index <= index - window) {
+        deque->head = (deque->head + 1) % OHLC_MAX_WINDOW;
+        deque->count--;
+    }
+    
+    OhlcDequeEntry *slot = &deque->entries[(deque->head + deque->count) % OHLC_MAX_WINDOW];
+    slot->index = index;
+    slot->value = value;
+    deque->count++;
+}
+
+
+static double deque_front(const OhlcDeque *deque) {
+    return deque->entries[deque->head].value;
+}
+
+
+void ohlc_stream_push(OhlcStream *stream, const Candle *candle) {
+    if (!stream || !candle) return;
+    
+    if (stream->atr_period == 0) {
+        ohlc_stream_init(stream, 0, 0, 0, 0, 0, 0.0);
+    }
+    
+    int index = (int)stream->samples;
+    bool first = (stream->samples == 0);
+    stream->samples++;
+    
+    double high = candle->high;
+    double low = candle->low;
+    double close = candle->close;
+    
+    double tr = high - low;
+    if (!first) {
+        double up = fabs(high - stream->prev_close);
+        double down = fabs(low - stream->prev_close);
+        if (up > tr) tr = up;
+        if (down > tr) tr = down;
+    }
+    
+    int atr_period = stream->atr_period;
+    if (stream->samples <= atr_period) {
+        stream->tr_sum += tr;
+        if (stream->samples == atr_period) {
+            stream->atr = stream->tr_sum / atr_period;
+        }
+    } else {
+        stream->atr = (stream->atr * (atr_period - 1) + tr) / atr_period;
+    }
+    
+    long long day = candle->open_time / MS_PER_DAY;
+    if (first || day != stream->session_day) {
+        stream->session_day = day;
+        stream->session_pv = 0.0;
+        stream->session_volume = 0.0;
+    }
+    stream->session_pv += (high + low + close) / 3.0 * candle->volume;
+    stream->session_volume += candle->volume;
+    
+    deque_push(&stream->highs, index, high, true, stream->stoch_period);
+    deque_push(&stream->lows, index, low, false, stream->stoch_period);
+    if (stream->samples >= stream->stoch_period) {
+        double highest = deque_front(&stream->highs);
+        double lowest = deque_front(&stream->lows);
+        double k = (highest > lowest) ? 100.0 * (close - lowest) / (highest - lowest) : 50.0;
+        
+        int slot = (int)(stream->k_count % stream->stoch_smooth);
+        if (stream->k_count >= stream->stoch_smooth) {
+            stream->k_sum -= stream->k_ring[slot];
+        }
+        stream->k_ring[slot] = k;
+        stream->k_sum += k;
+        stream->k_count++;
+    }
+    
+    if (!first) {
+        int period = stream->adx_period;
+        long deltas = stream->samples - 1;
+        double up_move = high - stream->prev_high;
+        double down_move = stream->prev_low - low;
+        double plus_dm = (up_move > down_move && up_move > 0) ? up_move : 0.0;
+        double minus_dm = (down_move > up_move && down_move > 0) ? down_move : 0.0;
+        
+        if (deltas <= period) {
+            stream->tr_smooth += tr;
+            stream->plus_dm_smooth += plus_dm;
+            stream->minus_dm_smooth += minus_dm;
+        } else {
+            stream->tr_smooth += tr - stream->tr_smooth / period;
+            stream->plus_dm_smooth += plus_dm - stream->plus_dm_smooth / period;
+            stream->minus_dm_smooth += minus_dm - stream->minus_dm_smooth / period;
+        }
+        
+        if (deltas >= period && stream->tr_smooth > 0) {
+            double plus_di = 100.0 * stream->plus_dm_smooth / stream->tr_smooth;
+            double minus_di = 100.0 * stream->minus_dm_smooth / stream->tr_smooth;
+            double di_sum = plus_di + minus_di;
+            double dx = (di_sum > 0) ? 100.0 * fabs(plus_di - minus_di) / di_sum : 0.0;
+            
+            stream->dx_count++;
+            if (stream->dx_count <= period) {
+                stream->dx_sum += dx;
+                if (stream->dx_count == period) {
+                    stream->adx = stream->dx_sum / period;
+                }
+            } else {
+                stream->adx = (stream->adx * (period - 1) + dx) / period;
+            }
+        }
+        
+        if (close > stream->prev_close) {
+            stream->obv += candle->volume;
+        } else if (close < stream->prev_close) {
+            stream->obv -= candle->volume;
+        }
+    }
+    
+    int keltner_period = stream->keltner_period;
+    if (stream->samples <= keltner_period) {
+        stream->ema_sum += close;
+        if (stream->samples == keltner_period) {
+            stream->ema = stream->ema_sum / keltner_period;
+        }
+    } else {
+        stream->ema += (close - stream->ema) * (2.0 / (keltner_period + 1.0));
+    }
+    
+    stream->prev_close = close;
+    stream->prev_high = high;
+    stream->prev_low = low;
+}
+
+
+void ohlc_stream_backfill(OhlcStream *stream, const Candle *candles, int count) {
+    if (!stream) return;
+    
+    ohlc_stream_reset(stream);
+    if (!candles) return;
+    
+    for (int i = 0; i < count; i++) {
+        ohlc_stream_push(stream, &candles[i]);
+    }
+}
+
+
+void ohlc_stream_values(const OhlcStream *stream, OhlcValues *values) {
+    if (!values) return;
+    
+    memset(values, 0, sizeof(*values));
+    if (!stream || stream->samples == 0) return;
+    
+    values->atr_ready = stream->samples >= stream->atr_period;
+    values->atr = values->atr_ready ? stream->atr : 0.0;
+    
+    values->vwap = (stream->session_volume > 0) ? stream->session_pv / stream->session_volume
+                                                : stream->prev_close;
+    
+    values->stoch_ready = stream->k_count >= stream->stoch_smooth;
+    if (stream->k_count > 0) {
+        int last = (int)((stream->k_count - 1) % stream->stoch_smooth);
+        values->stoch_k = stream->k_ring[last];
+        values->stoch_d = values->stoch_ready ? stream->k_sum / stream->stoch_smooth : values->stoch_k;
+    } else {
+        values->stoch_k = 50.0;
+        values->stoch_d = 50.0;
+    }
+    
+    if (stream->dx_count > 0 && stream->tr_smooth > 0) {
+        values->plus_di = 100.0 * stream->plus_dm_smooth / stream->tr_smooth;
+        values->minus_di = 100.0 * stream->minus_dm_smooth / stream->tr_smooth;
+    }
+    values->adx_ready = stream->dx_count >= stream->adx_period;
+    values->adx = values->adx_ready ? stream->adx : 0.0;
+    
+    values->obv = stream->obv;
+    
+    values->keltner_ready = values->atr_ready && stream->samples >= stream->keltner_period;
+    if (values->keltner_ready) {
+        values->keltner_middle = stream->ema;
+        values->keltner_upper = stream->ema + stream->keltner_mult * stream->atr;
+        values->keltner_lower = stream->ema - stream->keltner_mult * stream->atr;
+    }
+}
+
+
+/* Values as if forming had closed, leaving the committed state alone. */
+void ohlc_stream_peek(const OhlcStream *stream, const Candle *forming, OhlcValues *values) {
+    if (!stream || !forming) {
+        ohlc_stream_values(stream, values);
+        return;
+    }
+    
+    OhlcStream scratch = *stream;
+    ohlc_stream_push(&scratch, forming);
+    ohlc_stream_values(&scratch, values);
+}
+
+
+int ohlc_compute_series(const Candle *candles, int count, OhlcValues *values) {
+    if (!candles || !values || count <= 0) return 0;
+    
+    OhlcStream stream;
+    ohlc_stream_init(&stream, 0, 0, 0, 0, 0, 0.0);
+    
+    for (int i = 0; i < count; i++) {
+        ohlc_stream_push(&stream, &candles[i]);
+        ohlc_stream_values(&stream, &values[i]);
+    }
+    return count;
+}
@@ -0,0 +1,184 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/optimizer.h"
+#include <math.h>
+#include <stdlib.h>
+
+
+void optimizer_default_options(OptimizerOptions *options, OptimizerObjective objective) {
+    if (!options) return;
+    
+    options->objective = objective;
+    options->risk_aversion = 2.0;
+    options->max_iterations = 100000;
+    options->tolerance = 1e-7;
+}
+
+
+static void mat_vec(const double *matrix, const double *x, int n, double *out) {
+    for (int i = 0; i < n; i++) {
+        const double *row = matrix + (size_t)i * n;
+        double sum = 0.0;
+        for (int j = 0; j < n; j++) {
+            sum += row[j] * x[j];
+        }
+        out[i] = sum;
+    }
+}
+
+
+/* Sequential minimal optimization on the simplex: each step moves weight
+ * from the held asset with the largest gradient to the asset with the
+ * smallest, by the exact line minimum, and patches the gradient with two
+ * columns. A step is O(n); the loop ends when the two gradients agree to
+ * within tolerance of the gradient scale, which is the KKT condition. */
+static int solve_quadratic(const double *covariance, const double *expected_returns, int n,
+                           const OptimizerOptions *options, double *weights) {
+    double *gradient = malloc((size_t)n * sizeof(double));
+    if (!gradient) return -1;
+    
+    bool mean_variance = (options->objective == OPTIMIZER_MEAN_VARIANCE && expected_returns);
+    double scale = mean_variance ? options->risk_aversion : 1.0;
+    if (scale <= 0) scale = 1.0;
+    
+    for (int i = 0; i < n; i++) {
+        weights[i] = 1.0 / n;
+    }
+    mat_vec(covariance, weights, n, gradient);
+    
+    double magnitude = 0.0;
+    for (int i = 0; i < n; i++) {
+        gradient[i] = scale * gradient[i] - (mean_variance ? expected_returns[i] : 0.0);
+        if (fabs(gradient[i]) > magnitude) magnitude = fabs(gradient[i]);
+    }
+    double threshold = options->tolerance * (magnitude > 0 ? magnitude : 1.0);
+    
+    int iteration = 0;
+    while (iteration < options->max_iterations) {
+        int from = -1, to = 0;
+        for (int i = 0; i < n; i++) {
+            if (weights[i] > 0 && (from < 0 || gradient[i] > gradient[from])) from = i;
+            if (gradient[i] < gradient[to]) to = i;
+        }
+        
+        double gap = gradient[from] - gradient[to];
+        if (from == to || gap <= threshold) break;
+        iteration++;
+        
+        const double *row_from = covariance + (size_t)from * n;
+        const double *row_to = covariance + (size_t)to * n;
+        double curvature = scale * (row_from[from] + row_to[to] - 2.0 * row_from[to]);
+        double step = (curvature > 0) ? gap / curvature : weights[from];
+        if (step > weights[from]) step = weights[from];
+        
+        weights[from] -= step;
+        weights[to] += step;
+        if (weights[from] < 1e-15) weights[from] = 0.0;
+        
+        /* S is symmetric, so rows stand in for columns. */
+        double factor = scale * step;
+        for (int i = 0; i < n; i++) {
+            gradient[i] += factor * (row_to[i] - row_from[i]);
+        }
+    }
+    
+    free(gradient);
+    return iteration;
+}
+
+
+/* Minimizes 0.5 y'Sy - sum(log y) / n over y > 0; w = y / sum(y) then
+ * has equal risk contributions. Each coordinate has a closed-form
+ * minimizer and Sy is kept current with one column update. */
+static int solve_risk_parity(const double *covariance, int n, const OptimizerOptions *options,
+                             double *weights) {
+    for (int i = 0; i < n; i++) {
+        if (covariance[(size_t)i * n + i] <= 0) return -1;
+    }
+    
+    double *sy = malloc((size_t)n * sizeof(double));
+    if (!sy) return -1;
+    
+    double budget = 1.0 / n;
+    for (int i = 0; i < n; i++) {
+        weights[i] = 1.0 / sqrt(covariance[(size_t)i * n + i]) / n;
+    }
+    mat_vec(covariance, weights, n, sy);
+    
+    int iteration = 0;
+    while (iteration < options->max_iterations) {
+        iteration++;
+        
+        double change = 0.0;
+        for (int i = 0; i < n; i++) {
+            /* S is symmetric, so row i doubles as column i. */
+            const double *row = covariance + (size_t)i * n;
+            double variance = row[i];
+            double others = sy[i] - variance * weights[i];
+            double y = (-others + sqrt(others * others + 4.0 * variance * budget)) / (2.0 * variance);
+            
+            double delta = y - weights[i];
+            if (delta != 0.0) {
+                for (int j = 0; j < n; j++) {
+                    sy[j] += delta * row[j];
+                }
+            }
+            
+            double relative = fabs(delta) / y;
+            if (relative > change) change = relative;
+            weights[i] = y;
+        }
+        
+        if (change < options->tolerance) break;
+    }
+    
+    double total = 0.0;
+    for (int i = 0; i < n; i++) {
+        total += weights[i];
+    }
+    for (int i = 0; i < n; i++) {
+        weights[i] /= total;
+    }
+    
+    free(sy);
+    return iteration;
+}
+
+
+int optimizer_solve(const double *covariance, const double *expected_returns, int n,
+                    const OptimizerOptions *options, double *weights) {
+    if (!covariance || !weights || n <= 0) return -1;
+    
+    OptimizerOptions defaults;
+    if (!options) {
+        optimizer_default_options(&defaults, OPTIMIZER_MIN_VARIANCE);
+        options = &defaults;
+    }
+    
+    if (n == 1) {
+        weights[0] = 1.0;
+        return 0;
+    }
+    
+    if (options->objective == OPTIMIZER_RISK_PARITY) {
+        return solve_risk_parity(covariance, n, options, weights);
+    }
+    return solve_quadratic(covariance, expected_returns, n, options, weights);
+}
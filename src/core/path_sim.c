@@ -0,0 +1,382 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "portfolio/path_sim.h"
+#include "portfolio/worker_pool.h"
+#include <pthread.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_LANES 4
+#define SIM_CHUNK_PATHS 1024
+#define SIM_GBM_TABLE 1024
+#define SIM_EXP_TABLE 4096
+
+
+typedef struct {
+    double *steps;        /* log returns, signed so that positive moves toward the target */
+    int size;
+    double variance;
+    double distance;      /* |log(target / start)| */
+    double step_hours;
+    int step_count;
+} PreparedJob;
+
+typedef struct {
+    const PreparedJob *job;
+    int paths;
+    unsigned long long seed;
+    int *histogram;       /* hits per step, job->step_count entries */
+} SimChunk;
+
+
+#if defined(__GNUC__)
+typedef unsigned long long SimLanes __attribute__((vector_size(SIM_LANES * sizeof(unsigned long long))));
+#else
+typedef struct { unsigned long long v[SIM_LANES]; } SimLanes;
+#endif
+
+/* xorshift128+ run in SIM_LANES independent streams. */
+typedef struct {
+    SimLanes s0, s1;
+} SimRng;
+
+
+static unsigned long long splitmix64(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+static void rng_seed(SimRng *rng, unsigned long long seed) {
+    unsigned long long words[2 * SIM_LANES];
+    for (int i = 0; i < 2 * SIM_LANES; i++) {
+        words[i] = splitmix64(&seed);
+    }
+    memcpy(&rng->s0, words, sizeof(rng->s0));
+    memcpy(&rng->s1, words + SIM_LANES, sizeof(rng->s1));
+}
+
+
+#if defined(__GNUC__)
+static inline void rng_next(SimRng *rng, unsigned long long *out) {
+    SimLanes s1 = rng->s0;
+    SimLanes s0 = rng->s1;
+    rng->s0 = s0;
+    s1 ^= s1 << 23;
+    rng->s1 = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+    SimLanes r = rng->s1 + s0;
+    memcpy(out, &r, sizeof(r));
+}
+#else
+static void rng_next(SimRng *rng, unsigned long long *out) {
+    for (int k = 0; k < SIM_LANES; k++) {
+        unsigned long long s1 = rng->s0.v[k];
+        unsigned long long s0 = rng->s1.v[k];
+        rng->s0.v[k] = s0;
+        s1 ^= s1 << 23;
+        rng->s1.v[k] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+        out[k] = rng->s1.v[k] + s0;
+    }
+}
+#endif
+
+
+/* Acklam's rational approximation of the standard normal quantile. */
+static double normal_quantile(double p) {
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    
+    if (p < 0.02425) {
+        double q = sqrt(-2.0 * log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > 1.0 - 0.02425) {
+        return -normal_quantile(1.0 - p);
+    }
+    
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+
+static float exponential_values[SIM_EXP_TABLE];
+static pthread_once_t exponential_once = PTHREAD_ONCE_INIT;
+
+
+static void fill_exponential_table(void) {
+    for (int i = 0; i < SIM_EXP_TABLE; i++) {
+        exponential_values[i] = (float)-log((i + 0.5) / SIM_EXP_TABLE);
+    }
+}
+
+
+/* Stratified Exp(1) draws. A path crosses between closes with probability
+ * exp(-x), which is the chance that such a draw exceeds x. */
+static const float* exponential_table(void) {
+    pthread_once(&exponential_once, fill_exponential_table);
+    return exponential_values;
+}
+
+
+/* Both models end up as a table of step returns drawn uniformly: the
+ * bootstrap uses the observed returns, GBM a stratified grid of normal
+ * quantiles with the observed mean and deviation. */
+static bool prepare_job(const PathSimJob *job, PreparedJob *prepared) {
+    memset(prepared, 0, sizeof(*prepared));
+    
+    if (!job->closes || job->count < 3 || job->start_price <= 0 || job->target_price <= 0 ||
+        job->paths <= 0 || job->steps <= 0 || job->step_hours <= 0) {
+        return false;
+    }
+    
+    double *returns = malloc((job->count - 1) * sizeof(double));
+    if (!returns) return false;
+    
+    int n = 0;
+    double sum = 0.0;
+    for (int i = 1; i < job->count; i++) {
+        if (job->closes[i - 1] > 0 && job->closes[i] > 0) {
+            returns[n] = log(job->closes[i] / job->closes[i - 1]);
+            sum += returns[n];
+            n++;
+        }
+    }
+    if (n < 2) {
+        free(returns);
+        return false;
+    }
+    
+    double mean = sum / n;
+    double variance = 0.0;
+    for (int i = 0; i < n; i++) {
+        variance += (returns[i] - mean) * (returns[i] - mean);
+    }
+    variance /= (n - 1);
+    
+    if (job->model == PATH_SIM_GBM && job->sigma > 0) {
+        variance = job->sigma * job->sigma;
+    }
+    
+    if (job->model == PATH_SIM_GBM) {
+        double *grid = realloc(returns, SIM_GBM_TABLE * sizeof(double));
+        if (!grid) {
+            free(returns);
+            return false;
+        }
+        returns = grid;
+        n = SIM_GBM_TABLE;
+        
+        double sigma = sqrt(variance);
+        for (int i = 0; i < n; i++) {
+            returns[i] = mean + sigma * normal_quantile((i + 0.5) / n);
+        }
+    }
+    
+    double log_distance = log(job->target_price / job->start_price);
+    if (log_distance < 0) {
+        for (int i = 0; i < n; i++) {
+            returns[i] = -returns[i];
+        }
+    }
+    
+    prepared->steps = returns;
+    prepared->size = n;
+    prepared->variance = variance;
+    prepared->distance = fabs(log_distance);
+    prepared->step_hours = job->step_hours;
+    prepared->step_count = (job->steps < PATH_SIM_MAX_STEPS) ? job->steps : PATH_SIM_MAX_STEPS;
+    return true;
+}
+
+
+/* Each step advances every live path of the chunk, SIM_LANES draws at a
+ * time, and compacts the survivors in place so finished paths cost
+ * nothing afterwards. The top 32 bits of a draw pick the step and bits
+ * 20-31 the Brownian bridge test, which catches paths that crossed the
+ * target between two candle closes. */
+static void simulate_chunk(void *arg) {
+    SimChunk *chunk = arg;
+    const PreparedJob *job = chunk->job;
+    const double *steps = job->steps;
+    unsigned long long size = (unsigned long long)job->size;
+    double distance = job->distance;
+    double bridge_scale = (job->variance > 0) ? 2.0 / job->variance : 0.0;
+    const float *exponential = exponential_table();
+    
+    if (distance == 0.0) {
+        chunk->histogram[0] += chunk->paths;
+        return;
+    }
+    
+    SimRng rng;
+    rng_seed(&rng, chunk->seed);
+    
+    double position[SIM_CHUNK_PATHS];
+    int alive = chunk->paths;
+    for (int i = 0; i < alive; i++) {
+        position[i] = 0.0;
+    }
+    
+    for (int step = 0; step < job->step_count && alive > 0; step++) {
+        int kept = 0;
+        
+        for (int i = 0; i < alive; i += SIM_LANES) {
+            unsigned long long bits[SIM_LANES];
+            rng_next(&rng, bits);
+            int lanes = (alive - i < SIM_LANES) ? alive - i : SIM_LANES;
+            
+            for (int k = 0; k < lanes; k++) {
+                double gap_before = distance - position[i + k];
+                double gap = gap_before - steps[((bits[k] >> 32) * size) >> 32];
+                double exponent = gap_before * gap * bridge_scale;
+                bool hit = (gap <= 0.0) | (exponent < exponential[(bits[k] >> 20) & (SIM_EXP_TABLE - 1)]);
+                
+                position[kept] = distance - gap;
+                kept += !hit;
+            }
+        }
+        
+        chunk->histogram[step] += alive - kept;
+        alive = kept;
+    }
+}
+
+
+static double hit_quantile(const int *histogram, int step_count, int hits, double q, double step_hours) {
+    long needed = (long)ceil(q * hits);
+    if (needed < 1) needed = 1;
+    
+    long seen = 0;
+    for (int s = 0; s < step_count; s++) {
+        seen += histogram[s];
+        if (seen >= needed) return (s + 1) * step_hours;
+    }
+    return step_count * step_hours;
+}
+
+
+int path_sim_run(const PathSimJob *jobs, int job_count, PathSimResult *results) {
+    if (!jobs || !results || job_count <= 0) return 0;
+    
+    PreparedJob *prepared = calloc(job_count, sizeof(PreparedJob));
+    if (!prepared) return 0;
+    
+    int chunk_count = 0;
+    long histogram_size = 0;
+    for (int j = 0; j < job_count; j++) {
+        memset(&results[j], 0, sizeof(PathSimResult));
+        if (prepare_job(&jobs[j], &prepared[j])) {
+            int chunks = (jobs[j].paths + SIM_CHUNK_PATHS - 1) / SIM_CHUNK_PATHS;
+            chunk_count += chunks;
+            histogram_size += (long)chunks * prepared[j].step_count;
+        }
+    }
+    
+    SimChunk *chunks = calloc(chunk_count > 0 ? chunk_count : 1, sizeof(SimChunk));
+    int *histograms = calloc(histogram_size > 0 ? histogram_size : 1, sizeof(int));
+    if (!chunks || !histograms) {
+        for (int j = 0; j < job_count; j++) free(prepared[j].steps);
+        free(prepared);
+        free(chunks);
+        free(histograms);
+        return 0;
+    }
+    
+    int c = 0;
+    long offset = 0;
+    for (int j = 0; j < job_count; j++) {
+        if (!prepared[j].steps) continue;
+        
+        int remaining = jobs[j].paths;
+        for (int i = 0; remaining > 0; i++) {
+            unsigned long long seed = jobs[j].seed + (unsigned long long)i * 0xD1B54A32D192ED03ULL;
+            chunks[c].job = &prepared[j];
+            chunks[c].paths = (remaining < SIM_CHUNK_PATHS) ? remaining : SIM_CHUNK_PATHS;
+            chunks[c].seed = splitmix64(&seed);
+            chunks[c].histogram = histograms + offset;
+            offset += prepared[j].step_count;
+            remaining -= chunks[c].paths;
+            c++;
+        }
+    }
+    
+    worker_pool_run(worker_pool_default(), simulate_chunk, chunks, sizeof(SimChunk), chunk_count);
+    
+    int done = 0;
+    c = 0;
+    for (int j = 0; j < job_count; j++) {
+        if (!prepared[j].steps) continue;
+        
+        int step_count = prepared[j].step_count;
+        int *merged = chunks[c].histogram;
+        int chunk_total = (jobs[j].paths + SIM_CHUNK_PATHS - 1) / SIM_CHUNK_PATHS;
+        for (int i = 1; i < chunk_total; i++) {
+            const int *h = chunks[c + i].histogram;
+            for (int s = 0; s < step_count; s++) {
+                merged[s] += h[s];
+            }
+        }
+        c += chunk_total;
+        
+        PathSimResult *result = &results[j];
+        double hit_steps = 0.0;
+        for (int s = 0; s < step_count; s++) {
+            result->hits += merged[s];
+            hit_steps += (double)merged[s] * (s + 1);
+        }
+        result->paths = jobs[j].paths;
+        result->probability = (double)result->hits / result->paths;
+        
+        if (result->hits > 0) {
+            double step_hours = prepared[j].step_hours;
+            result->mean_hours = hit_steps / result->hits * step_hours;
+            result->p25_hours = hit_quantile(merged, step_count, result->hits, 0.25, step_hours);
+            result->median_hours = hit_quantile(merged, step_count, result->hits, 0.50, step_hours);
+            result->p75_hours = hit_quantile(merged, step_count, result->hits, 0.75, step_hours);
+        }
+        
+        free(prepared[j].steps);
+        done++;
+    }
+    
+    free(histograms);
+    free(chunks);
+    free(prepared);
+    return done;
+}
+
+
+bool path_sim_first_passage(const PathSimJob *job, PathSimResult *result) {
+    return path_sim_run(job, 1, result) == 1;
+}
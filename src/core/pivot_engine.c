@@ -0,0 +1,450 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/pivot_engine.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+static int floor_log2(int value) {
+#if defined(__GNUC__)
+    return 31 - __builtin_clz((unsigned int)value);
+#else
+    int k = 0;
+    while ((2 << k) <= value) k++;
+    return k;
+#endif
+}
+
+
+static const double* level_max(const PivotTracker *tracker, int level) {
+    return (level == 0) ? tracker->prices : tracker->range_max[level];
+}
+
+
+static const double* level_min(const PivotTracker *tracker, int level) {
+    return (level == 0) ? tracker->prices : tracker->range_min[level];
+}
+
+
+static bool list_push(PivotList *list, int index) {
+    if (list->count >= list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 32;
+        int *grown = realloc(list->index, capacity * sizeof(int));
+        if (!grown) return false;
+        list->index = grown;
+        list->capacity = capacity;
+    }
+    
+    list->index[list->count++] = index;
+    return true;
+}
+
+
+static void list_truncate(PivotList *list, int last_valid_index) {
+    while (list->count > 0 && list->index[list->count - 1] > last_valid_index) {
+        list->count--;
+    }
+}
+
+
+static int list_lower_bound(const PivotList *list, int index) {
+    int lo = 0, hi = list->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (list->index[mid] < index) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+
+static bool reserve(PivotTracker *tracker, int needed) {
+    if (needed <= tracker->capacity) return true;
+    
+    int capacity = tracker->capacity ? tracker->capacity : 64;
+    while (capacity < needed) capacity *= 2;
+    
+    double *prices = realloc(tracker->prices, capacity * sizeof(double));
+    if (!prices) return false;
+    tracker->prices = prices;
+    
+    for (int k = 1; k < PIVOT_MAX_LEVELS && (1 << k) <= capacity; k++) {
+        double *max_level = realloc(tracker->range_max[k], capacity * sizeof(double));
+        if (!max_level) return false;
+        tracker->range_max[k] = max_level;
+        
+        double *min_level = realloc(tracker->range_min[k], capacity * sizeof(double));
+        if (!min_level) return false;
+        tracker->range_min[k] = min_level;
+    }
+    
+    tracker->capacity = capacity;
+    return true;
+}
+
+
+static double query_max(const PivotTracker *tracker, int from, int to) {
+    int k = floor_log2(to - from + 1);
+    const double *level = level_max(tracker, k);
+    double a = level[from];
+    double b = level[to - (1 << k) + 1];
+    return (a > b) ? a : b;
+}
+
+
+static double query_min(const PivotTracker *tracker, int from, int to) {
+    int k = floor_log2(to - from + 1);
+    const double *level = level_min(tracker, k);
+    double a = level[from];
+    double b = level[to - (1 << k) + 1];
+    return (a < b) ? a : b;
+}
+
+
+static void index_pivot(PivotTracker *tracker, int last) {
+    int candidate = last - PIVOT_WINDOW;
+    if (candidate < PIVOT_WINDOW) return;
+    
+    double price = tracker->prices[candidate];
+    if (query_max(tracker, candidate - PIVOT_WINDOW, last) <= price) {
+        list_push(&tracker->highs, candidate);
+    }
+    if (query_min(tracker, candidate - PIVOT_WINDOW, last) >= price) {
+        list_push(&tracker->lows, candidate);
+    }
+}
+
+
+/* Extends the sparse table and pivot lists for the newest close. */
+static void index_last(PivotTracker *tracker) {
+    int n = tracker->count - 1;
+    
+    for (int k = 1; (1 << k) <= n + 1; k++) {
+        int start = n + 1 - (1 << k);
+        int half = 1 << (k - 1);
+        const double *prev_max = level_max(tracker, k - 1);
+        const double *prev_min = level_min(tracker, k - 1);
+        
+        double a = prev_max[start], b = prev_max[start + half];
+        tracker->range_max[k][start] = (a > b) ? a : b;
+        
+        a = prev_min[start];
+        b = prev_min[start + half];
+        tracker->range_min[k][start] = (a < b) ? a : b;
+    }
+    
+    index_pivot(tracker, n);
+}
+
+
+void pivot_tracker_free(PivotTracker *tracker) {
+    if (!tracker) return;
+    
+    free(tracker->prices);
+    for (int k = 0; k < PIVOT_MAX_LEVELS; k++) {
+        free(tracker->range_max[k]);
+        free(tracker->range_min[k]);
+    }
+    free(tracker->highs.index);
+    free(tracker->lows.index);
+    memset(tracker, 0, sizeof(*tracker));
+}
+
+
+void pivot_tracker_clear(PivotTracker *tracker) {
+    if (!tracker) return;
+    
+    tracker->count = 0;
+    tracker->window_start = 0;
+    tracker->highs.count = 0;
+    tracker->lows.count = 0;
+}
+
+
+bool pivot_tracker_append(PivotTracker *tracker, double price) {
+    if (!tracker || !reserve(tracker, tracker->count + 1)) return false;
+    
+    tracker->prices[tracker->count++] = price;
+    index_last(tracker);
+    return true;
+}
+
+
+void pivot_tracker_truncate(PivotTracker *tracker, int count) {
+    if (!tracker || count >= tracker->count) return;
+    if (count < 0) count = 0;
+    
+    tracker->count = count;
+    if (tracker->window_start > count) {
+        tracker->window_start = count;
+    }
+    
+    list_truncate(&tracker->highs, count - 1 - PIVOT_WINDOW);
+    list_truncate(&tracker->lows, count - 1 - PIVOT_WINDOW);
+}
+
+
+bool pivot_tracker_build(PivotTracker *tracker, const double *prices, int count) {
+    if (!tracker) return false;
+    
+    pivot_tracker_clear(tracker);
+    if (!prices || count <= 0) return true;
+    if (!reserve(tracker, count)) return false;
+    
+    memmove(tracker->prices, prices, count * sizeof(double));
+    tracker->count = count;
+    
+    /* Level by level, so each pass streams through memory once. */
+    for (int k = 1; (1 << k) <= count; k++) {
+        int half = 1 << (k - 1);
+        int last = count - (1 << k);
+        const double *prev_max = level_max(tracker, k - 1);
+        const double *prev_min = level_min(tracker, k - 1);
+        double *cur_max = tracker->range_max[k];
+        double *cur_min = tracker->range_min[k];
+        
+        for (int j = 0; j <= last; j++) {
+            double a = prev_max[j], b = prev_max[j + half];
+            cur_max[j] = (a > b) ? a : b;
+            
+            a = prev_min[j];
+            b = prev_min[j + half];
+            cur_min[j] = (a < b) ? a : b;
+        }
+    }
+    
+    for (int i = 0; i < count; i++) {
+        index_pivot(tracker, i);
+    }
+    return true;
+}
+
+
+/* Brings the live window in line with a freshly fetched series. When the
+ * new series is the old one shifted forward, only the candles that were
+ * not closed before are replaced or appended. */
+bool pivot_tracker_sync(PivotTracker *tracker, const double *prices, int count) {
+    if (!tracker) return false;
+    
+    int window = tracker->count - tracker->window_start;
+    const double *old = tracker->prices + tracker->window_start;
+    
+    if (prices && count > 0 && window >= 2) {
+        for (int shift = 0; shift < window - 1; shift++) {
+            int overlap = window - 1 - shift;
+            if (overlap > count) continue;
+            if (old[shift] != prices[0]) continue;
+            if (memcmp(old + shift, prices, overlap * sizeof(double)) != 0) continue;
+            
+            pivot_tracker_truncate(tracker, tracker->count - 1);
+            tracker->window_start += shift;
+            for (int i = overlap; i < count; i++) {
+                if (!pivot_tracker_append(tracker, prices[i])) return false;
+            }
+            
+            if (tracker->window_start >= count) {
+                return pivot_tracker_build(tracker, tracker->prices + tracker->window_start, count);
+            }
+            return true;
+        }
+    }
+    
+    return pivot_tracker_build(tracker, prices, count);
+}
+
+
+int pivot_tracker_window_count(const PivotTracker *tracker) {
+    return tracker ? tracker->count - tracker->window_start : 0;
+}
+
+
+double pivot_range_max(const PivotTracker *tracker, int from, int to) {
+    if (!tracker || from > to || from < 0) return 0.0;
+    
+    from += tracker->window_start;
+    to += tracker->window_start;
+    if (to >= tracker->count) return 0.0;
+    return query_max(tracker, from, to);
+}
+
+
+double pivot_range_min(const PivotTracker *tracker, int from, int to) {
+    if (!tracker || from > to || from < 0) return 0.0;
+    
+    from += tracker->window_start;
+    to += tracker->window_start;
+    if (to >= tracker->count) return 0.0;
+    return query_min(tracker, from, to);
+}
+
+
+/* First index at or after from whose close is above (below) limit, or
+ * count if there is none. Descends the sparse table in O(log n). */
+static int first_above(const PivotTracker *tracker, int from, double limit) {
+    int pos = from;
+    for (int k = floor_log2(tracker->capacity); k >= 0; k--) {
+        if ((1 << k) > tracker->count - pos) continue;
+        if (level_max(tracker, k)[pos] <= limit) pos += 1 << k;
+    }
+    return pos;
+}
+
+
+static int first_below(const PivotTracker *tracker, int from, double limit) {
+    int pos = from;
+    for (int k = floor_log2(tracker->capacity); k >= 0; k--) {
+        if ((1 << k) > tracker->count - pos) continue;
+        if (level_min(tracker, k)[pos] >= limit) pos += 1 << k;
+    }
+    return pos;
+}
+
+
+/* Two swing lows (highs) at least 10 candles apart and within 2% of each
+ * other, with a move of more than 3% between them and no close more than
+ * 2% beyond the first one in between. */
+static bool match_double(const PivotTracker *tracker, bool bottom, int *pattern_idx) {
+    const PivotList *list = bottom ? &tracker->lows : &tracker->highs;
+    int base = tracker->window_start;
+    int n = tracker->count - base;
+    
+    if (n < 20) return false;
+    
+    for (int a = list_lower_bound(list, base + 10); a < list->count; a++) {
+        int ia = list->index[a];
+        if (ia - base >= n - 10) break;
+        
+        double pa = tracker->prices[ia];
+        if (pa <= 0) continue;
+        
+        int move = bottom ? first_above(tracker, ia + 1, pa * 1.03)
+                          : first_below(tracker, ia + 1, pa * 0.97);
+        if (move >= tracker->count) continue;
+        
+        int broken = bottom ? first_below(tracker, ia + 1, pa * 0.98)
+                            : first_above(tracker, ia + 1, pa * 1.02);
+        int pos = (move > ia + 10) ? move : ia + 10;
+        
+        while (pos < broken) {
+            pos = bottom ? first_below(tracker, pos, pa * 1.02)
+                         : first_above(tracker, pos, pa * 0.98);
+            
+            int b = list_lower_bound(list, pos);
+            if (b >= list->count) break;
+            
+            int ib = list->index[b];
+            if (ib >= broken) break;
+            
+            if (fabs(tracker->prices[ib] - pa) / pa < 0.02) {
+                *pattern_idx = ib - base;
+                return true;
+            }
+            pos = ib + 1;
+        }
+    }
+    
+    return false;
+}
+
+
+static bool shoulder_matches(double shoulder, double head, bool inverse) {
+    if (inverse) {
+        return shoulder >= head && shoulder <= head * 1.05;
+    }
+    return shoulder <= head && shoulder >= head * 0.95;
+}
+
+
+/* A swing high (low) head with a swing high (low) shoulder 5-15 candles
+ * on each side, both within 5% of the head and within 3% of each other. */
+static bool match_head_shoulders(const PivotTracker *tracker, bool inverse, int *pattern_idx) {
+    const PivotList *list = inverse ? &tracker->lows : &tracker->highs;
+    int base = tracker->window_start;
+    int n = tracker->count - base;
+    
+    if (n < 30) return false;
+    
+    for (int h = list_lower_bound(list, base + 15); h < list->count; h++) {
+        int ih = list->index[h];
+        if (ih - base >= n - 15) break;
+        
+        double ph = tracker->prices[ih];
+        
+        int left_from = ih - 15;
+        if (left_from < base + PIVOT_WINDOW) left_from = base + PIVOT_WINDOW;
+        
+        for (int l = list_lower_bound(list, left_from); l < h; l++) {
+            int il = list->index[l];
+            if (il >= ih - 5) break;
+            
+            double pl = tracker->prices[il];
+            if (pl <= 0 || !shoulder_matches(pl, ph, inverse)) continue;
+            
+            for (int r = h + 1; r < list->count; r++) {
+                int ir = list->index[r];
+                if (ir >= ih + 15) break;
+                if (ir < ih + 5) continue;
+                
+                double pr = tracker->prices[ir];
+                if (!shoulder_matches(pr, ph, inverse)) continue;
+                
+                if (fabs(pl - pr) / pl < 0.03) {
+                    *pattern_idx = ir - base;
+                    return true;
+                }
+            }
+        }
+    }
+    
+    return false;
+}
+
+
+bool pivot_detect_double_bottom(const PivotTracker *tracker, int *pattern_idx) {
+    if (!tracker || !pattern_idx) return false;
+    
+    *pattern_idx = -1;
+    return match_double(tracker, true, pattern_idx);
+}
+
+
+bool pivot_detect_double_top(const PivotTracker *tracker, int *pattern_idx) {
+    if (!tracker || !pattern_idx) return false;
+    
+    *pattern_idx = -1;
+    return match_double(tracker, false, pattern_idx);
+}
+
+
+bool pivot_detect_head_shoulders(const PivotTracker *tracker, int *pattern_idx) {
+    if (!tracker || !pattern_idx) return false;
+    
+    *pattern_idx = -1;
+    return match_head_shoulders(tracker, false, pattern_idx);
+}
+
+
+bool pivot_detect_inverse_head_shoulders(const PivotTracker *tracker, int *pattern_idx) {
+    if (!tracker || !pattern_idx) return false;
+    
+    *pattern_idx = -1;
+    return match_head_shoulders(tracker, true, pattern_idx);
+}
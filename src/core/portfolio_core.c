@@ -38,6 +38,12 @@ Portfolio* portfolio_create(void) {
 
 void portfolio_destroy(Portfolio *portfolio) {
     if (portfolio) {
+        for (int i = 0; i < MAX_PAIRS; i++) {
+            for (int s = 0; s < SERIES_COUNT; s++) {
+                pivot_tracker_free(&portfolio->pairs[i].pivots[s]);
+            }
+        }
+        covariance_destroy(portfolio->covariance.matrix);
         free(portfolio);
     }
 }
@@ -45,84 +51,14 @@ void portfolio_destroy(Portfolio *portfolio) {
 void portfolio_init_default(Portfolio *portfolio) {
     if (!portfolio) return;
     
-    portfolio->pair_count = 4;  
-    
-    
-    for (int i = 0; i < 4; i++) {
-        portfolio->pairs[i].current_price = 0.0;
-        portfolio->pairs[i].history_count = 0;
-        portfolio->pairs[i].history_index = 0;
-        portfolio->pairs[i].historical_count = 0;
-        portfolio->pairs[i].historical_loaded = false;
-        portfolio->pairs[i].last_historical_fetch = 0;
-        
-        
-        
-        portfolio->pairs[i].historical_5m_count = 0;
-        portfolio->pairs[i].historical_5m_loaded = false;
-        portfolio->pairs[i].last_5m_fetch = 0;
-        portfolio->pairs[i].historical_15m_count = 0;
-        portfolio->pairs[i].historical_15m_loaded = false;
-        portfolio->pairs[i].last_15m_fetch = 0;
-        
-        portfolio->pairs[i].historical_1h_count = 0;
-        portfolio->pairs[i].historical_1h_loaded = false;
-        portfolio->pairs[i].last_1h_fetch = 0;
-        portfolio->pairs[i].historical_4h_count = 0;
-        portfolio->pairs[i].historical_4h_loaded = false;
-        portfolio->pairs[i].last_4h_fetch = 0;
-        portfolio->pairs[i].historical_1d_count = 0;
-        portfolio->pairs[i].historical_1d_loaded = false;
-        portfolio->pairs[i].last_1d_fetch = 0;
-        
-        
-        portfolio->pairs[i].ema_12 = 0.0;
-        portfolio->pairs[i].ema_26 = 0.0;
-        portfolio->pairs[i].ema_50 = 0.0;
-        portfolio->pairs[i].ema_200 = 0.0;
-        portfolio->pairs[i].macd = 0.0;
-        portfolio->pairs[i].macd_signal = 0.0;
-        portfolio->pairs[i].bb_upper = 0.0;
-        portfolio->pairs[i].bb_middle = 0.0;
-        portfolio->pairs[i].bb_lower = 0.0;
-        
-        
-        portfolio->pairs[i].scalp_trend = 0.0;
-        portfolio->pairs[i].scalp_momentum = 0.0;
-        strcpy(portfolio->pairs[i].scalp_signal, "WAIT");
-        
-        
-        portfolio->pairs[i].profit_probability = 0.5;
-        portfolio->pairs[i].detected_patterns[0] = '\0';
-        portfolio->pairs[i].pattern_count = 0;
-    }
-    
-    
-    strcpy(portfolio->pairs[0].symbol, "btcusdt");
-    portfolio->pairs[0].bought_price = 30000.00;
-    portfolio->pairs[0].quantity = 2.1515;
-    portfolio->pairs[0].position_type = POSITION_LONG;
-    
-    
-    strcpy(portfolio->pairs[1].symbol, "ethusdt");
-    portfolio->pairs[1].bought_price = 1800.00;
-    portfolio->pairs[1].quantity = 5.5;
-    portfolio->pairs[1].position_type = POSITION_LONG;
-    
-    
-    strcpy(portfolio->pairs[2].symbol, "adausdt");
-    portfolio->pairs[2].bought_price = 0.45;
-    portfolio->pairs[2].quantity = 10000.0;
-    portfolio->pairs[2].position_type = POSITION_LONG;
-    
-    
-    strcpy(portfolio->pairs[3].symbol, "dogeusdt");
-    portfolio->pairs[3].bought_price = 0.10;  
-    portfolio->pairs[3].quantity = 50000.0;
-    portfolio->pairs[3].position_type = POSITION_SHORT;
+    portfolio->pair_count = 0;
+    portfolio_add_pair(portfolio, "btcusdt", 30000.00, 2.1515, POSITION_LONG);
+    portfolio_add_pair(portfolio, "ethusdt", 1800.00, 5.5, POSITION_LONG);
+    portfolio_add_pair(portfolio, "adausdt", 0.45, 10000.0, POSITION_LONG);
+    portfolio_add_pair(portfolio, "dogeusdt", 0.10, 50000.0, POSITION_SHORT);
 }
 
-char* portfolio_get_file_path(void) {
+char* portfolio_get_config_path(const char *file_name) {
     const char *home_dir = getenv("HOME");
     if (!home_dir) {
         home_dir = ".";
@@ -133,10 +69,14 @@ char* portfolio_get_file_path(void) {
     mkdir(config_dir, 0755);
     
     char *filepath = malloc(1024);
-    snprintf(filepath, 1024, "%s/portfolio.json", config_dir);
+    snprintf(filepath, 1024, "%s/%s", config_dir, file_name);
     return filepath;
 }
 
+char* portfolio_get_file_path(void) {
+    return portfolio_get_config_path("portfolio.json");
+}
+
 void portfolio_save(Portfolio *portfolio) {
     if (!portfolio) return;
     
@@ -210,29 +150,24 @@ bool portfolio_load(Portfolio *portfolio) {
     for (int i = 0; i < portfolio->pair_count; i++) {
         struct json_object *pair_obj = json_object_array_get_idx(pairs_array, i);
         struct json_object *symbol_obj, *bought_price_obj, *quantity_obj, *position_type_obj;
+        const char *symbol = "";
+        double bought_price = 0.0, quantity = 0.0;
+        PositionType position_type = POSITION_LONG;
         
         if (json_object_object_get_ex(pair_obj, "symbol", &symbol_obj)) {
-            strncpy(portfolio->pairs[i].symbol, json_object_get_string(symbol_obj), MAX_SYMBOL_LEN - 1);
+            symbol = json_object_get_string(symbol_obj);
         }
         if (json_object_object_get_ex(pair_obj, "bought_price", &bought_price_obj)) {
-            portfolio->pairs[i].bought_price = json_object_get_double(bought_price_obj);
+            bought_price = json_object_get_double(bought_price_obj);
         }
         if (json_object_object_get_ex(pair_obj, "quantity", &quantity_obj)) {
-            portfolio->pairs[i].quantity = json_object_get_double(quantity_obj);
+            quantity = json_object_get_double(quantity_obj);
         }
-        
         if (json_object_object_get_ex(pair_obj, "position_type", &position_type_obj)) {
-            portfolio->pairs[i].position_type = json_object_get_int(position_type_obj);
-        } else {
-            portfolio->pairs[i].position_type = POSITION_LONG;  
+            position_type = json_object_get_int(position_type_obj);
         }
         
-        portfolio->pairs[i].current_price = 0.0;
-        portfolio->pairs[i].history_count = 0;
-        portfolio->pairs[i].history_index = 0;
-        portfolio->pairs[i].historical_count = 0;
-        portfolio->pairs[i].historical_loaded = false;
-        portfolio->pairs[i].last_historical_fetch = 0;
+        portfolio_pair_init(&portfolio->pairs[i], symbol ? symbol : "", bought_price, quantity, position_type);
     }
     
     json_object_put(root);
@@ -240,6 +175,106 @@ bool portfolio_load(Portfolio *portfolio) {
     return true;
 }
 
+/* Consensus over 1h, 4h and 1d: two of the three agreeing sets the direction. */
+static void init_trend_consensus(TrendConsensus *trend) {
+    trend_consensus_init(trend, 10, 0.01, 2.0);
+    trend_consensus_set_weight(trend, SERIES_1H, 1.0);
+    trend_consensus_set_weight(trend, SERIES_4H, 1.0);
+    trend_consensus_set_weight(trend, SERIES_1D, 1.0);
+}
+
+static void init_volatility(VolatilityStream *streams) {
+    static const double candle_hours[SERIES_COUNT] = { 0, 0, 5.0 / 60.0, 0.25, 1.0, 4.0, 24.0 };
+    
+    for (int s = 0; s < SERIES_COUNT; s++) {
+        volatility_stream_init(&streams[s], 30, candle_hours[s]);
+    }
+}
+
+static void init_scalp_streams(TradingPair *pair) {
+    static const int fast_periods[4] = { 5, 10, 20, 50 };
+    static const int confirm_periods[2] = { 10, 20 };
+    
+    scalp_stream_init(&pair->scalp_5m, 5 * 60 * 1000LL, fast_periods, 4);
+    scalp_stream_init(&pair->scalp_15m, 15 * 60 * 1000LL, confirm_periods, 2);
+}
+
+/* Resets pair to a freshly added state trading symbol. */
+void portfolio_pair_init(TradingPair *pair, const char *symbol, double bought_price,
+                         double quantity, PositionType position_type) {
+    if (!pair || !symbol) return;
+    
+    strncpy(pair->symbol, symbol, MAX_SYMBOL_LEN - 1);
+    pair->symbol[MAX_SYMBOL_LEN - 1] = '\0';
+    pair->bought_price = bought_price;
+    pair->quantity = quantity;
+    pair->position_type = position_type;
+    pair->current_price = 0.0;
+    pair->history_count = 0;
+    pair->history_index = 0;
+    pair->historical_count = 0;
+    pair->historical_loaded = false;
+    pair->last_historical_fetch = 0;
+    
+    
+    
+    pair->historical_5m_count = 0;
+    pair->historical_5m_loaded = false;
+    pair->last_5m_fetch = 0;
+    pair->historical_15m_count = 0;
+    pair->historical_15m_loaded = false;
+    pair->last_15m_fetch = 0;
+    
+    pair->historical_1h_count = 0;
+    pair->historical_1h_loaded = false;
+    pair->last_1h_fetch = 0;
+    pair->historical_4h_count = 0;
+    pair->historical_4h_loaded = false;
+    pair->last_4h_fetch = 0;
+    pair->historical_1d_count = 0;
+    pair->historical_1d_loaded = false;
+    pair->last_1d_fetch = 0;
+    
+    
+    pair->ema_12 = 0.0;
+    pair->ema_26 = 0.0;
+    pair->ema_50 = 0.0;
+    pair->ema_200 = 0.0;
+    pair->macd = 0.0;
+    pair->macd_signal = 0.0;
+    pair->bb_upper = 0.0;
+    pair->bb_middle = 0.0;
+    pair->bb_lower = 0.0;
+    
+    
+    pair->scalp_trend = 0.0;
+    pair->scalp_momentum = 0.0;
+    pair->scalp_signal = SCALP_WAIT;
+    scalp_params_default(&pair->scalp_params);
+    
+    
+    pair->profit_probability = 0.5;
+    memset(pair->patterns, 0, sizeof(pair->patterns));
+    
+    
+    for (int s = 0; s < SERIES_COUNT; s++) {
+        pair->series_version[s]++;
+        rsi_stream_reset(&pair->rsi_stream[s]);
+        pivot_tracker_clear(&pair->pivots[s]);
+        ohlc_stream_reset(&pair->ohlc_stream[s]);
+    }
+    memset(pair->candle_count, 0, sizeof(pair->candle_count));
+    memset(pair->ohlc, 0, sizeof(pair->ohlc));
+    init_trend_consensus(&pair->trend);
+    init_volatility(pair->volatility);
+    init_scalp_streams(pair);
+    pair->bot_route = -1;
+    pair->bot_route_generation = 0;
+    volume_profile_reset(&pair->volume_profile);
+    memset(&pair->volume_levels, 0, sizeof(pair->volume_levels));
+    indicator_cache_clear(&pair->indicator_cache);
+}
+
 int portfolio_add_pair(Portfolio *portfolio, const char *symbol, double bought_price, 
                        double quantity, PositionType position_type) {
     if (!portfolio || portfolio->pair_count >= MAX_PAIRS) {
@@ -247,57 +282,7 @@ int portfolio_add_pair(Portfolio *portfolio, const char *symbol, double bought_p
     }
     
     int index = portfolio->pair_count;
-    strncpy(portfolio->pairs[index].symbol, symbol, MAX_SYMBOL_LEN - 1);
-    portfolio->pairs[index].symbol[MAX_SYMBOL_LEN - 1] = '\0';
-    portfolio->pairs[index].bought_price = bought_price;
-    portfolio->pairs[index].quantity = quantity;
-    portfolio->pairs[index].position_type = position_type;
-    portfolio->pairs[index].current_price = 0.0;
-    portfolio->pairs[index].history_count = 0;
-    portfolio->pairs[index].history_index = 0;
-    portfolio->pairs[index].historical_count = 0;
-    portfolio->pairs[index].historical_loaded = false;
-    portfolio->pairs[index].last_historical_fetch = 0;
-    
-    
-    
-    portfolio->pairs[index].historical_5m_count = 0;
-    portfolio->pairs[index].historical_5m_loaded = false;
-    portfolio->pairs[index].last_5m_fetch = 0;
-    portfolio->pairs[index].historical_15m_count = 0;
-    portfolio->pairs[index].historical_15m_loaded = false;
-    portfolio->pairs[index].last_15m_fetch = 0;
-    
-    portfolio->pairs[index].historical_1h_count = 0;
-    portfolio->pairs[index].historical_1h_loaded = false;
-    portfolio->pairs[index].last_1h_fetch = 0;
-    portfolio->pairs[index].historical_4h_count = 0;
-    portfolio->pairs[index].historical_4h_loaded = false;
-    portfolio->pairs[index].last_4h_fetch = 0;
-    portfolio->pairs[index].historical_1d_count = 0;
-    portfolio->pairs[index].historical_1d_loaded = false;
-    portfolio->pairs[index].last_1d_fetch = 0;
-    
-    
-    portfolio->pairs[index].ema_12 = 0.0;
-    portfolio->pairs[index].ema_26 = 0.0;
-    portfolio->pairs[index].ema_50 = 0.0;
-    portfolio->pairs[index].ema_200 = 0.0;
-    portfolio->pairs[index].macd = 0.0;
-    portfolio->pairs[index].macd_signal = 0.0;
-    portfolio->pairs[index].bb_upper = 0.0;
-    portfolio->pairs[index].bb_middle = 0.0;
-    portfolio->pairs[index].bb_lower = 0.0;
-    
-    
-    portfolio->pairs[index].scalp_trend = 0.0;
-    portfolio->pairs[index].scalp_momentum = 0.0;
-    strcpy(portfolio->pairs[index].scalp_signal, "WAIT");
-    
-    
-    portfolio->pairs[index].profit_probability = 0.5;
-    portfolio->pairs[index].detected_patterns[0] = '\0';
-    portfolio->pairs[index].pattern_count = 0;
+    portfolio_pair_init(&portfolio->pairs[index], symbol, bought_price, quantity, position_type);
     
     portfolio->pair_count++;
     return index;
@@ -308,10 +293,17 @@ void portfolio_remove_pair(Portfolio *portfolio, int index) {
         return;
     }
     
+    for (int s = 0; s < SERIES_COUNT; s++) {
+        pivot_tracker_free(&portfolio->pairs[index].pivots[s]);
+    }
+    
     for (int i = index; i < portfolio->pair_count - 1; i++) {
         portfolio->pairs[i] = portfolio->pairs[i + 1];
     }
     portfolio->pair_count--;
+    
+    /* The vacated slot's trackers now belong to the pair shifted down. */
+    memset(&portfolio->pairs[portfolio->pair_count], 0, sizeof(TradingPair));
 }
 
 void portfolio_update_pair(Portfolio *portfolio, int index, const char *symbol, 
@@ -325,6 +317,7 @@ void portfolio_update_pair(Portfolio *portfolio, int index, const char *symbol,
     portfolio->pairs[index].bought_price = bought_price;
     portfolio->pairs[index].quantity = quantity;
     portfolio->pairs[index].position_type = position_type;
+    portfolio->pairs[index].bot_route_generation = 0;
 }
 
 void portfolio_update_current_price(Portfolio *portfolio, int index, double price) {
@@ -340,6 +333,321 @@ void portfolio_update_current_price(Portfolio *portfolio, int index, double pric
     if (pair->history_count < PRICE_HISTORY_SIZE) {
         pair->history_count++;
     }
+    
+    rsi_stream_push(&pair->rsi_stream[SERIES_TICK], price);
+    pair->series_version[SERIES_TICK]++;
+}
+
+
+SeriesId portfolio_series_from_interval(const char *interval) {
+    if (!interval) return SERIES_COUNT;
+    
+    if (strcmp(interval, "5m") == 0) return SERIES_5M;
+    if (strcmp(interval, "15m") == 0) return SERIES_15M;
+    if (strcmp(interval, "1h") == 0) return SERIES_1H;
+    if (strcmp(interval, "4h") == 0) return SERIES_4H;
+    if (strcmp(interval, "1d") == 0) return SERIES_1D;
+    return SERIES_COUNT;
+}
+
+const char* portfolio_series_name(SeriesId series) {
+    switch (series) {
+        case SERIES_TICK: return "tick";
+        case SERIES_LEGACY: return "legacy";
+        case SERIES_5M: return "5m";
+        case SERIES_15M: return "15m";
+        case SERIES_1H: return "1h";
+        case SERIES_4H: return "4h";
+        case SERIES_1D: return "1d";
+        default: return "?";
+    }
+}
+
+int portfolio_store_series(TradingPair *pair, SeriesId series, const double *prices, int count) {
+    if (!pair || !prices || count < 0) return 0;
+    
+    double *dest = NULL;
+    int capacity = 0;
+    int *dest_count = NULL;
+    bool *loaded = NULL;
+    time_t *fetched = NULL;
+    
+    switch (series) {
+        case SERIES_LEGACY:
+            dest = pair->historical_prices; capacity = HISTORICAL_DATA_SIZE;
+            dest_count = &pair->historical_count; loaded = &pair->historical_loaded;
+            fetched = &pair->last_historical_fetch;
+            break;
+        case SERIES_5M:
+            dest = pair->historical_5m; capacity = HISTORICAL_DATA_SIZE_5M;
+            dest_count = &pair->historical_5m_count; loaded = &pair->historical_5m_loaded;
+            fetched = &pair->last_5m_fetch;
+            break;
+        case SERIES_15M:
+            dest = pair->historical_15m; capacity = HISTORICAL_DATA_SIZE_15M;
+            dest_count = &pair->historical_15m_count; loaded = &pair->historical_15m_loaded;
+            fetched = &pair->last_15m_fetch;
+            break;
+        case SERIES_1H:
+            dest = pair->historical_1h; capacity = HISTORICAL_DATA_SIZE_1H;
+            dest_count = &pair->historical_1h_count; loaded = &pair->historical_1h_loaded;
+            fetched = &pair->last_1h_fetch;
+            break;
+        case SERIES_4H:
+            dest = pair->historical_4h; capacity = HISTORICAL_DATA_SIZE_4H;
+            dest_count = &pair->historical_4h_count; loaded = &pair->historical_4h_loaded;
+            fetched = &pair->last_4h_fetch;
+            break;
+        case SERIES_1D:
+            dest = pair->historical_1d; capacity = HISTORICAL_DATA_SIZE_1D;
+            dest_count = &pair->historical_1d_count; loaded = &pair->historical_1d_loaded;
+            fetched = &pair->last_1d_fetch;
+            break;
+        default:
+            return 0;
+    }
+    
+    int copy_count = (count < capacity) ? count : capacity;
+    memcpy(dest, prices, copy_count * sizeof(double));
+    *dest_count = copy_count;
+    *loaded = true;
+    *fetched = clock_now(NULL);
+    
+    rsi_stream_reset(&pair->rsi_stream[series]);
+    rsi_stream_push_many(&pair->rsi_stream[series], dest, copy_count);
+    pivot_tracker_sync(&pair->pivots[series], dest, copy_count);
+    if (pair->trend.min_score <= 0) init_trend_consensus(&pair->trend);
+    trend_consensus_load(&pair->trend, series, dest, copy_count);
+    
+    pair->series_version[series]++;
+    return copy_count;
+}
+
+const double* portfolio_series_data(const TradingPair *pair, SeriesId series, int *count) {
+    if (count) *count = 0;
+    if (!pair) return NULL;
+    
+    const double *data = NULL;
+    int n = 0;
+    
+    switch (series) {
+        case SERIES_LEGACY:
+            if (pair->historical_loaded) { data = pair->historical_prices; n = pair->historical_count; }
+            break;
+        case SERIES_5M:
+            if (pair->historical_5m_loaded) { data = pair->historical_5m; n = pair->historical_5m_count; }
+            break;
+        case SERIES_15M:
+            if (pair->historical_15m_loaded) { data = pair->historical_15m; n = pair->historical_15m_count; }
+            break;
+        case SERIES_1H:
+            if (pair->historical_1h_loaded) { data = pair->historical_1h; n = pair->historical_1h_count; }
+            break;
+        case SERIES_4H:
+            if (pair->historical_4h_loaded) { data = pair->historical_4h; n = pair->historical_4h_count; }
+            break;
+        case SERIES_1D:
+            if (pair->historical_1d_loaded) { data = pair->historical_1d; n = pair->historical_1d_count; }
+            break;
+        default:
+            break;
+    }
+    
+    if (count) *count = n;
+    return data;
+}
+
+static Candle* candle_storage(TradingPair *pair, SeriesId series, int *capacity) {
+    switch (series) {
+        case SERIES_5M: *capacity = HISTORICAL_DATA_SIZE_5M; return pair->candles_5m;
+        case SERIES_15M: *capacity = HISTORICAL_DATA_SIZE_15M; return pair->candles_15m;
+        case SERIES_1H: *capacity = HISTORICAL_DATA_SIZE_1H; return pair->candles_1h;
+        case SERIES_4H: *capacity = HISTORICAL_DATA_SIZE_4H; return pair->candles_4h;
+        case SERIES_1D: *capacity = HISTORICAL_DATA_SIZE_1D; return pair->candles_1d;
+        default: *capacity = 0; return NULL;
+    }
+}
+
+static int closed_candles(const TradingPair *pair, SeriesId series, const Candle **candles) {
+    int count = 0;
+    *candles = portfolio_series_candles(pair, series, &count);
+    return (count > 1) ? count - 1 : 0;
+}
+
+/* Rebuilds the volume profile from the closed candles of every timeframe,
+ * each coarser series only covering the time before the finer one starts.
+ * Bin width follows the typical candle range of the finest series. */
+static void rebuild_volume_profile(TradingPair *pair) {
+    static const SeriesId order[] = { SERIES_1H, SERIES_4H, SERIES_1D };
+    static const long long span_ms[] = { 3600000LL, 14400000LL, 86400000LL };
+    const Candle *data[3];
+    int count[3], used[3];
+    long long cutoff = 0;
+    
+    for (int k = 0; k < 3; k++) {
+        count[k] = closed_candles(pair, order[k], &data[k]);
+        used[k] = 0;
+        while (used[k] < count[k] && (cutoff == 0 || data[k][used[k]].open_time + span_ms[k] <= cutoff)) {
+            used[k]++;
+        }
+        if (count[k] > 0 && (cutoff == 0 || data[k][0].open_time < cutoff)) {
+            cutoff = data[k][0].open_time;
+        }
+    }
+    
+    VolumeProfile *profile = &pair->volume_profile;
+    volume_profile_reset(profile);
+    
+    double low = 0.0, high = 0.0, typical = 0.0;
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < used[k]; i++) {
+            if (low == 0.0 || data[k][i].low < low) low = data[k][i].low;
+            if (data[k][i].high > high) high = data[k][i].high;
+        }
+        if (typical == 0.0 && used[k] > 0) {
+            int from = (used[k] > 50) ? used[k] - 50 : 0;
+            for (int i = from; i < used[k]; i++) {
+                typical += data[k][i].high - data[k][i].low;
+            }
+            typical /= used[k] - from;
+        }
+    }
+    if (high <= 0.0) return;
+    
+    volume_profile_prepare(profile, low, high, typical);
+    for (int k = 2; k >= 0; k--) {
+        for (int i = 0; i < used[k]; i++) {
+            volume_profile_add(profile, &data[k][i]);
+        }
+    }
+    if (used[0] > 0) profile->last_open_time = data[0][used[0] - 1].open_time;
+}
+
+/* Newly closed 1h candles are folded into the existing profile; anything
+ * else, or a 1h batch that does not continue it, rebuilds from scratch. */
+static void update_volume_profile(TradingPair *pair, SeriesId series) {
+    if (series != SERIES_1H && series != SERIES_4H && series != SERIES_1D) return;
+    
+    VolumeProfile *profile = &pair->volume_profile;
+    const Candle *candles = NULL;
+    int closed = closed_candles(pair, SERIES_1H, &candles);
+    
+    if (series == SERIES_1H && profile->last_open_time > 0 && closed > 0 &&
+        candles[0].open_time <= profile->last_open_time) {
+        for (int i = 0; i < closed; i++) {
+            if (candles[i].open_time <= profile->last_open_time) continue;
+            volume_profile_add(profile, &candles[i]);
+            profile->last_open_time = candles[i].open_time;
+        }
+    } else {
+        rebuild_volume_profile(pair);
+    }
+    
+    volume_profile_levels(profile, &pair->volume_levels);
+}
+
+/* The last fetched candle is still forming, so the OHLC stream commits the
+ * closed ones and the published values include the forming one via peek. */
+int portfolio_store_candles(TradingPair *pair, SeriesId series, const Candle *candles, int count) {
+    if (!pair || !candles || count < 0) return 0;
+    
+    int capacity = 0;
+    Candle *dest = candle_storage(pair, series, &capacity);
+    if (!dest) return 0;
+    
+    int copy_count = (count < capacity) ? count : capacity;
+    memcpy(dest, candles, copy_count * sizeof(Candle));
+    pair->candle_count[series] = copy_count;
+    
+    int closed = (copy_count > 0) ? copy_count - 1 : 0;
+    ohlc_stream_backfill(&pair->ohlc_stream[series], dest, closed);
+    ohlc_stream_peek(&pair->ohlc_stream[series], copy_count > 0 ? &dest[closed] : NULL, &pair->ohlc[series]);
+    if (pair->volatility[series].window == 0) init_volatility(pair->volatility);
+    volatility_stream_backfill(&pair->volatility[series], dest, closed);
+    update_volume_profile(pair, series);
+    
+    if (series == SERIES_5M || series == SERIES_15M) {
+        if (pair->scalp_5m.interval_ms == 0) init_scalp_streams(pair);
+        scalp_stream_load(series == SERIES_5M ? &pair->scalp_5m : &pair->scalp_15m, dest, copy_count);
+    }
+    
+    /* HISTORICAL_DATA_SIZE_1H is the largest candle series. */
+    double closes[HISTORICAL_DATA_SIZE_1H];
+    for (int i = 0; i < copy_count; i++) {
+        closes[i] = dest[i].close;
+    }
+    return portfolio_store_series(pair, series, closes, copy_count);
+}
+
+const Candle* portfolio_series_candles(const TradingPair *pair, SeriesId series, int *count) {
+    if (count) *count = 0;
+    if (!pair) return NULL;
+    
+    int capacity = 0;
+    const Candle *data = candle_storage((TradingPair *)pair, series, &capacity);
+    if (!data || pair->candle_count[series] == 0) return NULL;
+    
+    if (count) *count = pair->candle_count[series];
+    return data;
+}
+
+const OhlcValues* portfolio_series_ohlc(const TradingPair *pair, SeriesId series) {
+    if (!pair || series < 0 || series >= SERIES_COUNT || pair->candle_count[series] == 0) {
+        return NULL;
+    }
+    return &pair->ohlc[series];
+}
+
+unsigned int portfolio_series_version(const TradingPair *pair, SeriesId series) {
+    if (!pair || series < 0 || series >= SERIES_COUNT) return 0;
+    return pair->series_version[series];
+}
+
+void portfolio_touch_series(TradingPair *pair, SeriesId series) {
+    if (!pair || series < 0 || series >= SERIES_COUNT) return;
+    pair->series_version[series]++;
+}
+
+IndicatorCache* portfolio_indicator_cache(const TradingPair *pair) {
+    if (!pair) return NULL;
+    
+    /* Memoized values are scratch state, so readers holding a const pair may fill them. */
+    return (IndicatorCache *)&pair->indicator_cache;
+}
+
+void portfolio_set_trend_weight(TradingPair *pair, SeriesId series, double weight) {
+    if (!pair || series < 0 || series >= SERIES_COUNT) return;
+    
+    if (pair->trend.min_score <= 0) init_trend_consensus(&pair->trend);
+    trend_consensus_set_weight(&pair->trend, series, weight);
+}
+
+int portfolio_series_trend(const TradingPair *pair, SeriesId series) {
+    if (!pair || series < 0 || series >= SERIES_COUNT) return 0;
+    return trend_consensus_frame(&pair->trend, series);
+}
+
+const VolumeLevels* portfolio_volume_levels(const TradingPair *pair) {
+    if (!pair || pair->volume_profile.total_volume <= 0) return NULL;
+    return &pair->volume_levels;
+}
+
+double portfolio_series_volatility(const TradingPair *pair, SeriesId series, VolEstimator estimator) {
+    if (!pair || series < 0 || series >= SERIES_COUNT) return 0.0;
+    return volatility_stream_annualized(&pair->volatility[series], estimator);
+}
+
+/* Yang-Zhang over closed candles, from the first timeframe with a full
+ * window; 0 when none has one. */
+double portfolio_annualized_volatility(const TradingPair *pair) {
+    static const SeriesId order[] = { SERIES_1H, SERIES_4H, SERIES_1D, SERIES_15M, SERIES_5M };
+    if (!pair) return 0.0;
+    
+    for (int i = 0; i < 5; i++) {
+        double volatility = portfolio_series_volatility(pair, order[i], VOL_YANG_ZHANG);
+        if (volatility > 0) return volatility;
+    }
+    return 0.0;
 }
 
 double portfolio_get_total_value(const Portfolio *portfolio) {
@@ -0,0 +1,161 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/rsi_stream.h"
+#include <string.h>
+
+static const int DEFAULT_RSI_PERIODS[RSI_STREAM_MAX_PERIODS] = { 2, 7, 14, 21 };
+
+
+void rsi_stream_init(RsiStream *stream, const int *periods, int period_count) {
+    if (!stream) return;
+    
+    memset(stream, 0, sizeof(*stream));
+    
+    if (!periods || period_count <= 0) {
+        periods = DEFAULT_RSI_PERIODS;
+        period_count = RSI_STREAM_MAX_PERIODS;
+    }
+    if (period_count > RSI_STREAM_MAX_PERIODS) {
+        period_count = RSI_STREAM_MAX_PERIODS;
+    }
+    
+    for (int i = 0; i < period_count; i++) {
+        stream->periods[i] = (periods[i] > 0) ? periods[i] : 1;
+    }
+    stream->period_count = period_count;
+}
+
+
+void rsi_stream_reset(RsiStream *stream) {
+    if (!stream) return;
+    
+    if (stream->period_count == 0) {
+        rsi_stream_init(stream, NULL, 0);
+        return;
+    }
+    
+    memset(stream->avg_gain, 0, sizeof(stream->avg_gain));
+    memset(stream->avg_loss, 0, sizeof(stream->avg_loss));
+    stream->samples = 0;
+    stream->last_close = 0.0;
+    stream->has_close = false;
+}
+
+
+void rsi_stream_push(RsiStream *stream, double close) {
+    if (!stream) return;
+    
+    if (stream->period_count == 0) {
+        rsi_stream_init(stream, NULL, 0);
+    }
+    
+    if (!stream->has_close) {
+        stream->last_close = close;
+        stream->has_close = true;
+        return;
+    }
+    
+    double change = close - stream->last_close;
+    double gain = (change > 0) ? change : 0.0;
+    double loss = (change < 0) ? -change : 0.0;
+    stream->last_close = close;
+    stream->samples++;
+    
+    for (int i = 0; i < stream->period_count; i++) {
+        int period = stream->periods[i];
+        
+        if (stream->samples < period) {
+            stream->avg_gain[i] += gain;
+            stream->avg_loss[i] += loss;
+        } else if (stream->samples == period) {
+            stream->avg_gain[i] = (stream->avg_gain[i] + gain) / period;
+            stream->avg_loss[i] = (stream->avg_loss[i] + loss) / period;
+        } else {
+            stream->avg_gain[i] = (stream->avg_gain[i] * (period - 1) + gain) / period;
+            stream->avg_loss[i] = (stream->avg_loss[i] * (period - 1) + loss) / period;
+        }
+    }
+}
+
+
+void rsi_stream_push_many(RsiStream *stream, const double *closes, int count) {
+    if (!stream || !closes) return;
+    
+    for (int i = 0; i < count; i++) {
+        rsi_stream_push(stream, closes[i]);
+    }
+}
+
+
+static int period_slot(const RsiStream *stream, int period) {
+    for (int i = 0; i < stream->period_count; i++) {
+        if (stream->periods[i] == period) return i;
+    }
+    return -1;
+}
+
+
+static double rsi_from_averages(double avg_gain, double avg_loss) {
+    if (avg_loss == 0) {
+        return 100.0;
+    }
+    
+    double rs = avg_gain / avg_loss;
+    return 100.0 - (100.0 / (1.0 + rs));
+}
+
+
+bool rsi_stream_ready(const RsiStream *stream, int period) {
+    if (!stream) return false;
+    
+    int slot = period_slot(stream, period);
+    return slot >= 0 && stream->samples >= period;
+}
+
+
+double rsi_stream_value(const RsiStream *stream, int period) {
+    if (!rsi_stream_ready(stream, period)) return 50.0;
+    
+    int slot = period_slot(stream, period);
+    return rsi_from_averages(stream->avg_gain[slot], stream->avg_loss[slot]);
+}
+
+
+double rsi_stream_peek(const RsiStream *stream, int period, double close) {
+    if (!stream || !stream->has_close) return 50.0;
+    
+    int slot = period_slot(stream, period);
+    if (slot < 0 || stream->samples + 1 < period) return 50.0;
+    
+    double change = close - stream->last_close;
+    double gain = (change > 0) ? change : 0.0;
+    double loss = (change < 0) ? -change : 0.0;
+    double avg_gain, avg_loss;
+    
+    if (stream->samples + 1 == period) {
+        avg_gain = (stream->avg_gain[slot] + gain) / period;
+        avg_loss = (stream->avg_loss[slot] + loss) / period;
+    } else {
+        avg_gain = (stream->avg_gain[slot] * (period - 1) + gain) / period;
+        avg_loss = (stream->avg_loss[slot] * (period - 1) + loss) / period;
+    }
+    
+    return rsi_from_averages(avg_gain, avg_loss);
+}
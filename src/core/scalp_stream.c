@@ -0,0 +1,118 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/scalp_stream.h"
+#include <string.h>
+
+
+void scalp_stream_init(ScalpStream *stream, long long interval_ms, const int *ema_periods, int ema_count) {
+    if (!stream) return;
+    
+    memset(stream, 0, sizeof(*stream));
+    stream->interval_ms = interval_ms;
+    if (ema_count > SCALP_MAX_EMAS) ema_count = SCALP_MAX_EMAS;
+    for (int i = 0; ema_periods && i < ema_count; i++) {
+        if (ema_periods[i] > 0) stream->ema_periods[stream->ema_count++] = ema_periods[i];
+    }
+    
+    static const int rsi_period = 14;
+    rsi_stream_init(&stream->rsi, &rsi_period, 1);
+}
+
+
+static void commit(ScalpStream *stream, double close) {
+    long n = ++stream->closed;
+    
+    for (int i = 0; i < stream->ema_count; i++) {
+        int period = stream->ema_periods[i];
+        if (n < period) {
+            stream->ema_seed[i] += close;
+        } else if (n == period) {
+            stream->ema[i] = (stream->ema_seed[i] + close) / period;
+        } else {
+            stream->ema[i] += (close - stream->ema[i]) * (2.0 / (period + 1.0));
+        }
+    }
+    
+    rsi_stream_push(&stream->rsi, close);
+    stream->recent[(n - 1) % SCALP_MOMENTUM_PERIOD] = close;
+}
+
+
+/* The last candle is the forming one. */
+void scalp_stream_load(ScalpStream *stream, const Candle *candles, int count) {
+    if (!stream) return;
+    
+    int periods[SCALP_MAX_EMAS];
+    memcpy(periods, stream->ema_periods, sizeof(periods));
+    scalp_stream_init(stream, stream->interval_ms, periods, stream->ema_count);
+    if (!candles || count <= 0) return;
+    
+    for (int i = 0; i < count - 1; i++) {
+        commit(stream, candles[i].close);
+    }
+    stream->open_time = candles[count - 1].open_time;
+    stream->forming_close = candles[count - 1].close;
+}
+
+
+void scalp_stream_tick(ScalpStream *stream, double price, long long now_ms) {
+    if (!stream || stream->open_time == 0 || price <= 0) return;
+    
+    if (stream->interval_ms > 0) {
+        for (int i = 0; i < SCALP_MAX_ROLLOVER && now_ms >= stream->open_time + stream->interval_ms; i++) {
+            commit(stream, stream->forming_close);
+            stream->open_time += stream->interval_ms;
+        }
+    }
+    stream->forming_close = price;
+}
+
+
+/* Closed candles plus the forming one. */
+int scalp_stream_count(const ScalpStream *stream) {
+    if (!stream || stream->open_time == 0) return 0;
+    return (int)stream->closed + 1;
+}
+
+
+/* back = 0 is the forming close, 1 the last closed one, and so on. */
+double scalp_stream_close(const ScalpStream *stream, int back) {
+    if (!stream || back < 0 || back >= SCALP_MOMENTUM_PERIOD || back > stream->closed) return 0.0;
+    if (back == 0) return stream->forming_close;
+    return stream->recent[(stream->closed - back) % SCALP_MOMENTUM_PERIOD];
+}
+
+
+/* 0.0 while fewer than period closes exist, as calculate_ema gives. */
+double scalp_stream_ema(const ScalpStream *stream, int index) {
+    if (!stream || index < 0 || index >= stream->ema_count || stream->open_time == 0) return 0.0;
+    
+    int period = stream->ema_periods[index];
+    long n = stream->closed;
+    if (n + 1 < period) return 0.0;
+    if (n + 1 == period) return (stream->ema_seed[index] + stream->forming_close) / period;
+    return stream->ema[index] + (stream->forming_close - stream->ema[index]) * (2.0 / (period + 1.0));
+}
+
+
+double scalp_stream_rsi(const ScalpStream *stream, int period) {
+    if (!stream || stream->open_time == 0) return 50.0;
+    return rsi_stream_peek(&stream->rsi, period, stream->forming_close);
+}
@@ -17,56 +17,247 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "portfolio/scalping_bot.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
 
-BotManager* bot_manager_create(void) {
-    BotManager *manager = calloc(1, sizeof(BotManager));
-    if (!manager) return NULL;
+/* Timestamps and cooldowns follow the manager's clock. */
+static time_t manager_now(const BotManager *manager) {
+    return clock_now(manager ? manager->clock : NULL);
+}
+
+
+static void bot_log(const BotManager *manager, const char *format, ...) {
+    if (manager && manager->quiet) return;
     
-    manager->bot_count = 0;
-    for (int i = 0; i < MAX_BOTS; i++) {
-        manager->bots[i].active = false;
-        manager->bots[i].status = BOT_STOPPED;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+
+static unsigned int symbol_hash(const char *symbol) {
+    unsigned int hash = 2166136261u;
+    for (; *symbol; symbol++) {
+        hash ^= (unsigned char)toupper((unsigned char)*symbol);
+        hash *= 16777619u;
     }
-    
-    return manager;
+    return hash;
 }
 
 
-void bot_manager_destroy(BotManager *manager) {
-    if (manager) {
-        free(manager);
+static bool symbol_matches(const char *upper, const char *symbol) {
+    for (; *upper && *symbol; upper++, symbol++) {
+        if (*upper != toupper((unsigned char)*symbol)) return false;
     }
+    return *upper == *symbol;
 }
 
 
-int bot_add(BotManager *manager, const char *symbol, double initial_balance, double trade_amount) {
-    if (!manager || !symbol || manager->bot_count >= MAX_BOTS) {
-        return -1;
+static int find_route_slot(const BotRoute *routes, int capacity, const char *symbol) {
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int slot = symbol_hash(symbol) & mask;
+    while (routes[slot].symbol[0] && !symbol_matches(routes[slot].symbol, symbol)) {
+        slot = (slot + 1) & mask;
+    }
+    return (int)slot;
+}
+
+
+/* Doubles the route table, moving every route to its new slot. */
+static bool grow_routes(BotManager *manager) {
+    int capacity = manager->route_capacity ? manager->route_capacity * 2 : 16;
+    BotRoute *routes = malloc((size_t)capacity * sizeof(BotRoute));
+    if (!routes) return false;
+    
+    for (int r = 0; r < capacity; r++) {
+        routes[r].symbol[0] = '\0';
+        routes[r].first_bot = -1;
+    }
+    for (int r = 0; r < manager->route_capacity; r++) {
+        const BotRoute *old = &manager->routes[r];
+        if (!old->symbol[0]) continue;
+        
+        int slot = find_route_slot(routes, capacity, old->symbol);
+        routes[slot] = *old;
+        for (int i = old->first_bot; i >= 0; i = bot_manager_get(manager, i)->next_subscriber) {
+            bot_manager_get(manager, i)->route = slot;
+        }
     }
     
+    free(manager->routes);
+    manager->routes = routes;
+    manager->route_capacity = capacity;
+    manager->route_generation++;
+    return true;
+}
+
+
+/* Links the bot at the head of its symbol's route, creating the route
+ * first if needed. A new route can change lookups that previously missed,
+ * so it invalidates the slots cached on pairs. */
+static bool subscribe(BotManager *manager, int bot_index) {
+    ScalpingBot *bot = bot_manager_get(manager, bot_index);
+    
+    if ((manager->route_count + 1) * 2 > manager->route_capacity && !grow_routes(manager)) {
+        return false;
+    }
     
-    int index = -1;
-    for (int i = 0; i < MAX_BOTS; i++) {
-        if (!manager->bots[i].active) {
-            index = i;
-            break;
+    int slot = find_route_slot(manager->routes, manager->route_capacity, bot->symbol);
+    BotRoute *route = &manager->routes[slot];
+    if (!route->symbol[0]) {
+        for (int k = 0; k < MAX_SYMBOL_LEN; k++) {
+            route->symbol[k] = (char)toupper((unsigned char)bot->symbol[k]);
+            if (!bot->symbol[k]) break;
         }
+        manager->route_count++;
+        manager->route_generation++;
     }
     
-    if (index == -1) return -1;
+    bot->route = slot;
+    bot->prev_subscriber = -1;
+    bot->next_subscriber = route->first_bot;
+    if (route->first_bot >= 0) {
+        bot_manager_get(manager, route->first_bot)->prev_subscriber = bot_index;
+    }
+    route->first_bot = bot_index;
+    return true;
+}
+
+
+static void unsubscribe(BotManager *manager, int bot_index) {
+    ScalpingBot *bot = bot_manager_get(manager, bot_index);
+    if (bot->route < 0) return;
     
-    ScalpingBot *bot = &manager->bots[index];
+    if (bot->prev_subscriber >= 0) {
+        bot_manager_get(manager, bot->prev_subscriber)->next_subscriber = bot->next_subscriber;
+    } else {
+        manager->routes[bot->route].first_bot = bot->next_subscriber;
+    }
+    if (bot->next_subscriber >= 0) {
+        bot_manager_get(manager, bot->next_subscriber)->prev_subscriber = bot->prev_subscriber;
+    }
+    
+    bot->route = -1;
+    bot->prev_subscriber = -1;
+    bot->next_subscriber = -1;
+}
+
+
+/* Adds a chunk of BOT_CHUNK_SIZE free bots and threads them onto the free list. */
+static bool grow_pool(BotManager *manager) {
+    if (manager->capacity >= MAX_BOTS) return false;
+    
+    ScalpingBot **chunks = realloc(manager->chunks, (size_t)(manager->chunk_count + 1) * sizeof(ScalpingBot *));
+    if (!chunks) return false;
+    manager->chunks = chunks;
+    
+    int *active = realloc(manager->active, (size_t)(manager->capacity + BOT_CHUNK_SIZE) * sizeof(int));
+    if (!active) return false;
+    manager->active = active;
+    
+    ScalpingBot *chunk = calloc(BOT_CHUNK_SIZE, sizeof(ScalpingBot));
+    if (!chunk) return false;
+    
+    int base = manager->capacity;
+    for (int k = BOT_CHUNK_SIZE - 1; k >= 0; k--) {
+        chunk[k].status = BOT_STOPPED;
+        chunk[k].route = -1;
+        chunk[k].prev_subscriber = -1;
+        chunk[k].next_subscriber = -1;
+        chunk[k].active_slot = -1;
+        chunk[k].next_free = manager->free_head;
+        manager->free_head = base + k;
+    }
+    
+    manager->chunks[manager->chunk_count++] = chunk;
+    manager->capacity += BOT_CHUNK_SIZE;
+    return true;
+}
+
+
+BotManager* bot_manager_create(void) {
+    BotManager *manager = calloc(1, sizeof(BotManager));
+    if (!manager) return NULL;
     
+    manager->free_head = -1;
+    manager->route_generation = 1;
+    
+    return manager;
+}
+
+
+void bot_manager_destroy(BotManager *manager) {
+    if (!manager) return;
+    
+    for (int c = 0; c < manager->chunk_count; c++) {
+        for (int k = 0; k < BOT_CHUNK_SIZE; k++) {
+            free(manager->chunks[c][k].trades);
+            free(manager->chunks[c][k].equity_series);
+            free(manager->chunks[c][k].strategy_state);
+            trade_journal_close(manager->chunks[c][k].journal);
+        }
+        free(manager->chunks[c]);
+    }
+    free(manager->chunks);
+    free(manager->active);
+    free(manager->routes);
+    free(manager->journal_dir);
+    free(manager);
+}
+
+
+ScalpingBot* bot_manager_get(BotManager *manager, int bot_index) {
+    if (!manager || bot_index < 0 || bot_index >= manager->capacity) return NULL;
+    return &manager->chunks[bot_index / BOT_CHUNK_SIZE][bot_index % BOT_CHUNK_SIZE];
+}
+
+
+static ScalpingBot* active_bot(BotManager *manager, int bot_index) {
+    ScalpingBot *bot = bot_manager_get(manager, bot_index);
+    return (bot && bot->active) ? bot : NULL;
+}
+
+
+static void init_strategy(ScalpingBot *bot) {
+    if (bot->strategy_state) memset(bot->strategy_state, 0, bot->strategy->state_size);
+    if (bot->strategy->init) bot->strategy->init(bot->strategy, bot->strategy_state);
+}
+
+
+static int add_bot(BotManager *manager, const char *symbol, double initial_balance, double trade_amount,
+                   const BotStrategy *strategy) {
+    if (manager->free_head < 0 && !grow_pool(manager)) return -1;
+    
+    int index = manager->free_head;
+    ScalpingBot *bot = &manager->chunks[index / BOT_CHUNK_SIZE][index % BOT_CHUNK_SIZE];
+    
+    void *state = NULL;
+    if (strategy->state_size > 0 && !(state = malloc(strategy->state_size))) return -1;
     
     strncpy(bot->symbol, symbol, MAX_SYMBOL_LEN - 1);
     bot->symbol[MAX_SYMBOL_LEN - 1] = '\0';
+    if (!subscribe(manager, index)) {
+        free(state);
+        return -1;
+    }
+    
+    bot->strategy = strategy;
+    bot->strategy_state = state;
+    init_strategy(bot);
+    
+    manager->free_head = bot->next_free;
+    bot->next_free = -1;
     bot->active = true;
     bot->status = BOT_STOPPED;
     
@@ -76,114 +267,276 @@ int bot_add(BotManager *manager, const char *symbol, double initial_balance, dou
     
     bot->current_position = 0.0;
     bot->avg_buy_price = 0.0;
+    bot->equity = initial_balance;
+    bot->peak_equity = initial_balance;
+    bot->max_drawdown = 0.0;
     
     bot->total_trades = 0;
     bot->winning_trades = 0;
     bot->losing_trades = 0;
     bot->total_profit = 0.0;
     bot->total_fees_paid = 0.0;
-    bot->max_drawdown = 0.0;
     bot->win_rate = 0.0;
     
+    bot->cancelled_orders = 0;
+    bot->order.pending = false;
+    
     bot->trade_count = 0;
     bot->trade_index = 0;
     
-    bot->created_at = time(NULL);
+    bot->created_at = manager_now(manager);
     bot->last_trade_time = 0;
+    bot->cooldown_seconds = BOT_COOLDOWN_SECONDS;
     
-    manager->bot_count++;
+    bot->active_slot = manager->bot_count;
+    manager->active[manager->bot_count++] = index;
+    return index;
+}
+
+
+static void journal_settings(ScalpingBot *bot) {
+    trade_journal_update_settings(bot->journal, bot->trade_amount_usd, bot->cooldown_seconds, (int)bot->status);
+}
+
+
+int bot_add(BotManager *manager, const char *symbol, double initial_balance, double trade_amount) {
+    return bot_add_strategy(manager, symbol, initial_balance, trade_amount, NULL);
+}
+
+
+/* A NULL strategy is bot_strategy_default(). */
+int bot_add_strategy(BotManager *manager, const char *symbol, double initial_balance, double trade_amount,
+                     const BotStrategy *strategy) {
+    if (!manager || !symbol) {
+        return -1;
+    }
+    if (!strategy) strategy = bot_strategy_default();
+    
+    int index = add_bot(manager, symbol, initial_balance, trade_amount, strategy);
+    if (index < 0) return -1;
+    
+    ScalpingBot *bot = bot_manager_get(manager, index);
+    if (manager->journal_dir) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/bot_%d.journal", manager->journal_dir, manager->next_journal_id++);
+        
+        JournalHeader header;
+        journal_header_init(&header, bot->symbol, initial_balance, trade_amount, (long long)bot->created_at);
+        header.cooldown_seconds = bot->cooldown_seconds;
+        if (strategy != bot_strategy_default()) {
+            strncpy(header.strategy, strategy->name, JOURNAL_SYMBOL_LEN - 1);
+        }
+        bot->journal = trade_journal_create(path, &header);
+        if (!bot->journal) {
+            fprintf(stderr, "Bot #%d: could not create journal %s, trades will not be saved\n", index, path);
+        }
+    }
     
-    printf("Bot #%d created for %s with $%.2f balance\n", index, symbol, initial_balance);
+    bot_log(manager, "Bot #%d created for %s with $%.2f balance, %s strategy\n",
+            index, symbol, initial_balance, strategy->name);
     
     return index;
 }
 
 
 void bot_remove(BotManager *manager, int bot_index) {
-    if (!manager || bot_index < 0 || bot_index >= MAX_BOTS) return;
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (!bot) return;
     
-    ScalpingBot *bot = &manager->bots[bot_index];
-    if (bot->active) {
-        bot->active = false;
-        bot->status = BOT_STOPPED;
-        manager->bot_count--;
-        printf("Bot #%d removed\n", bot_index);
-    }
+    unsubscribe(manager, bot_index);
+    
+    int last = manager->active[--manager->bot_count];
+    manager->active[bot->active_slot] = last;
+    bot_manager_get(manager, last)->active_slot = bot->active_slot;
+    bot->active_slot = -1;
+    
+    free(bot->trades);
+    bot->trades = NULL;
+    bot->trade_capacity = 0;
+    free(bot->equity_series);
+    bot->equity_series = NULL;
+    free(bot->strategy_state);
+    bot->strategy_state = NULL;
+    trade_journal_remove(bot->journal);
+    bot->journal = NULL;
+    
+    bot->active = false;
+    bot->status = BOT_STOPPED;
+    bot->next_free = manager->free_head;
+    manager->free_head = bot_index;
+    bot_log(manager, "Bot #%d removed\n", bot_index);
 }
 
 
 void bot_start(BotManager *manager, int bot_index) {
-    if (!manager || bot_index < 0 || bot_index >= MAX_BOTS) return;
-    
-    ScalpingBot *bot = &manager->bots[bot_index];
-    if (bot->active) {
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (bot) {
         bot->status = BOT_RUNNING;
-        printf("Bot #%d started for %s\n", bot_index, bot->symbol);
+        journal_settings(bot);
+        bot_log(manager, "Bot #%d started for %s\n", bot_index, bot->symbol);
     }
 }
 
 
 void bot_stop(BotManager *manager, int bot_index) {
-    if (!manager || bot_index < 0 || bot_index >= MAX_BOTS) return;
-    
-    ScalpingBot *bot = &manager->bots[bot_index];
-    if (bot->active) {
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (bot) {
         bot->status = BOT_STOPPED;
-        printf("Bot #%d stopped\n", bot_index);
+        journal_settings(bot);
+        bot_log(manager, "Bot #%d stopped\n", bot_index);
     }
 }
 
 
 void bot_pause(BotManager *manager, int bot_index) {
-    if (!manager || bot_index < 0 || bot_index >= MAX_BOTS) return;
-    
-    ScalpingBot *bot = &manager->bots[bot_index];
-    if (bot->active && bot->status == BOT_RUNNING) {
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (bot && bot->status == BOT_RUNNING) {
         bot->status = BOT_PAUSED;
-        printf("Bot #%d paused\n", bot_index);
+        journal_settings(bot);
+        bot_log(manager, "Bot #%d paused\n", bot_index);
     }
 }
 
 
 void bot_reset(BotManager *manager, int bot_index) {
-    if (!manager || bot_index < 0 || bot_index >= MAX_BOTS) return;
-    
-    ScalpingBot *bot = &manager->bots[bot_index];
-    if (!bot->active) return;
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (!bot) return;
     
     bot->current_balance = bot->initial_balance;
     bot->current_position = 0.0;
     bot->avg_buy_price = 0.0;
+    bot->equity = bot->initial_balance;
+    bot->peak_equity = bot->initial_balance;
+    bot->max_drawdown = 0.0;
+    if (bot->equity_series) equity_series_init(bot->equity_series);
+    init_strategy(bot);
     
     bot->total_trades = 0;
     bot->winning_trades = 0;
     bot->losing_trades = 0;
     bot->total_profit = 0.0;
     bot->total_fees_paid = 0.0;
-    bot->max_drawdown = 0.0;
     bot->win_rate = 0.0;
     
+    bot->cancelled_orders = 0;
+    bot->order.pending = false;
+    
     bot->trade_count = 0;
     bot->trade_index = 0;
     bot->last_trade_time = 0;
+    trade_journal_reset(bot->journal);
+    
+    bot_log(manager, "Bot #%d reset\n", bot_index);
+}
+
+
+/* Slot for the next trade record. The history grows by doubling until it
+ * holds MAX_TRADES_HISTORY records and is a ring from then on; if growing
+ * fails the records already held wrap instead. */
+static TradeRecord* next_trade(ScalpingBot *bot) {
+    if (bot->trade_count == bot->trade_capacity && bot->trade_capacity < MAX_TRADES_HISTORY) {
+        int capacity = bot->trade_capacity ? bot->trade_capacity * 2 : 8;
+        if (capacity > MAX_TRADES_HISTORY) capacity = MAX_TRADES_HISTORY;
+        
+        TradeRecord *trades = realloc(bot->trades, (size_t)capacity * sizeof(TradeRecord));
+        if (trades) {
+            bot->trades = trades;
+            bot->trade_capacity = capacity;
+            bot->trade_index = bot->trade_count;
+        }
+    }
+    if (bot->trade_capacity == 0) return NULL;
+    
+    TradeRecord *trade = &bot->trades[bot->trade_index];
+    bot->trade_index = (bot->trade_index + 1) % bot->trade_capacity;
+    if (bot->trade_count < bot->trade_capacity) {
+        bot->trade_count++;
+    }
+    return trade;
+}
+
+
+/* back = 0 is the newest trade. */
+const TradeRecord* bot_recent_trade(const ScalpingBot *bot, int back) {
+    if (!bot || back < 0 || back >= bot->trade_count) return NULL;
+    
+    int idx = (bot->trade_index - 1 - back + bot->trade_capacity) % bot->trade_capacity;
+    return &bot->trades[idx];
+}
+
+
+static void record_trade(ScalpingBot *bot, int side, time_t timestamp, double price, double quantity,
+                         double fee, double total_cost, ScalpSignal signal) {
+    TradeRecord *trade = next_trade(bot);
+    if (trade) {
+        trade->timestamp = timestamp;
+        strcpy(trade->action, (side == JOURNAL_BUY) ? "BUY" : "SELL");
+        trade->price = price;
+        trade->quantity = quantity;
+        trade->fee = fee;
+        trade->total_cost = total_cost;
+        trade->balance_after = bot->current_balance;
+        trade->signal = signal;
+    }
+    
+    if (bot->journal) {
+        JournalRecord record = {
+            .timestamp = (long long)timestamp,
+            .price = price,
+            .quantity = quantity,
+            .fee = fee,
+            .total_cost = total_cost,
+            .balance_after = bot->current_balance,
+            .side = (unsigned char)side,
+            .signal = (unsigned short)signal
+        };
+        trade_journal_append(bot->journal, &record);
+    }
+}
+
+
+/* Values the bot at price as of now, raising the peak or deepening the
+ * drawdown, and folds the value into its equity series. */
+static void mark_equity(const BotManager *manager, ScalpingBot *bot, double price) {
+    double equity = bot->current_balance + bot->current_position * price;
+    bot->equity = equity;
+    if (equity > bot->peak_equity) {
+        bot->peak_equity = equity;
+    } else if (bot->peak_equity > 0 && (bot->peak_equity - equity) / bot->peak_equity > bot->max_drawdown) {
+        bot->max_drawdown = (bot->peak_equity - equity) / bot->peak_equity;
+    }
     
-    printf("Bot #%d reset\n", bot_index);
+    if (!bot->equity_series) {
+        bot->equity_series = malloc(sizeof(EquitySeries));
+        if (!bot->equity_series) return;
+        equity_series_init(bot->equity_series);
+    }
+    equity_series_push(bot->equity_series, clock_now_ms(manager ? manager->clock : NULL), equity);
+}
+
+
+static void notify_fill(ScalpingBot *bot, bool buy, double price, double quantity) {
+    if (!bot->strategy || !bot->strategy->on_fill) return;
+    
+    Fill fill = { price, quantity };
+    bot->strategy->on_fill(bot->strategy, bot->strategy_state, bot, buy, &fill);
 }
 
 
-void bot_execute_buy(ScalpingBot *bot, double price, const char *signal) {
+static void execute_buy(const BotManager *manager, ScalpingBot *bot, double price, double fee_rate,
+                        ScalpSignal signal) {
     if (!bot || price <= 0) return;
     
     
     if (bot->current_balance < bot->trade_amount_usd) {
-        printf("Bot %s: Insufficient balance for buy (%.2f < %.2f)\n", 
-               bot->symbol, bot->current_balance, bot->trade_amount_usd);
+        bot_log(manager, "Bot %s: Insufficient balance for buy (%.2f < %.2f)\n", 
+                         bot->symbol, bot->current_balance, bot->trade_amount_usd);
         return;
     }
     
     
     double gross_quantity = bot->trade_amount_usd / price;
-    double fee = gross_quantity * TAKER_FEE;  
+    double fee = gross_quantity * fee_rate;
     double net_quantity = gross_quantity - fee;
     double total_cost = bot->trade_amount_usd;
     
@@ -197,31 +550,21 @@ void bot_execute_buy(ScalpingBot *bot, double price, const char *signal) {
     bot->total_fees_paid += fee * price;
     
     
-    int idx = bot->trade_index;
-    bot->trades[idx].timestamp = time(NULL);
-    strcpy(bot->trades[idx].action, "BUY");
-    bot->trades[idx].price = price;
-    bot->trades[idx].quantity = net_quantity;
-    bot->trades[idx].fee = fee * price;
-    bot->trades[idx].total_cost = total_cost;
-    bot->trades[idx].balance_after = bot->current_balance;
-    strncpy(bot->trades[idx].signal, signal, 63);
-    bot->trades[idx].signal[63] = '\0';
-    
-    bot->trade_index = (bot->trade_index + 1) % MAX_TRADES_HISTORY;
-    if (bot->trade_count < MAX_TRADES_HISTORY) {
-        bot->trade_count++;
-    }
+    time_t now = manager_now(manager);
+    record_trade(bot, JOURNAL_BUY, now, price, net_quantity, fee * price, total_cost, signal);
     
     bot->total_trades++;
-    bot->last_trade_time = time(NULL);
+    bot->last_trade_time = now;
+    mark_equity(manager, bot, price);
+    notify_fill(bot, true, price, net_quantity);
     
-    printf("Bot %s BUY: %.6f @ $%.2f (fee: $%.2f) | Balance: $%.2f | Position: %.6f\n",
-           bot->symbol, net_quantity, price, fee * price, bot->current_balance, bot->current_position);
+    bot_log(manager, "Bot %s BUY: %.6f @ $%.2f (fee: $%.2f) | Balance: $%.2f | Position: %.6f\n",
+                     bot->symbol, net_quantity, price, fee * price, bot->current_balance, bot->current_position);
 }
 
 
-void bot_execute_sell(ScalpingBot *bot, double price, const char *signal) {
+static void execute_sell(const BotManager *manager, ScalpingBot *bot, double price, double fee_rate,
+                         ScalpSignal signal) {
     if (!bot || price <= 0) return;
     
     
@@ -232,7 +575,7 @@ void bot_execute_sell(ScalpingBot *bot, double price, const char *signal) {
     
     double sell_quantity = bot->current_position;
     double gross_proceeds = sell_quantity * price;
-    double fee = gross_proceeds * TAKER_FEE;
+    double fee = gross_proceeds * fee_rate;
     double net_proceeds = gross_proceeds - fee;
     
     
@@ -251,112 +594,351 @@ void bot_execute_sell(ScalpingBot *bot, double price, const char *signal) {
     }
     
     
-    int idx = bot->trade_index;
-    bot->trades[idx].timestamp = time(NULL);
-    strcpy(bot->trades[idx].action, "SELL");
-    bot->trades[idx].price = price;
-    bot->trades[idx].quantity = sell_quantity;
-    bot->trades[idx].fee = fee;
-    bot->trades[idx].total_cost = net_proceeds;
-    bot->trades[idx].balance_after = bot->current_balance;
-    strncpy(bot->trades[idx].signal, signal, 63);
-    bot->trades[idx].signal[63] = '\0';
-    
-    bot->trade_index = (bot->trade_index + 1) % MAX_TRADES_HISTORY;
-    if (bot->trade_count < MAX_TRADES_HISTORY) {
-        bot->trade_count++;
-    }
+    time_t now = manager_now(manager);
+    record_trade(bot, JOURNAL_SELL, now, price, sell_quantity, fee, net_proceeds, signal);
     
     bot->total_trades++;
-    bot->last_trade_time = time(NULL);
+    bot->last_trade_time = now;
     
     
     bot->current_position = 0.0;
     bot->avg_buy_price = 0.0;
+    mark_equity(manager, bot, price);
+    notify_fill(bot, false, price, sell_quantity);
     
+    bot_log(manager, "Bot %s SELL: %.6f @ $%.2f (fee: $%.2f) | P/L: $%+.2f | Balance: $%.2f\n",
+                     bot->symbol, sell_quantity, price, fee, profit, bot->current_balance);
+}
+
+
+void bot_execute_buy(ScalpingBot *bot, double price, ScalpSignal signal) {
+    execute_buy(NULL, bot, price, TAKER_FEE, signal);
+}
+
+
+void bot_execute_sell(ScalpingBot *bot, double price, ScalpSignal signal) {
+    execute_sell(NULL, bot, price, TAKER_FEE, signal);
+}
+
+
+void fill_params_default(FillParams *params) {
+    if (!params) return;
+    
+    params->spread_bps = 2.0;
+    params->level_usd = 25000.0;
+    params->level_step_bps = 1.0;
+    params->latency_ms = 200;
+    params->maker_timeout_ms = 300000;
+    params->maker_fee = MAKER_FEE;
+    params->taker_fee = TAKER_FEE;
+    params->policy = FILL_TAKER;
+}
+
+
+/* Walks a book whose first level sits half the spread from mid, each
+ * further level level_step_bps beyond it and each holding level_usd. */
+static void take_synthetic(const ExecutionModel *model, bool buy, double mid, double amount, Fill *fill) {
+    const FillParams *params = &model->params;
+    double side = buy ? 1.0 : -1.0;
+    double touch = mid * (1.0 + side * params->spread_bps * 0.5e-4);
+    double step = mid * side * params->level_step_bps * 1e-4;
+    
+    if (params->level_usd <= 0 || amount <= 0) {
+        fill->price = touch;
+        fill->quantity = buy ? amount / touch : amount;
+        return;
+    }
     
-    double drawdown = (bot->initial_balance - bot->current_balance) / bot->initial_balance;
-    if (drawdown > bot->max_drawdown) {
-        bot->max_drawdown = drawdown;
+    /* Quote left to spend on a buy, base left to sell on a sell. */
+    double remaining = amount;
+    double quantity = 0.0, proceeds = 0.0;
+    double price = touch;
+    for (int level = 0; remaining > 0; level++) {
+        price = touch + level * step;
+        if (price <= 0) break;
+        
+        double level_quantity = params->level_usd / price;
+        if (buy) {
+            double spend = (remaining < params->level_usd) ? remaining : params->level_usd;
+            quantity += spend / price;
+            remaining -= spend;
+        } else {
+            double sold = (remaining < level_quantity) ? remaining : level_quantity;
+            proceeds += sold * price;
+            remaining -= sold;
+        }
     }
     
-    printf("Bot %s SELL: %.6f @ $%.2f (fee: $%.2f) | P/L: $%+.2f | Balance: $%.2f\n",
-           bot->symbol, sell_quantity, price, fee, profit, bot->current_balance);
+    if (buy) {
+        fill->quantity = quantity;
+        fill->price = (quantity > 0) ? (amount - remaining) / quantity : touch;
+    } else {
+        fill->quantity = amount - remaining;
+        fill->price = (fill->quantity > 0) ? proceeds / fill->quantity : price;
+    }
 }
 
 
-void bot_process_signal(BotManager *manager, int bot_index, const TradingPair *pair) {
-    if (!manager || !pair || bot_index < 0 || bot_index >= MAX_BOTS) return;
+void execution_model_init(ExecutionModel *model, const FillParams *params) {
+    if (!model) return;
     
-    ScalpingBot *bot = &manager->bots[bot_index];
+    memset(model, 0, sizeof(*model));
+    if (params) {
+        model->params = *params;
+    } else {
+        fill_params_default(&model->params);
+    }
+    model->take = take_synthetic;
+}
+
+
+/* Fills or cancels the bot's pending order against price as of now.
+ * Returns true if the order went away. */
+static bool settle_order(const BotManager *manager, ScalpingBot *bot, double price) {
+    BotOrder *order = &bot->order;
+    const ExecutionModel *model = manager->execution;
+    long long now = clock_now_ms(manager->clock);
+    if (!order->pending || now < order->due_ms || price <= 0) return false;
+    
+    if (order->maker) {
+        bool crossed = order->buy ? (price <= order->limit) : (price >= order->limit);
+        if (crossed) {
+            order->pending = false;
+            if (order->buy) {
+                execute_buy(manager, bot, order->limit, model->params.maker_fee, order->signal);
+            } else {
+                execute_sell(manager, bot, order->limit, model->params.maker_fee, order->signal);
+            }
+            return true;
+        }
+        if (order->expires_ms > 0 && now >= order->expires_ms) {
+            order->pending = false;
+            bot->cancelled_orders++;
+            bot_log(manager, "Bot %s: %s order at $%.2f expired unfilled\n",
+                             bot->symbol, order->buy ? "buy" : "sell", order->limit);
+            return true;
+        }
+        return false;
+    }
     
+    order->pending = false;
+    Fill fill;
+    if (order->buy) {
+        model->take(model, true, price, bot->trade_amount_usd, &fill);
+        execute_buy(manager, bot, fill.price, model->params.taker_fee, order->signal);
+    } else {
+        model->take(model, false, price, bot->current_position, &fill);
+        execute_sell(manager, bot, fill.price, model->params.taker_fee, order->signal);
+    }
+    return true;
+}
+
+
+/* Without an execution model the order fills on the spot at price.
+ * Otherwise it reaches the book latency_ms later and either takes
+ * liquidity there or rests at the touch as a maker. */
+static void place_order(const BotManager *manager, ScalpingBot *bot, bool buy, double price, ScalpSignal signal) {
+    const ExecutionModel *model = manager->execution;
+    if (!model) {
+        if (buy) {
+            execute_buy(manager, bot, price, TAKER_FEE, signal);
+        } else {
+            execute_sell(manager, bot, price, TAKER_FEE, signal);
+        }
+        return;
+    }
     
-    if (!bot->active || bot->status != BOT_RUNNING) return;
+    const FillParams *params = &model->params;
+    BotOrder *order = &bot->order;
+    order->pending = true;
+    order->buy = buy;
+    order->maker = params->policy == FILL_MAKER || (params->policy == FILL_AUTO && !(signal & SCALP_STRONG));
+    order->signal = signal;
+    order->due_ms = clock_now_ms(manager->clock) + params->latency_ms;
+    order->expires_ms = 0;
+    order->limit = 0.0;
+    if (order->maker) {
+        order->limit = price * (1.0 + (buy ? -1.0 : 1.0) * params->spread_bps * 0.5e-4);
+        if (params->maker_timeout_ms > 0) order->expires_ms = order->due_ms + params->maker_timeout_ms;
+    }
     
+    settle_order(manager, bot, price);
+}
+
+
+/* Offers price to the bot's pending order. Returns true if it filled or
+ * was cancelled. */
+bool bot_on_price(BotManager *manager, int bot_index, double price) {
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (!bot || !bot->order.pending || !manager->execution) return false;
     
-    char upper_symbol[MAX_SYMBOL_LEN];
-    strncpy(upper_symbol, pair->symbol, MAX_SYMBOL_LEN);
-    for (int i = 0; upper_symbol[i]; i++) {
-        upper_symbol[i] = toupper((unsigned char)upper_symbol[i]);
-    }
+    return settle_order(manager, bot, price);
+}
+
+
+/* Routing slot for symbol, matched case-insensitively, or -1 when no bot trades it. */
+int bot_manager_route(const BotManager *manager, const char *symbol) {
+    if (!manager || !symbol || !symbol[0] || manager->route_capacity == 0) return -1;
     
-    char upper_bot_symbol[MAX_SYMBOL_LEN];
-    strncpy(upper_bot_symbol, bot->symbol, MAX_SYMBOL_LEN);
-    for (int i = 0; upper_bot_symbol[i]; i++) {
-        upper_bot_symbol[i] = toupper((unsigned char)upper_bot_symbol[i]);
+    int slot = find_route_slot(manager->routes, manager->route_capacity, symbol);
+    return manager->routes[slot].symbol[0] ? slot : -1;
+}
+
+
+static int pair_route(const BotManager *manager, TradingPair *pair) {
+    if (pair->bot_route_generation != manager->route_generation) {
+        pair->bot_route = bot_manager_route(manager, pair->symbol);
+        pair->bot_route_generation = manager->route_generation;
+    }
+    return pair->bot_route;
+}
+
+
+/* Hands pair's signal to the running bots trading its symbol. The route is
+ * looked up once per manager generation and cached on the pair, so a
+ * steady-state dispatch touches only that symbol's bots. Returns the number
+ * of bots the signal went to. */
+int bot_dispatch_signal(BotManager *manager, TradingPair *pair) {
+    if (!manager || !pair) return 0;
+    
+    int route = pair_route(manager, pair);
+    if (route < 0) return 0;
+    
+    int dispatched = 0;
+    for (int i = manager->routes[route].first_bot; i >= 0; ) {
+        const ScalpingBot *bot = bot_manager_get(manager, i);
+        int next = bot->next_subscriber;
+        if (bot->status == BOT_RUNNING) {
+            bot_process_signal(manager, i, pair);
+            dispatched++;
+        }
+        i = next;
     }
+    return dispatched;
+}
+
+
+void bot_mark_to_market(BotManager *manager, int bot_index, double price) {
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (!bot || price <= 0) return;
     
-    if (strcmp(upper_symbol, upper_bot_symbol) != 0) return;
+    mark_equity(manager, bot, price);
+}
+
+
+/* Marks every bot trading pair's symbol to its current price, offers
+ * the price to their pending orders and passes it to the running bots'
+ * on_tick. Returns the number of orders that filled or were cancelled. */
+int bot_dispatch_price(BotManager *manager, TradingPair *pair) {
+    if (!manager || !pair || pair->current_price <= 0) return 0;
+    
+    int route = pair_route(manager, pair);
+    if (route < 0) return 0;
+    
+    int settled = 0;
+    for (int i = manager->routes[route].first_bot; i >= 0; ) {
+        ScalpingBot *bot = bot_manager_get(manager, i);
+        int next = bot->next_subscriber;
+        if (bot->order.pending && manager->execution && settle_order(manager, bot, pair->current_price)) {
+            settled++;
+        }
+        mark_equity(manager, bot, pair->current_price);
+        if (bot->status == BOT_RUNNING && bot->strategy->on_tick) {
+            bot_process_tick(manager, i, pair);
+        }
+        i = next;
+    }
+    return settled;
+}
+
+
+/* The caller has matched the bot to pair, normally via bot_dispatch_signal. */
+void bot_process_signal(BotManager *manager, int bot_index, const TradingPair *pair) {
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (!bot || !pair) return;
     
     
-    if (!pair->historical_5m_loaded || pair->current_price <= 0) {
-        printf("Warning: Bot %s waiting for data (5m loaded: %d, price: %.2f)\n", 
-               bot->symbol, pair->historical_5m_loaded, pair->current_price);
-        return;
-    }
+    if (bot->status != BOT_RUNNING) return;
     
     
-    time_t now = time(NULL);
-    if (bot->last_trade_time > 0 && (now - bot->last_trade_time) < 30) {
-        int seconds_left = 30 - (now - bot->last_trade_time);
-        printf("Bot %s in cooldown (%d seconds left)\n", bot->symbol, seconds_left);
+    if (!pair->historical_5m_loaded || pair->current_price <= 0) {
+        bot_log(manager, "Warning: Bot %s waiting for data (5m loaded: %d, price: %.2f)\n", 
+                         bot->symbol, pair->historical_5m_loaded, pair->current_price);
         return;
     }
     
-    const char *signal = pair->scalp_signal;
+    const BotStrategy *strategy = bot->strategy;
+    if (!strategy->on_candle) return;
+    ScalpSignal signal = strategy->on_candle(strategy, bot->strategy_state, bot, pair);
     
-    printf("Bot %s checking signal: '%s' | Position: %.6f | Balance: $%.2f\n",
-           bot->symbol, signal, bot->current_position, bot->current_balance);
-    fflush(stdout);
     
+    if (bot->order.pending && !settle_order(manager, bot, pair->current_price)) return;
     
-    if (strstr(signal, "BUY NOW") != NULL && bot->current_position < 0.0001) {
-        printf("   -> Executing BUY NOW\n");
-        bot_execute_buy(bot, pair->current_price, signal);
-    }
-    else if (strstr(signal, "SELL NOW") != NULL && bot->current_position > 0.0001) {
-        printf("   -> Executing SELL NOW\n");
-        bot_execute_sell(bot, pair->current_price, signal);
-    }
-    else if (strstr(signal, "BUY DIP") != NULL && bot->current_position < 0.0001) {
-        printf("   -> Executing BUY DIP\n");
-        bot_execute_buy(bot, pair->current_price, signal);
-    }
-    else if (strstr(signal, "SELL BOUNCE") != NULL && bot->current_position > 0.0001) {
-        printf("   -> Executing SELL BOUNCE\n");
-        bot_execute_sell(bot, pair->current_price, signal);
-    }
-    else if (strstr(signal, "BUY SIGNAL") != NULL && bot->current_position < 0.0001) {
-        printf("   -> Executing BUY SIGNAL\n");
-        bot_execute_buy(bot, pair->current_price, signal);
-    }
-    else if (strstr(signal, "SELL SIGNAL") != NULL && bot->current_position > 0.0001) {
-        printf("   -> Executing SELL SIGNAL\n");
-        bot_execute_sell(bot, pair->current_price, signal);
+    time_t now = manager_now(manager);
+    if (bot->last_trade_time > 0 && (now - bot->last_trade_time) < bot->cooldown_seconds) {
+        int seconds_left = bot->cooldown_seconds - (int)(now - bot->last_trade_time);
+        bot_log(manager, "Bot %s in cooldown (%d seconds left)\n", bot->symbol, seconds_left);
+        return;
     }
-    else {
-        printf("   -> No action (signal doesn't match or wrong position state)\n");
+    
+    bot_log(manager, "Bot %s checking signal: '%s' | Position: %.6f | Balance: $%.2f\n",
+                     bot->symbol, scalp_signal_text(signal), bot->current_position, bot->current_balance);
+    
+    
+    bool flat = bot->current_position < 0.0001;
+    bool holding = bot->current_position > 0.0001;
+    switch (signal) {
+        case SCALP_BUY_NOW:
+        case SCALP_BUY_DIP:
+        case SCALP_BUY_SIGNAL:
+            if (flat) {
+                bot_log(manager, "   -> Executing %s\n", scalp_signal_text(signal));
+                place_order(manager, bot, true, pair->current_price, signal);
+                return;
+            }
+            break;
+        case SCALP_SELL_NOW:
+        case SCALP_SELL_BOUNCE:
+        case SCALP_SELL_SIGNAL:
+            if (holding) {
+                bot_log(manager, "   -> Executing %s\n", scalp_signal_text(signal));
+                place_order(manager, bot, false, pair->current_price, signal);
+                return;
+            }
+            break;
+        default:
+            break;
     }
+    bot_log(manager, "   -> No action (signal doesn't match or wrong position state)\n");
+}
+
+
+/* Asks the bot's on_tick about pair's current price and acts on the
+ * answer as bot_process_signal would, logging only when it trades. The
+ * caller has matched the bot to pair, normally via bot_dispatch_price. */
+void bot_process_tick(BotManager *manager, int bot_index, const TradingPair *pair) {
+    ScalpingBot *bot = active_bot(manager, bot_index);
+    if (!bot || !pair || bot->status != BOT_RUNNING || pair->current_price <= 0) return;
+    
+    const BotStrategy *strategy = bot->strategy;
+    if (!strategy->on_tick) return;
+    ScalpSignal signal = strategy->on_tick(strategy, bot->strategy_state, bot, pair);
+    if (!(signal & (SCALP_SIDE_BUY | SCALP_SIDE_SELL))) return;
+    
+    if (bot->order.pending && !settle_order(manager, bot, pair->current_price)) return;
+    
+    /* A stop exits at once; everything else waits out the cooldown */
+    time_t now = manager_now(manager);
+    bool stop = (signal == SCALP_SELL_NOW);
+    if (!stop && bot->last_trade_time > 0 && (now - bot->last_trade_time) < bot->cooldown_seconds) return;
+    
+    bool buy = (signal & SCALP_SIDE_BUY) && bot->current_position < 0.0001;
+    bool sell = (signal & SCALP_SIDE_SELL) && bot->current_position > 0.0001;
+    if (!buy && !sell) return;
+    
+    bot_log(manager, "Bot %s tick at $%.2f: executing %s\n", bot->symbol, pair->current_price,
+                     scalp_signal_text(signal));
+    place_order(manager, bot, buy, pair->current_price, signal);
 }
 
 
@@ -387,16 +969,162 @@ double bot_get_roi(const ScalpingBot *bot, double current_price) {
 }
 
 
+/* Trades are journaled as they happen; saving records the settings,
+ * compacts long journals and flushes them to disk. */
 void bot_manager_save(const BotManager *manager) {
     if (!manager) return;
-    printf("Bot manager save: %d active bots\n", manager->bot_count);
     
+    int journaled = 0;
+    for (int n = 0; n < manager->bot_count; n++) {
+        int index = manager->active[n];
+        ScalpingBot *bot = &manager->chunks[index / BOT_CHUNK_SIZE][index % BOT_CHUNK_SIZE];
+        if (!bot->journal) continue;
+        
+        journal_settings(bot);
+        trade_journal_update_marks(bot->journal, bot->peak_equity, bot->max_drawdown);
+        if (trade_journal_count(bot->journal) > BOT_JOURNAL_COMPACT_AT) {
+            trade_journal_compact(bot->journal, MAX_TRADES_HISTORY);
+        }
+        trade_journal_sync(bot->journal);
+        journaled++;
+    }
+    bot_log(manager, "Bot manager save: %d active bots, %d journaled\n", manager->bot_count, journaled);
+}
+
+
+/* Rebuilds a bot from its journal's header and records, refilling the
+ * in-memory history with the newest trades. */
+static int restore_bot(BotManager *manager, TradeJournal *journal) {
+    const JournalHeader *header = trade_journal_header(journal);
+    char symbol[JOURNAL_SYMBOL_LEN];
+    memcpy(symbol, header->symbol, sizeof(symbol));
+    symbol[JOURNAL_SYMBOL_LEN - 1] = '\0';
+    
+    char name[JOURNAL_SYMBOL_LEN];
+    memcpy(name, header->strategy, sizeof(name));
+    name[JOURNAL_SYMBOL_LEN - 1] = '\0';
+    const BotStrategy *strategy = bot_strategy_find(name);
+    if (!strategy) {
+        fprintf(stderr, "Bot journal %s: unknown strategy '%s', using %s\n",
+                trade_journal_path(journal), name, bot_strategy_default()->name);
+        strategy = bot_strategy_default();
+    }
+    
+    int index = add_bot(manager, symbol, header->initial_balance, header->trade_amount, strategy);
+    if (index < 0) return -1;
+    
+    JournalHeader state = *header;
+    int count = trade_journal_count(journal);
+    int history_from = (count > MAX_TRADES_HISTORY) ? count - MAX_TRADES_HISTORY : 0;
+    ScalpingBot *bot = bot_manager_get(manager, index);
+    
+    for (int i = 0; i < count; i++) {
+        const JournalRecord *record = trade_journal_record(journal, i);
+        journal_apply(&state, record);
+        if (i < history_from) continue;
+        
+        bot->current_balance = record->balance_after;
+        record_trade(bot, record->side, (time_t)record->timestamp, record->price, record->quantity,
+                     record->fee, record->total_cost, (ScalpSignal)record->signal);
+    }
+    
+    bot->current_balance = state.current_balance;
+    bot->current_position = state.current_position;
+    bot->avg_buy_price = state.avg_buy_price;
+    bot->total_trades = state.total_trades;
+    bot->winning_trades = state.winning_trades;
+    bot->losing_trades = state.losing_trades;
+    bot->total_profit = state.total_profit;
+    bot->total_fees_paid = state.total_fees_paid;
+    bot->max_drawdown = fmax(state.max_drawdown, header->marked_drawdown);
+    bot->peak_equity = fmax(state.peak_equity, header->marked_peak);
+    /* Valued at the last fill until the next tick marks it */
+    double last_price = (count > 0) ? trade_journal_record(journal, count - 1)->price : state.avg_buy_price;
+    bot->equity = state.current_balance + state.current_position * last_price;
+    bot->last_trade_time = (time_t)state.last_trade_time;
+    bot->created_at = (time_t)header->created_at;
+    bot->cooldown_seconds = header->cooldown_seconds;
+    bot->status = (header->status == BOT_RUNNING || header->status == BOT_PAUSED) ? (BotStatus)header->status : BOT_STOPPED;
+    bot->journal = journal;
+    bot_update_statistics(bot);
+    
+    bot_log(manager, "Bot #%d restored for %s with %d trades\n", index, bot->symbol, bot->total_trades);
+    return index;
+}
+
+
+static int compare_ids(const void *a, const void *b) {
+    int left = *(const int *)a, right = *(const int *)b;
+    return (left > right) - (left < right);
+}
+
+
+/* Restores the bots journaled in dir, oldest first, and journals bots
+ * added from now on there too. Returns false if dir cannot be read. */
+bool bot_manager_load_dir(BotManager *manager, const char *dir) {
+    if (!manager || !dir) return false;
+    
+    mkdir(dir, 0755);
+    DIR *handle = opendir(dir);
+    if (!handle) return false;
+    
+    int *ids = NULL;
+    int id_count = 0, id_capacity = 0;
+    struct dirent *entry;
+    while ((entry = readdir(handle)) != NULL) {
+        int id;
+        char expected[64];
+        if (sscanf(entry->d_name, "bot_%d", &id) != 1) continue;
+        snprintf(expected, sizeof(expected), "bot_%d.journal", id);
+        if (strcmp(entry->d_name, expected) != 0) continue;
+        
+        if (id_count == id_capacity) {
+            int capacity = id_capacity ? id_capacity * 2 : 16;
+            int *grown = realloc(ids, (size_t)capacity * sizeof(int));
+            if (!grown) break;
+            ids = grown;
+            id_capacity = capacity;
+        }
+        ids[id_count++] = id;
+    }
+    closedir(handle);
+    
+    if (id_count > 0) qsort(ids, (size_t)id_count, sizeof(int), compare_ids);
+    
+    free(manager->journal_dir);
+    size_t length = strlen(dir);
+    manager->journal_dir = malloc(length + 1);
+    if (manager->journal_dir) memcpy(manager->journal_dir, dir, length + 1);
+    
+    int restored = 0;
+    for (int i = 0; i < id_count; i++) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/bot_%d.journal", dir, ids[i]);
+        if (ids[i] >= manager->next_journal_id) manager->next_journal_id = ids[i] + 1;
+        
+        TradeJournal *journal = trade_journal_open(path);
+        if (!journal) {
+            fprintf(stderr, "Skipping unreadable bot journal %s\n", path);
+            continue;
+        }
+        if (restore_bot(manager, journal) < 0) {
+            trade_journal_close(journal);
+            continue;
+        }
+        restored++;
+    }
+    free(ids);
+    
+    bot_log(manager, "Bot manager load: %d bots restored from %s\n", restored, dir);
+    return true;
 }
 
 
 bool bot_manager_load(BotManager *manager) {
     if (!manager) return false;
-    printf("Bot manager load\n");
     
-    return true;
+    char *dir = portfolio_get_config_path("bots");
+    bool loaded = dir && bot_manager_load_dir(manager, dir);
+    free(dir);
+    return loaded;
 }
@@ -0,0 +1,701 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/screener.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCREENER_BLOCK 256
+#define SCREENER_MAX_CODE 128
+#define SCREENER_MAX_STACK 16
+#define SCREENER_MAX_NESTING 64
+
+typedef enum {
+    OP_CONST, OP_COLUMN,
+    OP_NEG, OP_ABS, OP_NOT,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MIN, OP_MAX,
+    OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ, OP_NE,
+    OP_AND, OP_OR
+} ScreenerOp;
+
+typedef struct {
+    ScreenerOp op;
+    int column;
+    double value;
+} ScreenerInstr;
+
+struct ScreenerExpr {
+    ScreenerInstr code[SCREENER_MAX_CODE];
+    int length;
+    int depth;
+    int max_depth;
+};
+
+struct ScreenerTable {
+    char names[SCREENER_MAX_COLUMNS][SCREENER_NAME_LEN];
+    double *columns[SCREENER_MAX_COLUMNS];
+    int column_count;
+    
+    char (*symbols)[SCREENER_SYMBOL_LEN];
+    int rows;
+    int capacity;
+    
+    int *index;          /* open addressing, -1 marks a free slot */
+    int index_mask;
+};
+
+
+static unsigned int hash_symbol(const char *symbol) {
+    unsigned int hash = 2166136261u;
+    for (const char *c = symbol; *c; c++) {
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    }
+    return hash;
+}
+
+
+static void index_insert(ScreenerTable *table, int row) {
+    unsigned int slot = hash_symbol(table->symbols[row]) & table->index_mask;
+    while (table->index[slot] >= 0) {
+        slot = (slot + 1) & table->index_mask;
+    }
+    table->index[slot] = row;
+}
+
+
+static bool reserve(ScreenerTable *table, int capacity) {
+    if (capacity <= table->capacity) return true;
+    
+    char (*symbols)[SCREENER_SYMBOL_LEN] = realloc(table->symbols, capacity * sizeof(*symbols));
+    if (!symbols) return false;
+    table->symbols = symbols;
+    
+    for (int c = 0; c < table->column_count; c++) {
+        double *column = realloc(table->columns[c], capacity * sizeof(double));
+        if (!column) return false;
+        table->columns[c] = column;
+    }
+    
+    int index_size = 1;
+    while (index_size < 2 * capacity) index_size <<= 1;
+    int *index = malloc(index_size * sizeof(int));
+    if (!index) return false;
+    free(table->index);
+    table->index = index;
+    table->index_mask = index_size - 1;
+    table->capacity = capacity;
+    
+    memset(table->index, 0xff, index_size * sizeof(int));
+    for (int r = 0; r < table->rows; r++) {
+        index_insert(table, r);
+    }
+    return true;
+}
+
+
+ScreenerTable* screener_table_create(int capacity) {
+    ScreenerTable *table = calloc(1, sizeof(ScreenerTable));
+    if (!table) {
+        return NULL;
+    }
+    
+    if (!reserve(table, (capacity > 16) ? capacity : 16)) {
+        screener_table_destroy(table);
+        return NULL;
+    }
+    return table;
+}
+
+
+void screener_table_destroy(ScreenerTable *table) {
+    if (!table) return;
+    
+    for (int c = 0; c < table->column_count; c++) {
+        free(table->columns[c]);
+    }
+    free(table->symbols);
+    free(table->index);
+    free(table);
+}
+
+
+void screener_table_clear(ScreenerTable *table) {
+    if (!table) return;
+    
+    table->rows = 0;
+    memset(table->index, 0xff, (table->index_mask + 1) * sizeof(int));
+}
+
+
+int screener_table_find_column(const ScreenerTable *table, const char *name) {
+    if (!table || !name) return -1;
+    
+    for (int c = 0; c < table->column_count; c++) {
+        if (strcmp(table->names[c], name) == 0) return c;
+    }
+    return -1;
+}
+
+
+int screener_table_column(ScreenerTable *table, const char *name) {
+    if (!table || !name || !name[0] || strlen(name) >= SCREENER_NAME_LEN) return -1;
+    
+    int column = screener_table_find_column(table, name);
+    if (column >= 0) return column;
+    if (table->column_count >= SCREENER_MAX_COLUMNS) return -1;
+    
+    double *values = malloc(table->capacity * sizeof(double));
+    if (!values) return -1;
+    for (int r = 0; r < table->rows; r++) {
+        values[r] = NAN;
+    }
+    
+    column = table->column_count++;
+    strcpy(table->names[column], name);
+    table->columns[column] = values;
+    return column;
+}
+
+
+int screener_table_find_row(const ScreenerTable *table, const char *symbol) {
+    if (!table || !symbol) return -1;
+    
+    unsigned int slot = hash_symbol(symbol) & table->index_mask;
+    while (table->index[slot] >= 0) {
+        int row = table->index[slot];
+        if (strncmp(table->symbols[row], symbol, SCREENER_SYMBOL_LEN - 1) == 0) return row;
+        slot = (slot + 1) & table->index_mask;
+    }
+    return -1;
+}
+
+
+int screener_table_row(ScreenerTable *table, const char *symbol) {
+    if (!table || !symbol || !symbol[0]) return -1;
+    
+    char key[SCREENER_SYMBOL_LEN];
+    strncpy(key, symbol, SCREENER_SYMBOL_LEN - 1);
+    key[SCREENER_SYMBOL_LEN - 1] = '\0';
+    
+    int row = screener_table_find_row(table, key);
+    if (row >= 0) return row;
+    if (table->rows == table->capacity && !reserve(table, table->capacity * 2)) return -1;
+    
+    row = table->rows++;
+    memcpy(table->symbols[row], key, SCREENER_SYMBOL_LEN);
+    for (int c = 0; c < table->column_count; c++) {
+        table->columns[c][row] = NAN;
+    }
+    index_insert(table, row);
+    return row;
+}
+
+
+int screener_table_rows(const ScreenerTable *table) {
+    return table ? table->rows : 0;
+}
+
+
+const char* screener_table_symbol(const ScreenerTable *table, int row) {
+    if (!table || row < 0 || row >= table->rows) return NULL;
+    return table->symbols[row];
+}
+
+
+const char* screener_table_column_name(const ScreenerTable *table, int column) {
+    if (!table || column < 0 || column >= table->column_count) return NULL;
+    return table->names[column];
+}
+
+
+void screener_table_set(ScreenerTable *table, int row, int column, double value) {
+    if (!table || row < 0 || row >= table->rows || column < 0 || column >= table->column_count) return;
+    table->columns[column][row] = value;
+}
+
+
+double screener_table_get(const ScreenerTable *table, int row, int column) {
+    if (!table || row < 0 || row >= table->rows || column < 0 || column >= table->column_count) return NAN;
+    return table->columns[column][row];
+}
+
+
+static bool truthy(double x) {
+    return x != 0.0 && x == x;
+}
+
+
+/* A missing cell makes a test unknown (NaN) rather than false, and !
+ * keeps it unknown, so negating a test on a missing column still fails.
+ * && and || resolve an unknown side when the other decides the result. */
+static double tested(bool result, double a, double b) {
+    return (a != a || b != b) ? NAN : result;
+}
+
+
+static double logical_not(double x) {
+    return (x == x) ? (x == 0.0) : x;
+}
+
+
+static double logical_and(double a, double b) {
+    if ((a == 0.0) || (b == 0.0)) return 0.0;
+    return (a != a || b != b) ? NAN : 1.0;
+}
+
+
+static double logical_or(double a, double b) {
+    if (truthy(a) || truthy(b)) return 1.0;
+    return (a != a || b != b) ? NAN : 0.0;
+}
+
+
+static double apply(ScreenerOp op, double a, double b) {
+    switch (op) {
+        case OP_NEG: return -a;
+        case OP_ABS: return fabs(a);
+        case OP_NOT: return logical_not(a);
+        case OP_ADD: return a + b;
+        case OP_SUB: return a - b;
+        case OP_MUL: return a * b;
+        case OP_DIV: return a / b;
+        case OP_MIN: return (a < b) ? a : b;
+        case OP_MAX: return (a > b) ? a : b;
+        case OP_LT: return tested(a < b, a, b);
+        case OP_LE: return tested(a <= b, a, b);
+        case OP_GT: return tested(a > b, a, b);
+        case OP_GE: return tested(a >= b, a, b);
+        case OP_EQ: return tested(a == b, a, b);
+        case OP_NE: return tested(a != b, a, b);
+        case OP_AND: return logical_and(a, b);
+        case OP_OR: return logical_or(a, b);
+        default: return NAN;
+    }
+}
+
+
+typedef struct {
+    const ScreenerTable *table;
+    const char *source;
+    const char *at;
+    ScreenerExpr *expr;
+    int nesting;
+    char *error;
+    size_t error_size;
+    bool failed;
+} Parser;
+
+
+static void fail(Parser *p, const char *format, ...) {
+    if (p->failed) return;
+    p->failed = true;
+    if (!p->error || p->error_size == 0) return;
+    
+    char message[96];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    snprintf(p->error, p->error_size, "%s at offset %d", message, (int)(p->at - p->source));
+}
+
+
+/* Appends an instruction, folding operators whose operands are all
+ * constants. */
+static void emit(Parser *p, ScreenerOp op, int column, double value) {
+    if (p->failed) return;
+    ScreenerExpr *expr = p->expr;
+    ScreenerInstr *code = expr->code;
+    
+    bool unary = (op == OP_NEG || op == OP_ABS || op == OP_NOT);
+    bool binary = (op >= OP_ADD);
+    int n = expr->length;
+    
+    if (unary && n >= 1 && code[n - 1].op == OP_CONST) {
+        code[n - 1].value = apply(op, code[n - 1].value, 0.0);
+        return;
+    }
+    if (binary && n >= 2 && code[n - 1].op == OP_CONST && code[n - 2].op == OP_CONST) {
+        code[n - 2].value = apply(op, code[n - 2].value, code[n - 1].value);
+        expr->length--;
+        expr->depth--;
+        return;
+    }
+    
+    if (n >= SCREENER_MAX_CODE) {
+        fail(p, "expression too long");
+        return;
+    }
+    code[n].op = op;
+    code[n].column = column;
+    code[n].value = value;
+    expr->length++;
+    
+    if (op == OP_CONST || op == OP_COLUMN) expr->depth++;
+    else if (binary) expr->depth--;
+    if (expr->depth > expr->max_depth) expr->max_depth = expr->depth;
+    if (expr->max_depth > SCREENER_MAX_STACK) fail(p, "expression too deep");
+}
+
+
+static void skip_space(Parser *p) {
+    while (isspace((unsigned char)*p->at)) p->at++;
+}
+
+
+static bool accept(Parser *p, const char *token) {
+    skip_space(p);
+    size_t length = strlen(token);
+    if (strncmp(p->at, token, length) != 0) return false;
+    p->at += length;
+    return true;
+}
+
+
+static void parse_or(Parser *p);
+
+
+static void parse_primary(Parser *p) {
+    skip_space(p);
+    char c = *p->at;
+    
+    if (c == '(') {
+        p->at++;
+        parse_or(p);
+        if (!accept(p, ")")) fail(p, "expected ')'");
+        return;
+    }
+    
+    if (isdigit((unsigned char)c) || c == '.') {
+        char *end = NULL;
+        double value = strtod(p->at, &end);
+        if (end == p->at) {
+            fail(p, "bad number");
+            return;
+        }
+        p->at = end;
+        emit(p, OP_CONST, 0, value);
+        return;
+    }
+    
+    if (isalpha((unsigned char)c) || c == '_') {
+        char name[SCREENER_NAME_LEN];
+        size_t length = 0;
+        while (isalnum((unsigned char)p->at[length]) || p->at[length] == '_') length++;
+        if (length >= SCREENER_NAME_LEN) {
+            fail(p, "name too long");
+            return;
+        }
+        memcpy(name, p->at, length);
+        name[length] = '\0';
+        p->at += length;
+        
+        if (accept(p, "(")) {
+            ScreenerOp op;
+            int args;
+            if (strcmp(name, "abs") == 0) { op = OP_ABS; args = 1; }
+            else if (strcmp(name, "min") == 0) { op = OP_MIN; args = 2; }
+            else if (strcmp(name, "max") == 0) { op = OP_MAX; args = 2; }
+            else {
+                fail(p, "unknown function '%s'", name);
+                return;
+            }
+            
+            parse_or(p);
+            if (args == 2) {
+                if (!accept(p, ",")) fail(p, "expected ','");
+                parse_or(p);
+            }
+            if (!accept(p, ")")) fail(p, "expected ')'");
+            emit(p, op, 0, 0.0);
+            return;
+        }
+        
+        int column = screener_table_find_column(p->table, name);
+        if (column < 0) {
+            fail(p, "unknown column '%s'", name);
+            return;
+        }
+        emit(p, OP_COLUMN, column, 0.0);
+        return;
+    }
+    
+    fail(p, c ? "unexpected '%c'" : "unexpected end", c);
+}
+
+
+static void parse_unary(Parser *p) {
+    if (accept(p, "-")) {
+        parse_unary(p);
+        emit(p, OP_NEG, 0, 0.0);
+    } else if (accept(p, "+")) {
+        parse_unary(p);
+    } else {
+        parse_primary(p);
+    }
+}
+
+
+static void parse_term(Parser *p) {
+    parse_unary(p);
+    while (!p->failed) {
+        if (accept(p, "*")) { parse_unary(p); emit(p, OP_MUL, 0, 0.0); }
+        else if (accept(p, "/")) { parse_unary(p); emit(p, OP_DIV, 0, 0.0); }
+        else break;
+    }
+}
+
+
+static void parse_sum(Parser *p) {
+    parse_term(p);
+    while (!p->failed) {
+        if (accept(p, "+")) { parse_term(p); emit(p, OP_ADD, 0, 0.0); }
+        else if (accept(p, "-")) { parse_term(p); emit(p, OP_SUB, 0, 0.0); }
+        else break;
+    }
+}
+
+
+static void parse_compare(Parser *p) {
+    static const struct { const char *token; ScreenerOp op; } comparisons[] = {
+        { "<=", OP_LE }, { ">=", OP_GE }, { "==", OP_EQ }, { "!=", OP_NE }, { "<", OP_LT }, { ">", OP_GT }
+    };
+    
+    parse_sum(p);
+    for (size_t i = 0; i < sizeof(comparisons) / sizeof(comparisons[0]); i++) {
+        if (accept(p, comparisons[i].token)) {
+            parse_sum(p);
+            emit(p, comparisons[i].op, 0, 0.0);
+            return;
+        }
+    }
+}
+
+
+static void parse_not(Parser *p) {
+    skip_space(p);
+    if (p->at[0] == '!' && p->at[1] != '=') {
+        p->at++;
+        parse_not(p);
+        emit(p, OP_NOT, 0, 0.0);
+    } else {
+        parse_compare(p);
+    }
+}
+
+
+static void parse_and(Parser *p) {
+    parse_not(p);
+    while (!p->failed && accept(p, "&&")) {
+        parse_not(p);
+        emit(p, OP_AND, 0, 0.0);
+    }
+}
+
+
+static void parse_or(Parser *p) {
+    if (++p->nesting > SCREENER_MAX_NESTING) {
+        fail(p, "expression nested too deeply");
+        return;
+    }
+    
+    parse_and(p);
+    while (!p->failed && accept(p, "||")) {
+        parse_and(p);
+        emit(p, OP_OR, 0, 0.0);
+    }
+    p->nesting--;
+}
+
+
+ScreenerExpr* screener_compile(const ScreenerTable *table, const char *source, char *error, size_t error_size) {
+    if (error && error_size > 0) error[0] = '\0';
+    if (!table || !source) return NULL;
+    
+    ScreenerExpr *expr = calloc(1, sizeof(ScreenerExpr));
+    if (!expr) {
+        return NULL;
+    }
+    
+    Parser parser = { table, source, source, expr, 0, error, error_size, false };
+    parse_or(&parser);
+    skip_space(&parser);
+    if (!parser.failed && *parser.at) {
+        fail(&parser, "unexpected '%c'", *parser.at);
+    }
+    
+    if (parser.failed) {
+        free(expr);
+        return NULL;
+    }
+    return expr;
+}
+
+
+void screener_expr_destroy(ScreenerExpr *expr) {
+    free(expr);
+}
+
+
+/* Distinct columns the expression reads, in first-use order. */
+int screener_expr_columns(const ScreenerExpr *expr, int *columns, int max_columns) {
+    if (!expr || !columns) return 0;
+    
+    int count = 0;
+    for (int k = 0; k < expr->length && count < max_columns; k++) {
+        if (expr->code[k].op != OP_COLUMN) continue;
+        
+        bool seen = false;
+        for (int i = 0; i < count && !seen; i++) {
+            seen = (columns[i] == expr->code[k].column);
+        }
+        if (!seen) columns[count++] = expr->code[k].column;
+    }
+    return count;
+}
+
+
+double screener_eval(const ScreenerExpr *expr, const ScreenerTable *table, int row) {
+    if (!expr || !table || row < 0 || row >= table->rows) return NAN;
+    
+    double stack[SCREENER_MAX_STACK];
+    int top = -1;
+    for (int k = 0; k < expr->length; k++) {
+        const ScreenerInstr *in = &expr->code[k];
+        switch (in->op) {
+            case OP_CONST: stack[++top] = in->value; break;
+            case OP_COLUMN: stack[++top] = table->columns[in->column][row]; break;
+            case OP_NEG:
+            case OP_ABS:
+            case OP_NOT: stack[top] = apply(in->op, stack[top], 0.0); break;
+            default:
+                stack[top - 1] = apply(in->op, stack[top - 1], stack[top]);
+                top--;
+                break;
+        }
+    }
+    return stack[0];
+}
+
+
+/* Runs the program over rows [start, start + n); the result is left in
+ * stack[0]. Every instruction is a straight loop over the block, so the
+ * dispatch cost is paid once per block rather than once per row. */
+static void eval_block(const ScreenerExpr *expr, const ScreenerTable *table, int start, int n,
+                       double (*stack)[SCREENER_BLOCK]) {
+    int top = -1;
+    
+    for (int k = 0; k < expr->length; k++) {
+        const ScreenerInstr *in = &expr->code[k];
+        double *a = stack[top > 0 ? top - 1 : 0];
+        double *b = stack[top > 0 ? top : 0];
+        
+        switch (in->op) {
+            case OP_CONST:
+                top++;
+                for (int i = 0; i < n; i++) stack[top][i] = in->value;
+                continue;
+            case OP_COLUMN:
+                top++;
+                memcpy(stack[top], table->columns[in->column] + start, n * sizeof(double));
+                continue;
+            case OP_NEG: for (int i = 0; i < n; i++) b[i] = -b[i]; continue;
+            case OP_ABS: for (int i = 0; i < n; i++) b[i] = fabs(b[i]); continue;
+            case OP_NOT: for (int i = 0; i < n; i++) b[i] = logical_not(b[i]); continue;
+            case OP_ADD: for (int i = 0; i < n; i++) a[i] += b[i]; break;
+            case OP_SUB: for (int i = 0; i < n; i++) a[i] -= b[i]; break;
+            case OP_MUL: for (int i = 0; i < n; i++) a[i] *= b[i]; break;
+            case OP_DIV: for (int i = 0; i < n; i++) a[i] /= b[i]; break;
+            case OP_MIN: for (int i = 0; i < n; i++) a[i] = (a[i] < b[i]) ? a[i] : b[i]; break;
+            case OP_MAX: for (int i = 0; i < n; i++) a[i] = (a[i] > b[i]) ? a[i] : b[i]; break;
+            case OP_LT: for (int i = 0; i < n; i++) a[i] = tested(a[i] < b[i], a[i], b[i]); break;
+            case OP_LE: for (int i = 0; i < n; i++) a[i] = tested(a[i] <= b[i], a[i], b[i]); break;
+            case OP_GT: for (int i = 0; i < n; i++) a[i] = tested(a[i] > b[i], a[i], b[i]); break;
+            case OP_GE: for (int i = 0; i < n; i++) a[i] = tested(a[i] >= b[i], a[i], b[i]); break;
+            case OP_EQ: for (int i = 0; i < n; i++) a[i] = tested(a[i] == b[i], a[i], b[i]); break;
+            default:
+                for (int i = 0; i < n; i++) a[i] = apply(in->op, a[i], b[i]);
+                break;
+        }
+        top--;
+    }
+}
+
+
+static int compare_matches(const void *left, const void *right) {
+    const ScreenerMatch *a = left;
+    const ScreenerMatch *b = right;
+    bool a_nan = isnan(a->rank);
+    bool b_nan = isnan(b->rank);
+    
+    if (a_nan != b_nan) return a_nan ? 1 : -1;
+    if (!a_nan && a->rank != b->rank) return (a->rank > b->rank) ? -1 : 1;
+    return a->row - b->row;
+}
+
+
+int screener_run(const ScreenerTable *table, const ScreenerExpr *filter, const ScreenerExpr *rank,
+                 ScreenerMatch *matches, int max_matches) {
+    if (!table || !filter || !matches || max_matches <= 0) return 0;
+    
+    double (*stack)[SCREENER_BLOCK] = malloc(SCREENER_MAX_STACK * sizeof(*stack));
+    ScreenerMatch *found = rank ? malloc((table->rows > 0 ? table->rows : 1) * sizeof(ScreenerMatch)) : matches;
+    if (!stack || !found) {
+        free(stack);
+        if (found != matches) free(found);
+        return 0;
+    }
+    
+    int capacity = rank ? table->rows : max_matches;
+    int count = 0;
+    int selected[SCREENER_BLOCK];
+    
+    for (int start = 0; start < table->rows && count < capacity; start += SCREENER_BLOCK) {
+        int n = table->rows - start;
+        if (n > SCREENER_BLOCK) n = SCREENER_BLOCK;
+        
+        eval_block(filter, table, start, n, stack);
+        int hits = 0;
+        for (int i = 0; i < n; i++) {
+            if (truthy(stack[0][i])) selected[hits++] = i;
+        }
+        if (hits == 0) continue;
+        
+        if (rank) eval_block(rank, table, start, n, stack);
+        for (int h = 0; h < hits && count < capacity; h++) {
+            found[count].row = start + selected[h];
+            found[count].rank = rank ? stack[0][selected[h]] : 0.0;
+            count++;
+        }
+    }
+    free(stack);
+    
+    if (rank) {
+        qsort(found, count, sizeof(ScreenerMatch), compare_matches);
+        if (count > max_matches) count = max_matches;
+        memcpy(matches, found, count * sizeof(ScreenerMatch));
+        free(found);
+    }
+    return count;
+}
@@ -0,0 +1,232 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/sweep.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+typedef struct {
+    const char *symbol;
+    const Candle *candles;
+    int count;
+    double initial_balance;
+    const ExecutionModel *execution;
+    const BotStrategy *strategy;
+    SweepResult *result;
+} SweepTask;
+
+
+void sweep_space_default(SweepSpace *space) {
+    if (!space) return;
+    
+    memset(space, 0, sizeof(*space));
+    
+    BacktestConfig config;
+    backtest_config_default(&config);
+    const double defaults[SWEEP_PARAM_COUNT] = {
+        config.params.weak_move, config.params.strong_move, config.params.flat_move,
+        config.params.rsi_overbought, config.params.rsi_oversold,
+        config.params.rsi_dip, config.params.rsi_bounce,
+        config.cooldown_seconds, config.trade_amount
+    };
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+        sweep_set_range(space, p, defaults[p], defaults[p], 1);
+    }
+    space->initial_balance = config.initial_balance;
+    space->seed = 1;
+    space->execution = NULL;
+    space->strategy = NULL;
+}
+
+
+void sweep_set_range(SweepSpace *space, SweepParam param, double min, double max, int steps) {
+    if (!space || param < 0 || param >= SWEEP_PARAM_COUNT) return;
+    
+    space->ranges[param].min = min;
+    space->ranges[param].max = max;
+    space->ranges[param].steps = (steps > 1) ? steps : 1;
+}
+
+
+/* Saturates at LONG_MAX rather than overflowing on a large grid. */
+long sweep_size(const SweepSpace *space) {
+    if (!space) return 0;
+    if (space->samples > 0) return space->samples;
+    
+    long size = 1;
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+        int steps = space->ranges[p].steps;
+        if (steps > 1 && size > LONG_MAX / steps) return LONG_MAX;
+        size *= steps;
+    }
+    return size;
+}
+
+
+const char* sweep_param_name(SweepParam param) {
+    switch (param) {
+        case SWEEP_WEAK_MOVE: return "weak_move";
+        case SWEEP_STRONG_MOVE: return "strong_move";
+        case SWEEP_FLAT_MOVE: return "flat_move";
+        case SWEEP_RSI_OVERBOUGHT: return "rsi_overbought";
+        case SWEEP_RSI_OVERSOLD: return "rsi_oversold";
+        case SWEEP_RSI_DIP: return "rsi_dip";
+        case SWEEP_RSI_BOUNCE: return "rsi_bounce";
+        case SWEEP_COOLDOWN: return "cooldown";
+        case SWEEP_TRADE_AMOUNT: return "trade_amount";
+        default: return "unknown";
+    }
+}
+
+
+void sweep_config(const double *values, double initial_balance, BacktestConfig *config) {
+    if (!values || !config) return;
+    
+    backtest_config_default(config);
+    config->initial_balance = initial_balance;
+    config->params.weak_move = values[SWEEP_WEAK_MOVE];
+    config->params.strong_move = values[SWEEP_STRONG_MOVE];
+    config->params.flat_move = values[SWEEP_FLAT_MOVE];
+    config->params.rsi_overbought = values[SWEEP_RSI_OVERBOUGHT];
+    config->params.rsi_oversold = values[SWEEP_RSI_OVERSOLD];
+    config->params.rsi_dip = values[SWEEP_RSI_DIP];
+    config->params.rsi_bounce = values[SWEEP_RSI_BOUNCE];
+    config->cooldown_seconds = (int)(values[SWEEP_COOLDOWN] + 0.5);
+    config->trade_amount = values[SWEEP_TRADE_AMOUNT];
+    /* Only the summary metrics are kept, so skip the curve. */
+    config->equity_stride = 1 << 30;
+}
+
+
+/* xorshift32; seed 0 is remapped since it is a fixed point. */
+static double next_uniform(unsigned int *state) {
+    unsigned int x = *state ? *state : 2463534242u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (x >> 8) / 16777216.0;
+}
+
+
+static void fill_values(const SweepSpace *space, long index, unsigned int *state, double *values) {
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+        const SweepRange *range = &space->ranges[p];
+        double span = range->max - range->min;
+        
+        if (space->samples > 0) {
+            values[p] = (range->steps > 1) ? range->min + span * next_uniform(state) : range->min;
+        } else {
+            int step = (int)(index % range->steps);
+            index /= range->steps;
+            values[p] = (range->steps > 1) ? range->min + span * step / (range->steps - 1) : range->min;
+        }
+    }
+}
+
+
+static void run_task(void *arg) {
+    SweepTask *task = arg;
+    SweepResult *result = task->result;
+    
+    BacktestConfig config;
+    sweep_config(result->values, task->initial_balance, &config);
+    config.execution = task->execution;
+    config.strategy = task->strategy;
+    
+    BacktestResult backtest;
+    result->ok = backtest_run(&config, task->symbol, task->candles, task->count, &backtest);
+    if (!result->ok) return;
+    
+    result->roi = backtest.roi;
+    result->max_drawdown = backtest.max_drawdown;
+    result->sharpe = backtest.sharpe;
+    result->total_trades = backtest.total_trades;
+    backtest_result_free(&backtest);
+}
+
+
+int sweep_run(WorkerPool *pool, const SweepSpace *space, const char *symbol,
+              const Candle *candles, int count, SweepResult *results, int max_results) {
+    if (!space || !symbol || !candles || count <= 0 || !results || max_results <= 0) return 0;
+    
+    long size = sweep_size(space);
+    int total = (size < max_results) ? (int)size : max_results;
+    if (total <= 0) return 0;
+    
+    SweepTask *tasks = malloc((size_t)total * sizeof(SweepTask));
+    if (!tasks) return 0;
+    
+    unsigned int state = space->seed;
+    for (int i = 0; i < total; i++) {
+        memset(&results[i], 0, sizeof(results[i]));
+        fill_values(space, i, &state, results[i].values);
+        
+        tasks[i].symbol = symbol;
+        tasks[i].candles = candles;
+        tasks[i].count = count;
+        tasks[i].initial_balance = space->initial_balance;
+        tasks[i].execution = space->execution;
+        tasks[i].strategy = space->strategy;
+        tasks[i].result = &results[i];
+    }
+    
+    /* Workers claim one configuration at a time from a shared cursor, so
+     * long and short runs balance across threads without static shards. */
+    worker_pool_run(pool, run_task, tasks, sizeof(SweepTask), total);
+    
+    free(tasks);
+    return total;
+}
+
+
+static int compare_roi(const void *a, const void *b) {
+    const SweepResult *x = a, *y = b;
+    if (x->ok != y->ok) return x->ok ? -1 : 1;
+    return (x->roi < y->roi) - (x->roi > y->roi);
+}
+
+
+static int compare_drawdown(const void *a, const void *b) {
+    const SweepResult *x = a, *y = b;
+    if (x->ok != y->ok) return x->ok ? -1 : 1;
+    if (x->max_drawdown != y->max_drawdown) {
+        return (x->max_drawdown > y->max_drawdown) - (x->max_drawdown < y->max_drawdown);
+    }
+    return (x->roi < y->roi) - (x->roi > y->roi);
+}
+
+
+static int compare_sharpe(const void *a, const void *b) {
+    const SweepResult *x = a, *y = b;
+    if (x->ok != y->ok) return x->ok ? -1 : 1;
+    return (x->sharpe < y->sharpe) - (x->sharpe > y->sharpe);
+}
+
+
+void sweep_rank(SweepResult *results, int count, SweepRank rank) {
+    if (!results || count <= 1) return;
+    
+    int (*compare)(const void *, const void *) = compare_roi;
+    if (rank == SWEEP_RANK_DRAWDOWN) compare = compare_drawdown;
+    if (rank == SWEEP_RANK_SHARPE) compare = compare_sharpe;
+    qsort(results, (size_t)count, sizeof(SweepResult), compare);
+}
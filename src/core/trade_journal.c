@@ -0,0 +1,454 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "portfolio/trade_journal.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define RECORD_SIZE sizeof(JournalRecord)
+
+struct TradeJournal {
+    char *path;
+    char *map;              /* header slots followed by capacity records */
+    size_t map_size;
+    int capacity;
+    int count;
+    int slot;               /* header slot in use */
+};
+
+
+/* FNV-1a over 64-bit words with a 32-bit tail, folded to 32 bits; size
+ * is a multiple of four. */
+static unsigned int checksum(const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    unsigned long long hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        memcpy(&word, bytes + i, 8);
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    if (i < size) {
+        unsigned int tail;
+        memcpy(&tail, bytes + i, 4);
+        hash ^= tail;
+        hash *= 1099511628211ull;
+    }
+    return (unsigned int)(hash ^ (hash >> 32));
+}
+
+
+static unsigned int header_checksum(const JournalHeader *header) {
+    return checksum(header, offsetof(JournalHeader, checksum));
+}
+
+
+static unsigned int record_checksum(const JournalRecord *record) {
+    return checksum(record, offsetof(JournalRecord, checksum));
+}
+
+
+static JournalHeader* header_slot(char *map, int slot) {
+    return (JournalHeader *)(map + (size_t)slot * JOURNAL_HEADER_SLOT);
+}
+
+
+static JournalHeader* header_of(const TradeJournal *journal) {
+    return header_slot(journal->map, journal->slot);
+}
+
+
+static bool header_valid(const JournalHeader *header) {
+    return memcmp(header->magic, JOURNAL_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == JOURNAL_VERSION && header->record_size == RECORD_SIZE &&
+           header->checksum == header_checksum(header);
+}
+
+
+/* Stores header in slot 0 of a fresh map and clears slot 1. */
+static void write_first_header(char *map, const JournalHeader *header) {
+    JournalHeader *mapped = header_slot(map, 0);
+    *mapped = *header;
+    mapped->generation = 0;
+    mapped->checksum = header_checksum(mapped);
+    memset(header_slot(map, 1), 0, JOURNAL_HEADER_SLOT);
+}
+
+
+/* Writes next into the slot not in use and switches to it once it is
+ * complete; until then the current slot stays the newest valid one. */
+static void write_next_header(TradeJournal *journal, const JournalHeader *next) {
+    int slot = 1 - journal->slot;
+    JournalHeader *mapped = header_slot(journal->map, slot);
+    *mapped = *next;
+    mapped->generation = header_of(journal)->generation + 1;
+    mapped->checksum = header_checksum(mapped);
+    journal->slot = slot;
+}
+
+
+static JournalRecord* records_of(const TradeJournal *journal) {
+    return (JournalRecord *)(journal->map + JOURNAL_HEADER_SIZE);
+}
+
+
+static size_t file_size(int capacity) {
+    return JOURNAL_HEADER_SIZE + (size_t)capacity * RECORD_SIZE;
+}
+
+
+/* Maps path read-write at size bytes, resizing the file first when
+ * resize is set. The descriptor is not kept; the mapping outlives it. */
+static char* map_file(const char *path, size_t size, int flags, bool resize) {
+    int fd = open(path, O_RDWR | flags, 0644);
+    if (fd < 0) return NULL;
+    
+    if (resize && ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return NULL;
+    }
+    
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return (map == MAP_FAILED) ? NULL : map;
+}
+
+
+static char* copy_path(const char *path, const char *suffix) {
+    size_t length = strlen(path);
+    size_t extra = suffix ? strlen(suffix) : 0;
+    char *copy = malloc(length + extra + 1);
+    if (!copy) return NULL;
+    
+    memcpy(copy, path, length);
+    if (suffix) memcpy(copy + length, suffix, extra);
+    copy[length + extra] = '\0';
+    return copy;
+}
+
+
+void journal_header_init(JournalHeader *header, const char *symbol, double initial_balance,
+                         double trade_amount, long long created_at) {
+    if (!header) return;
+    
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, JOURNAL_MAGIC, sizeof(header->magic));
+    header->version = JOURNAL_VERSION;
+    header->record_size = RECORD_SIZE;
+    if (symbol) {
+        memcpy(header->symbol, symbol, strnlen(symbol, JOURNAL_SYMBOL_LEN - 1));
+    }
+    header->initial_balance = initial_balance;
+    header->trade_amount = trade_amount;
+    header->created_at = created_at;
+    header->current_balance = initial_balance;
+    header->peak_equity = initial_balance;
+}
+
+
+/* Folds one fill into state with the same arithmetic the bot used when
+ * it made the trade, so replay rebuilds its numbers exactly. */
+void journal_apply(JournalHeader *state, const JournalRecord *record) {
+    if (!state || !record) return;
+    
+    if (record->side == JOURNAL_BUY) {
+        double position = state->current_position + record->quantity;
+        if (position > 0) {
+            state->avg_buy_price = (state->current_position * state->avg_buy_price + record->total_cost) / position;
+        }
+        state->current_position = position;
+    } else {
+        double profit = record->total_cost - record->quantity * state->avg_buy_price;
+        state->total_profit += profit;
+        if (profit > 0) {
+            state->winning_trades++;
+        } else {
+            state->losing_trades++;
+        }
+        
+        state->current_position -= record->quantity;
+        if (state->current_position <= 1e-12) {
+            state->current_position = 0.0;
+            state->avg_buy_price = 0.0;
+        }
+    }
+    
+    state->current_balance = record->balance_after;
+    state->total_fees_paid += record->fee;
+    state->total_trades++;
+    state->last_trade_time = record->timestamp;
+    
+    double equity = state->current_balance + state->current_position * record->price;
+    if (equity > state->peak_equity) {
+        state->peak_equity = equity;
+    } else if (state->peak_equity > 0 && (state->peak_equity - equity) / state->peak_equity > state->max_drawdown) {
+        state->max_drawdown = (state->peak_equity - equity) / state->peak_equity;
+    }
+}
+
+
+TradeJournal* trade_journal_create(const char *path, const JournalHeader *header) {
+    if (!path || !header) return NULL;
+    
+    TradeJournal *journal = calloc(1, sizeof(TradeJournal));
+    if (!journal) return NULL;
+    
+    journal->path = copy_path(path, NULL);
+    journal->capacity = JOURNAL_INITIAL_RECORDS;
+    journal->map_size = file_size(journal->capacity);
+    journal->map = journal->path ? map_file(path, journal->map_size, O_CREAT | O_TRUNC, true) : NULL;
+    if (!journal->map) {
+        free(journal->path);
+        free(journal);
+        return NULL;
+    }
+    
+    write_first_header(journal->map, header);
+    return journal;
+}
+
+
+TradeJournal* trade_journal_open(const char *path) {
+    if (!path) return NULL;
+    
+    struct stat info;
+    if (stat(path, &info) != 0 || (size_t)info.st_size < file_size(0)) return NULL;
+    
+    TradeJournal *journal = calloc(1, sizeof(TradeJournal));
+    if (!journal) return NULL;
+    
+    journal->path = copy_path(path, NULL);
+    journal->map_size = (size_t)info.st_size;
+    journal->map = journal->path ? map_file(path, journal->map_size, 0, false) : NULL;
+    
+    if (!journal->map) {
+        trade_journal_close(journal);
+        return NULL;
+    }
+    
+    /* The newer valid slot wins; generations compare modulo wraparound */
+    const JournalHeader *first = header_slot(journal->map, 0);
+    const JournalHeader *second = header_slot(journal->map, 1);
+    bool first_valid = header_valid(first);
+    bool second_valid = header_valid(second);
+    if (!first_valid && !second_valid) {
+        trade_journal_close(journal);
+        return NULL;
+    }
+    journal->slot = (second_valid && (!first_valid || (int)(second->generation - first->generation) > 0)) ? 1 : 0;
+    const JournalHeader *header = header_of(journal);
+    
+    journal->capacity = (int)((journal->map_size - JOURNAL_HEADER_SIZE) / RECORD_SIZE);
+    
+    JournalRecord *records = records_of(journal);
+    while (journal->count < journal->capacity) {
+        const JournalRecord *record = &records[journal->count];
+        if (record->sequence != header->base_sequence + (unsigned int)journal->count ||
+            record->checksum != record_checksum(record)) break;
+        journal->count++;
+    }
+    
+    /* Clear whatever sits past a torn record so a later append cannot
+     * join up with stale records behind it. */
+    for (int i = journal->count; i < journal->capacity && records[i].checksum != 0; i++) {
+        memset(&records[i], 0, RECORD_SIZE);
+    }
+    
+    return journal;
+}
+
+
+void trade_journal_close(TradeJournal *journal) {
+    if (!journal) return;
+    
+    if (journal->map) munmap(journal->map, journal->map_size);
+    free(journal->path);
+    free(journal);
+}
+
+
+void trade_journal_remove(TradeJournal *journal) {
+    if (!journal) return;
+    
+    unlink(journal->path);
+    trade_journal_close(journal);
+}
+
+
+/* Doubles the record capacity, at most JOURNAL_MAX_GROW_RECORDS at a
+ * time. The new mapping is made before the old one goes away. */
+static bool grow(TradeJournal *journal) {
+    int extra = journal->capacity ? journal->capacity : JOURNAL_INITIAL_RECORDS;
+    if (extra > JOURNAL_MAX_GROW_RECORDS) extra = JOURNAL_MAX_GROW_RECORDS;
+    
+    int capacity = journal->capacity + extra;
+    size_t size = file_size(capacity);
+    char *map = map_file(journal->path, size, 0, true);
+    if (!map) return false;
+    
+    munmap(journal->map, journal->map_size);
+    journal->map = map;
+    journal->map_size = size;
+    journal->capacity = capacity;
+    return true;
+}
+
+
+/* Stamps record with its sequence number and checksum and stores it. */
+bool trade_journal_append(TradeJournal *journal, JournalRecord *record) {
+    if (!journal || !record || !journal->map) return false;
+    
+    if (journal->count == journal->capacity && !grow(journal)) return false;
+    
+    record->sequence = header_of(journal)->base_sequence + (unsigned int)journal->count;
+    record->checksum = record_checksum(record);
+    records_of(journal)[journal->count++] = *record;
+    return true;
+}
+
+
+int trade_journal_count(const TradeJournal *journal) {
+    return journal ? journal->count : 0;
+}
+
+
+const JournalRecord* trade_journal_record(const TradeJournal *journal, int index) {
+    if (!journal || index < 0 || index >= journal->count) return NULL;
+    return &records_of(journal)[index];
+}
+
+
+const JournalHeader* trade_journal_header(const TradeJournal *journal) {
+    return journal ? header_of(journal) : NULL;
+}
+
+
+const char* trade_journal_path(const TradeJournal *journal) {
+    return journal ? journal->path : NULL;
+}
+
+
+bool trade_journal_update_settings(TradeJournal *journal, double trade_amount, int cooldown_seconds, int status) {
+    if (!journal) return false;
+    
+    JournalHeader header = *header_of(journal);
+    header.trade_amount = trade_amount;
+    header.cooldown_seconds = cooldown_seconds;
+    header.status = status;
+    write_next_header(journal, &header);
+    return true;
+}
+
+
+/* Kept apart from the replay state: folding records into a base that
+ * already holds a later peak would overstate their drawdowns. */
+bool trade_journal_update_marks(TradeJournal *journal, double peak_equity, double max_drawdown) {
+    if (!journal) return false;
+    
+    JournalHeader header = *header_of(journal);
+    if (peak_equity > header.marked_peak) header.marked_peak = peak_equity;
+    if (max_drawdown > header.marked_drawdown) header.marked_drawdown = max_drawdown;
+    write_next_header(journal, &header);
+    return true;
+}
+
+
+/* Writes header and the records from first on to a new file and renames
+ * it over the journal, so a crash leaves either the old file or the new. */
+static bool rewrite(TradeJournal *journal, const JournalHeader *header, int first) {
+    char *temp_path = copy_path(journal->path, ".tmp");
+    if (!temp_path) return false;
+    
+    int keep = journal->count - first;
+    int capacity = keep + JOURNAL_INITIAL_RECORDS;
+    size_t size = file_size(capacity);
+    char *map = map_file(temp_path, size, O_CREAT | O_TRUNC, true);
+    if (!map) {
+        free(temp_path);
+        return false;
+    }
+    
+    write_first_header(map, header);
+    memcpy(map + JOURNAL_HEADER_SIZE, &records_of(journal)[first], (size_t)keep * RECORD_SIZE);
+    
+    if (msync(map, size, MS_SYNC) != 0 || rename(temp_path, journal->path) != 0) {
+        munmap(map, size);
+        unlink(temp_path);
+        free(temp_path);
+        return false;
+    }
+    free(temp_path);
+    
+    munmap(journal->map, journal->map_size);
+    journal->map = map;
+    journal->map_size = size;
+    journal->capacity = capacity;
+    journal->count = keep;
+    journal->slot = 0;
+    return true;
+}
+
+
+/* Folds all but the newest keep records into the header. */
+bool trade_journal_compact(TradeJournal *journal, int keep) {
+    if (!journal || !journal->map) return false;
+    
+    if (keep < 0) keep = 0;
+    if (keep >= journal->count) return true;
+    
+    int first = journal->count - keep;
+    JournalHeader header = *header_of(journal);
+    for (int i = 0; i < first; i++) {
+        journal_apply(&header, &records_of(journal)[i]);
+    }
+    header.base_sequence += (unsigned int)first;
+    return rewrite(journal, &header, first);
+}
+
+
+/* Drops every record and returns the state to the initial balance. */
+bool trade_journal_reset(TradeJournal *journal) {
+    if (!journal || !journal->map) return false;
+    
+    const JournalHeader *current = header_of(journal);
+    JournalHeader header;
+    journal_header_init(&header, current->symbol, current->initial_balance,
+                        current->trade_amount, current->created_at);
+    header.cooldown_seconds = current->cooldown_seconds;
+    header.status = current->status;
+    memcpy(header.strategy, current->strategy, sizeof(header.strategy));
+    header.base_sequence = current->base_sequence + (unsigned int)journal->count;
+    return rewrite(journal, &header, journal->count);
+}
+
+
+void trade_journal_sync(TradeJournal *journal) {
+    if (!journal || !journal->map) return;
+    
+    msync(journal->map, file_size(journal->count), MS_SYNC);
+}
@@ -0,0 +1,174 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/trend_consensus.h"
+#include <string.h>
+
+
+void trend_window_init(TrendWindow *window, int period, double threshold) {
+    if (!window) return;
+    
+    if (period <= 0) period = 10;
+    if (period > TREND_MAX_PERIOD) period = TREND_MAX_PERIOD;
+    
+    memset(window, 0, sizeof(*window));
+    window->period = period;
+    window->threshold = (threshold >= 0) ? threshold : 0.01;
+}
+
+
+void trend_window_reset(TrendWindow *window) {
+    if (!window) return;
+    
+    trend_window_init(window, window->period, window->threshold);
+}
+
+
+static void update_direction(TrendWindow *window) {
+    int period = window->period;
+    window->direction = 0;
+    if (window->samples < period) return;
+    
+    double avg_early = window->early_sum / period;
+    double avg_recent = window->recent_sum / period;
+    
+    if (avg_recent > avg_early * (1.0 + window->threshold)) window->direction = 1;
+    else if (avg_recent < avg_early * (1.0 - window->threshold)) window->direction = -1;
+}
+
+
+static void shift_in(TrendWindow *window, double close) {
+    int period = window->period;
+    int size = period * 2;
+    int slot = (int)(window->samples % size);
+    
+    if (window->samples >= size) {
+        window->early_sum -= window->ring[slot];
+    }
+    if (window->samples >= period) {
+        double moved = window->ring[(window->samples - period) % size];
+        window->recent_sum -= moved;
+        window->early_sum += moved;
+    }
+    
+    window->ring[slot] = close;
+    window->recent_sum += close;
+    window->samples++;
+}
+
+
+void trend_window_push(TrendWindow *window, double close) {
+    if (!window) return;
+    
+    if (window->period == 0) {
+        trend_window_init(window, 0, -1.0);
+    }
+    
+    shift_in(window, close);
+    update_direction(window);
+}
+
+
+/* Only the last 2 * period closes matter. The recent sum is re-added from
+ * scratch so a reload carries no rounding left over from the subtractions. */
+void trend_window_load(TrendWindow *window, const double *closes, int count) {
+    if (!window) return;
+    
+    if (window->period == 0) {
+        trend_window_init(window, 0, -1.0);
+    } else {
+        trend_window_reset(window);
+    }
+    if (!closes || count <= 0) return;
+    
+    int size = window->period * 2;
+    int start = (count > size) ? count - size : 0;
+    for (int i = start; i < count; i++) {
+        shift_in(window, closes[i]);
+    }
+    
+    int recent = (count - start < window->period) ? count - start : window->period;
+    window->recent_sum = 0.0;
+    for (int i = count - recent; i < count; i++) {
+        window->recent_sum += closes[i];
+    }
+    
+    update_direction(window);
+}
+
+
+void trend_consensus_init(TrendConsensus *trend, int period, double threshold, double min_score) {
+    if (!trend) return;
+    
+    memset(trend, 0, sizeof(*trend));
+    for (int i = 0; i < TREND_MAX_FRAMES; i++) {
+        trend_window_init(&trend->frames[i], period, threshold);
+    }
+    trend->min_score = (min_score > 0) ? min_score : 1.0;
+}
+
+
+static void update_consensus(TrendConsensus *trend) {
+    double score = 0.0;
+    for (int i = 0; i < TREND_MAX_FRAMES; i++) {
+        if (trend->weights[i] != 0.0) {
+            score += trend->weights[i] * trend->frames[i].direction;
+        }
+    }
+    
+    trend->score = score;
+    if (score >= trend->min_score) trend->consensus = 1;
+    else if (score <= -trend->min_score) trend->consensus = -1;
+    else trend->consensus = 0;
+}
+
+
+void trend_consensus_set_weight(TrendConsensus *trend, int frame, double weight) {
+    if (!trend || frame < 0 || frame >= TREND_MAX_FRAMES) return;
+    
+    trend->weights[frame] = weight;
+    update_consensus(trend);
+}
+
+
+void trend_consensus_load(TrendConsensus *trend, int frame, const double *closes, int count) {
+    if (!trend || frame < 0 || frame >= TREND_MAX_FRAMES) return;
+    
+    trend_window_load(&trend->frames[frame], closes, count);
+    update_consensus(trend);
+}
+
+
+void trend_consensus_push(TrendConsensus *trend, int frame, double close) {
+    if (!trend || frame < 0 || frame >= TREND_MAX_FRAMES) return;
+    
+    trend_window_push(&trend->frames[frame], close);
+    update_consensus(trend);
+}
+
+
+int trend_consensus_frame(const TrendConsensus *trend, int frame) {
+    if (!trend || frame < 0 || frame >= TREND_MAX_FRAMES) return 0;
+    return trend->frames[frame].direction;
+}
+
+
+int trend_consensus_direction(const TrendConsensus *trend) {
+    return trend ? trend->consensus : 0;
+}
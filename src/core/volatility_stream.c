@@ -0,0 +1,159 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/volatility_stream.h"
+#include <math.h>
+#include <string.h>
+
+#define HOURS_PER_YEAR (365.0 * 24.0)
+
+
+void volatility_stream_init(VolatilityStream *stream, int window, double candle_hours) {
+    if (!stream) return;
+    
+    memset(stream, 0, sizeof(*stream));
+    if (window < 2) window = 30;
+    if (window > VOL_MAX_WINDOW) window = VOL_MAX_WINDOW;
+    stream->window = window;
+    stream->periods_per_year = HOURS_PER_YEAR / ((candle_hours > 0) ? candle_hours : 1.0);
+}
+
+
+void volatility_stream_reset(VolatilityStream *stream) {
+    if (!stream) return;
+    
+    int window = stream->window;
+    double periods_per_year = stream->periods_per_year;
+    memset(stream, 0, sizeof(*stream));
+    stream->window = (window > 0) ? window : 30;
+    stream->periods_per_year = (periods_per_year > 0) ? periods_per_year : HOURS_PER_YEAR;
+}
+
+
+static void accumulate(VolatilityStream *stream, const VolTerms *terms, double sign) {
+    stream->gap_sum += sign * terms->gap;
+    stream->gap_sq += sign * terms->gap * terms->gap;
+    stream->body_sum += sign * terms->body;
+    stream->body_sq += sign * terms->body * terms->body;
+    stream->rs_sum += sign * terms->rogers_satchell;
+    stream->parkinson_sum += sign * terms->parkinson;
+    stream->gk_sum += sign * terms->garman_klass;
+}
+
+
+static int filled(const VolatilityStream *stream) {
+    return (stream->samples < stream->window) ? (int)stream->samples : stream->window;
+}
+
+
+void volatility_stream_push(VolatilityStream *stream, const Candle *candle) {
+    if (!stream || !candle) return;
+    if (candle->open <= 0 || candle->high <= 0 || candle->low <= 0 || candle->close <= 0) return;
+    
+    if (stream->window == 0) {
+        volatility_stream_init(stream, 0, 0.0);
+    }
+    
+    double hl = log(candle->high / candle->low);
+    double ho = log(candle->high / candle->open);
+    double lo = log(candle->low / candle->open);
+    double co = log(candle->close / candle->open);
+    
+    VolTerms terms;
+    terms.gap = (stream->samples > 0) ? log(candle->open / stream->prev_close) : 0.0;
+    terms.body = co;
+    terms.rogers_satchell = ho * (ho - co) + lo * (lo - co);
+    terms.parkinson = hl * hl / (4.0 * log(2.0));
+    terms.garman_klass = 0.5 * hl * hl - (2.0 * log(2.0) - 1.0) * co * co;
+    
+    int slot = (int)(stream->samples % stream->window);
+    if (stream->samples >= stream->window) {
+        accumulate(stream, &stream->ring[slot], -1.0);
+    }
+    stream->ring[slot] = terms;
+    accumulate(stream, &terms, 1.0);
+    stream->samples++;
+    stream->prev_close = candle->close;
+    
+    if (++stream->since_resum >= stream->window) {
+        stream->since_resum = 0;
+        stream->gap_sum = stream->gap_sq = 0.0;
+        stream->body_sum = stream->body_sq = 0.0;
+        stream->rs_sum = stream->parkinson_sum = stream->gk_sum = 0.0;
+        int n = filled(stream);
+        for (int i = 0; i < n; i++) {
+            accumulate(stream, &stream->ring[i], 1.0);
+        }
+    }
+}
+
+
+/* Only the last window candles, plus one for the first gap, affect the
+ * estimates, so older ones are skipped. */
+void volatility_stream_backfill(VolatilityStream *stream, const Candle *candles, int count) {
+    if (!stream) return;
+    
+    volatility_stream_reset(stream);
+    if (!candles || count <= 0) return;
+    
+    int start = count - stream->window - 1;
+    if (start < 0) start = 0;
+    for (int i = start; i < count; i++) {
+        volatility_stream_push(stream, &candles[i]);
+    }
+}
+
+
+bool volatility_stream_ready(const VolatilityStream *stream) {
+    return stream && stream->window > 0 && stream->samples > stream->window;
+}
+
+
+/* Per-candle variance. Yang-Zhang combines the gap and body sample
+ * variances with the Rogers-Satchell mean using its k weighting. */
+double volatility_stream_variance(const VolatilityStream *stream, VolEstimator estimator) {
+    if (!volatility_stream_ready(stream)) return 0.0;
+    
+    double n = stream->window;
+    double variance = 0.0;
+    switch (estimator) {
+        case VOL_PARKINSON:
+            variance = stream->parkinson_sum / n;
+            break;
+        case VOL_GARMAN_KLASS:
+            variance = stream->gk_sum / n;
+            break;
+        case VOL_YANG_ZHANG: {
+            double gap_var = (stream->gap_sq - stream->gap_sum * stream->gap_sum / n) / (n - 1);
+            double body_var = (stream->body_sq - stream->body_sum * stream->body_sum / n) / (n - 1);
+            double k = 0.34 / (1.34 + (n + 1) / (n - 1));
+            variance = gap_var + k * body_var + (1.0 - k) * stream->rs_sum / n;
+            break;
+        }
+        default:
+            return 0.0;
+    }
+    return (variance > 0) ? variance : 0.0;
+}
+
+
+double volatility_stream_annualized(const VolatilityStream *stream, VolEstimator estimator) {
+    double variance = volatility_stream_variance(stream, estimator);
+    return (variance > 0) ? sqrt(variance * stream->periods_per_year) : 0.0;
+}
@@ -0,0 +1,240 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "portfolio/volume_profile.h"
+#include <math.h>
+#include <string.h>
+
+#define VP_BINS_PER_RANGE 2.0
+#define VP_VALUE_AREA 0.70
+#define VP_NODE_RATIO 1.2
+
+
+void volume_profile_reset(VolumeProfile *profile) {
+    if (!profile) return;
+    memset(profile, 0, sizeof(*profile));
+}
+
+
+/* Bins are half a typical candle range wide, but never so narrow that
+ * [low, high] takes more than half of VP_MAX_BINS; the rest is headroom
+ * for prices outside the first batch. */
+void volume_profile_prepare(VolumeProfile *profile, double low, double high, double typical_range) {
+    if (!profile || low <= 0 || high < low) return;
+    
+    volume_profile_reset(profile);
+    
+    double range = high - low;
+    double width = (typical_range > 0) ? typical_range / VP_BINS_PER_RANGE : range / (VP_MAX_BINS / 2);
+    if (width < range / (VP_MAX_BINS / 2)) width = range / (VP_MAX_BINS / 2);
+    if (width < high * 1e-6) width = high * 1e-6;
+    
+    profile->base = low;
+    profile->width = width;
+    profile->bin_count = (int)(range / width) + 1;
+    if (profile->bin_count > VP_MAX_BINS) profile->bin_count = VP_MAX_BINS;
+}
+
+
+static void materialize(VolumeProfile *profile) {
+    if (!profile->pending) return;
+    
+    double running = 0.0;
+    for (int i = 0; i < profile->bin_count; i++) {
+        running += profile->spread[i];
+        profile->volume[i] += running;
+        profile->spread[i] = 0.0;
+    }
+    profile->spread[profile->bin_count] = 0.0;
+    profile->pending = false;
+}
+
+
+static void merge_pairs(VolumeProfile *profile) {
+    int merged = (profile->bin_count + 1) / 2;
+    for (int i = 0; i < merged; i++) {
+        double right = (2 * i + 1 < profile->bin_count) ? profile->volume[2 * i + 1] : 0.0;
+        profile->volume[i] = profile->volume[2 * i] + right;
+    }
+    memset(profile->volume + merged, 0, (VP_MAX_BINS - merged) * sizeof(double));
+    profile->bin_count = merged;
+    profile->width *= 2.0;
+}
+
+
+static void cover(VolumeProfile *profile, double low, double high) {
+    for (;;) {
+        double top = profile->base + profile->bin_count * profile->width;
+        int below = (low < profile->base) ? (int)ceil((profile->base - low) / profile->width) : 0;
+        int above = (high >= top) ? (int)floor((high - top) / profile->width) + 1 : 0;
+        if (below == 0 && above == 0) return;
+        
+        materialize(profile);
+        
+        if (profile->bin_count + below + above <= VP_MAX_BINS) {
+            memmove(profile->volume + below, profile->volume, profile->bin_count * sizeof(double));
+            memset(profile->volume, 0, below * sizeof(double));
+            memset(profile->volume + below + profile->bin_count, 0, above * sizeof(double));
+            profile->base -= below * profile->width;
+            profile->bin_count += below + above;
+            return;
+        }
+        
+        merge_pairs(profile);
+    }
+}
+
+
+void volume_profile_add(VolumeProfile *profile, const Candle *candle) {
+    if (!profile || !candle || candle->volume <= 0) return;
+    
+    double low = candle->low;
+    double high = candle->high;
+    if (high < low) {
+        double t = low;
+        low = high;
+        high = t;
+    }
+    if (low <= 0) return;
+    
+    if (profile->bin_count == 0) {
+        volume_profile_prepare(profile, low, high, high - low);
+    }
+    cover(profile, low, high);
+    
+    double from = (low - profile->base) / profile->width;
+    double to = (high - profile->base) / profile->width;
+    int first = (int)from;
+    int last = (int)to;
+    if (last >= profile->bin_count) last = profile->bin_count - 1;
+    if (first > last) first = last;
+    
+    if (first >= last) {
+        profile->volume[first] += candle->volume;
+    } else {
+        double density = candle->volume / (to - from);
+        profile->volume[first] += density * (first + 1 - from);
+        profile->volume[last] += density * (to - last);
+        if (last > first + 1) {
+            profile->spread[first + 1] += density;
+            profile->spread[last] -= density;
+            profile->pending = true;
+        }
+    }
+    
+    profile->total_volume += candle->volume;
+    profile->candles++;
+}
+
+
+static double smoothed(const VolumeProfile *profile, int i) {
+    double left = (i > 0) ? profile->volume[i - 1] : 0.0;
+    double right = (i + 1 < profile->bin_count) ? profile->volume[i + 1] : 0.0;
+    return 0.25 * left + 0.5 * profile->volume[i] + 0.25 * right;
+}
+
+
+/* One pass for the point of control and the node candidates (peaks of
+ * the [1 2 1]-smoothed histogram above VP_NODE_RATIO times the mean
+ * occupied bin), one outward walk for the value area. */
+void volume_profile_levels(VolumeProfile *profile, VolumeLevels *levels) {
+    if (!levels) return;
+    
+    memset(levels, 0, sizeof(*levels));
+    if (!profile || profile->bin_count == 0 || profile->total_volume <= 0) return;
+    
+    materialize(profile);
+    int n = profile->bin_count;
+    double width = profile->width;
+    
+    int poc = 0;
+    int occupied = 0;
+    for (int i = 0; i < n; i++) {
+        if (profile->volume[i] > profile->volume[poc]) poc = i;
+        if (profile->volume[i] > 0) occupied++;
+    }
+    
+    levels->poc = profile->base + (poc + 0.5) * width;
+    levels->low = profile->base;
+    levels->high = profile->base + n * width;
+    
+    double target = profile->total_volume * VP_VALUE_AREA;
+    double inside = profile->volume[poc];
+    int lo = poc, hi = poc;
+    while (inside < target && (lo > 0 || hi < n - 1)) {
+        double down = (lo > 0) ? profile->volume[lo - 1] : -1.0;
+        double up = (hi < n - 1) ? profile->volume[hi + 1] : -1.0;
+        if (up >= down) inside += profile->volume[++hi];
+        else inside += profile->volume[--lo];
+    }
+    levels->value_area_low = profile->base + lo * width;
+    levels->value_area_high = profile->base + (hi + 1) * width;
+    
+    double mean = profile->total_volume / (occupied > 0 ? occupied : 1);
+    double previous = 0.0;
+    double current = smoothed(profile, 0);
+    for (int i = 0; i < n; i++) {
+        double next = (i + 1 < n) ? smoothed(profile, i + 1) : 0.0;
+        bool peak = current >= previous && current > next && current > mean * VP_NODE_RATIO;
+        
+        if (peak) {
+            VolumeNode node = { profile->base + (i + 0.5) * width, current, current / mean };
+            if (levels->node_count < VP_MAX_NODES) {
+                levels->nodes[levels->node_count++] = node;
+            } else {
+                int weakest = 0;
+                for (int k = 1; k < VP_MAX_NODES; k++) {
+                    if (levels->nodes[k].volume < levels->nodes[weakest].volume) weakest = k;
+                }
+                if (node.volume > levels->nodes[weakest].volume) {
+                    memmove(&levels->nodes[weakest], &levels->nodes[weakest + 1],
+                            (VP_MAX_NODES - weakest - 1) * sizeof(VolumeNode));
+                    levels->nodes[VP_MAX_NODES - 1] = node;
+                }
+            }
+        }
+        
+        previous = current;
+        current = next;
+    }
+}
+
+
+/* Support is the nearest node below price and resistance the nearest
+ * above; without one the value area edge, then the profile edge, stands
+ * in. */
+bool volume_levels_nearest(const VolumeLevels *levels, double price, double *support, double *resistance) {
+    if (!levels || !support || !resistance || price <= 0 || levels->high <= 0) return false;
+    
+    *support = 0.0;
+    *resistance = 0.0;
+    for (int i = 0; i < levels->node_count; i++) {
+        double level = levels->nodes[i].price;
+        if (level < price) *support = level;
+        else if (level > price && *resistance == 0.0) *resistance = level;
+    }
+    
+    if (*support == 0.0) {
+        *support = (levels->value_area_low < price) ? levels->value_area_low : levels->low;
+    }
+    if (*resistance == 0.0) {
+        *resistance = (levels->value_area_high > price) ? levels->value_area_high : levels->high;
+    }
+    return true;
+}
@@ -0,0 +1,183 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "portfolio/worker_pool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+struct WorkerPool {
+    pthread_t threads[WORKER_POOL_MAX_THREADS];
+    int thread_count;
+    
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    pthread_mutex_t run_lock;
+    
+    unsigned long generation;
+    bool shutdown;
+    
+    WorkerTask task;
+    char *args;
+    size_t arg_size;
+    int count;
+    int next;
+    int completed;
+};
+
+static WorkerPool *default_pool = NULL;
+static pthread_once_t default_pool_once = PTHREAD_ONCE_INIT;
+
+
+/* Claims and runs tasks of the current batch until none are left.
+ * Called and returns with pool->lock held. */
+static void drain_batch(WorkerPool *pool) {
+    while (pool->next < pool->count) {
+        int index = pool->next++;
+        WorkerTask task = pool->task;
+        void *arg = pool->args + (size_t)index * pool->arg_size;
+        
+        pthread_mutex_unlock(&pool->lock);
+        task(arg);
+        pthread_mutex_lock(&pool->lock);
+        
+        if (++pool->completed == pool->count) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+
+static void* worker_main(void *data) {
+    WorkerPool *pool = data;
+    unsigned long seen = 0;
+    
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        
+        seen = pool->generation;
+        drain_batch(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+
+WorkerPool* worker_pool_create(int thread_count) {
+    if (thread_count < 0) thread_count = 0;
+    if (thread_count > WORKER_POOL_MAX_THREADS) thread_count = WORKER_POOL_MAX_THREADS;
+    
+    WorkerPool *pool = calloc(1, sizeof(WorkerPool));
+    if (!pool) {
+        return NULL;
+    }
+    
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+    
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker_main, pool) != 0) {
+            break;
+        }
+        pool->thread_count++;
+    }
+    
+    return pool;
+}
+
+
+void worker_pool_destroy(WorkerPool *pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->run_lock);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+
+int worker_pool_size(const WorkerPool *pool) {
+    return pool ? pool->thread_count + 1 : 1;
+}
+
+
+void worker_pool_run(WorkerPool *pool, WorkerTask task, void *args, size_t arg_size, int count) {
+    if (!task || !args || count <= 0) return;
+    
+    if (!pool || pool->thread_count == 0 || count == 1) {
+        for (int i = 0; i < count; i++) {
+            task((char *)args + (size_t)i * arg_size);
+        }
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->run_lock);
+    pthread_mutex_lock(&pool->lock);
+    
+    pool->task = task;
+    pool->args = args;
+    pool->arg_size = arg_size;
+    pool->count = count;
+    pool->next = 0;
+    pool->completed = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    
+    drain_batch(pool);
+    while (pool->completed < pool->count) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+
+static void create_default_pool(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    
+    default_pool = worker_pool_create((int)cpus - 1);
+}
+
+
+WorkerPool* worker_pool_default(void) {
+    pthread_once(&default_pool_once, create_default_pool);
+    return default_pool;
+}
@@ -20,24 +20,55 @@
 #include "portfolio/portfolio_core.h"
 #include "portfolio/network.h"
 #include "portfolio/scalping_bot.h"
+#include "portfolio/alert_engine.h"
 #include "ui/ui_factory.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <ctype.h>
+#include <string.h>
 
 typedef struct {
     Portfolio *portfolio;
     NetworkManager *network;
     BotManager *bot_manager;
+    AlertEngine *alerts;
     UIInterface *ui;
 } AppContext;
 
 
+static void on_alert(const AlertEvent *event, void *user_data) {
+    AppContext *ctx = (AppContext *)user_data;
+    
+    char message[256];
+    if (event->kind == ALERT_CONDITION) {
+        snprintf(message, sizeof(message), "%s: %s", event->symbol, event->condition);
+    } else {
+        snprintf(message, sizeof(message), "%s crossed %s %.8g (now %.8g)", event->symbol,
+                 event->kind == ALERT_PRICE_ABOVE ? "above" : "below", event->threshold, event->price);
+    }
+    
+    printf("Alert: %s\n", message);
+    if (ctx->ui && ctx->ui->show_alert) {
+        ctx->ui->show_alert(message, ctx->ui->impl_data);
+    }
+}
+
 static void on_price_update(int pair_index, double price, void *user_data) {
     AppContext *ctx = (AppContext *)user_data;
     
     portfolio_update_current_price(ctx->portfolio, pair_index, price);
     
+    if (pair_index >= 0 && pair_index < ctx->portfolio->pair_count) {
+        TradingPair *pair = &ctx->portfolio->pairs[pair_index];
+        alert_engine_on_price(ctx->alerts, pair->symbol, price);
+        if (ctx->bot_manager) bot_dispatch_price(ctx->bot_manager, pair);
+        
+        /* A changed scalp signal reaches the bots now rather than at the next candle fetch. */
+        bool changed = analyze_scalping_tick(pair, price, clock_now_ms(NULL));
+        if (changed && ctx->bot_manager && (is_scalp_buy_signal(pair) || is_scalp_sell_signal(pair))) {
+            bot_dispatch_signal(ctx->bot_manager, pair);
+        }
+    }
+    
     if (ctx->ui && ctx->ui->update_pair_price) {
         ctx->ui->update_pair_price(pair_index, price, ctx->ui->impl_data);
     }
@@ -49,69 +80,28 @@ static void on_historical_data(int pair_index, double *prices, int count, void *
     if (pair_index >= 0 && pair_index < ctx->portfolio->pair_count) {
         TradingPair *pair = &ctx->portfolio->pairs[pair_index];
         
-        int copy_count = (count < HISTORICAL_DATA_SIZE) ? count : HISTORICAL_DATA_SIZE;
-        for (int i = 0; i < copy_count; i++) {
-            pair->historical_prices[i] = prices[i];
-        }
-        pair->historical_count = copy_count;
-        pair->historical_loaded = true;
-        pair->last_historical_fetch = time(NULL);
+        int copy_count = portfolio_store_series(pair, SERIES_LEGACY, prices, count);
         
         printf("Loaded %d historical prices for %s\n", copy_count, pair->symbol);
     }
 }
 
-static void on_multi_timeframe_data(int pair_index, const char *interval, double *prices, int count, void *user_data) {
+static void on_multi_timeframe_data(int pair_index, const char *interval, const Candle *candles, int count, void *user_data) {
     AppContext *ctx = (AppContext *)user_data;
     
     if (pair_index >= 0 && pair_index < ctx->portfolio->pair_count) {
         TradingPair *pair = &ctx->portfolio->pairs[pair_index];
         
-        if (strcmp(interval, "5m") == 0) {
-            int copy_count = (count < HISTORICAL_DATA_SIZE_5M) ? count : HISTORICAL_DATA_SIZE_5M;
-            for (int i = 0; i < copy_count; i++) {
-                pair->historical_5m[i] = prices[i];
-            }
-            pair->historical_5m_count = copy_count;
-            pair->historical_5m_loaded = true;
-            pair->last_5m_fetch = time(NULL);
-            printf("Loaded %d 5m candles for %s (scalping)\n", copy_count, pair->symbol);
-        } else if (strcmp(interval, "15m") == 0) {
-            int copy_count = (count < HISTORICAL_DATA_SIZE_15M) ? count : HISTORICAL_DATA_SIZE_15M;
-            for (int i = 0; i < copy_count; i++) {
-                pair->historical_15m[i] = prices[i];
-            }
-            pair->historical_15m_count = copy_count;
-            pair->historical_15m_loaded = true;
-            pair->last_15m_fetch = time(NULL);
-            printf("Loaded %d 15m candles for %s (scalping)\n", copy_count, pair->symbol);
-        } else if (strcmp(interval, "1h") == 0) {
-            int copy_count = (count < HISTORICAL_DATA_SIZE_1H) ? count : HISTORICAL_DATA_SIZE_1H;
-            for (int i = 0; i < copy_count; i++) {
-                pair->historical_1h[i] = prices[i];
-            }
-            pair->historical_1h_count = copy_count;
-            pair->historical_1h_loaded = true;
-            pair->last_1h_fetch = time(NULL);
-            printf("Loaded %d 1h candles for %s\n", copy_count, pair->symbol);
-        } else if (strcmp(interval, "4h") == 0) {
-            int copy_count = (count < HISTORICAL_DATA_SIZE_4H) ? count : HISTORICAL_DATA_SIZE_4H;
-            for (int i = 0; i < copy_count; i++) {
-                pair->historical_4h[i] = prices[i];
-            }
-            pair->historical_4h_count = copy_count;
-            pair->historical_4h_loaded = true;
-            pair->last_4h_fetch = time(NULL);
-            printf("Loaded %d 4h candles for %s\n", copy_count, pair->symbol);
-        } else if (strcmp(interval, "1d") == 0) {
-            int copy_count = (count < HISTORICAL_DATA_SIZE_1D) ? count : HISTORICAL_DATA_SIZE_1D;
-            for (int i = 0; i < copy_count; i++) {
-                pair->historical_1d[i] = prices[i];
+        SeriesId series = portfolio_series_from_interval(interval);
+        if (series != SERIES_COUNT) {
+            int copy_count = portfolio_store_candles(pair, series, candles, count);
+            printf("Loaded %d %s candles for %s%s\n", copy_count, interval, pair->symbol,
+                   (series == SERIES_5M || series == SERIES_15M) ? " (scalping)" : "");
+            
+            if (series == SERIES_1H) {
+                portfolio_update_covariance(ctx->portfolio);
             }
-            pair->historical_1d_count = copy_count;
-            pair->historical_1d_loaded = true;
-            pair->last_1d_fetch = time(NULL);
-            printf("Loaded %d 1d candles for %s\n", copy_count, pair->symbol);
+            alert_engine_on_series(ctx->alerts, pair, series);
         }
         
         
@@ -121,12 +111,7 @@ static void on_multi_timeframe_data(int pair_index, const char *interval, double
         if (ctx->bot_manager && pair->current_price > 0) {
             
             if (pair->historical_5m_loaded && pair->historical_5m_count > 20) {
-                for (int i = 0; i < MAX_BOTS; i++) {
-                    if (ctx->bot_manager->bots[i].active && 
-                        ctx->bot_manager->bots[i].status == BOT_RUNNING) {
-                        bot_process_signal(ctx->bot_manager, i, pair);
-                    }
-                }
+                bot_dispatch_signal(ctx->bot_manager, pair);
             }
         }
         
@@ -193,36 +178,10 @@ static void on_refresh_callback(void *user_data) {
     
     
     if (ctx->bot_manager) {
-        for (int i = 0; i < MAX_BOTS; i++) {
-            if (ctx->bot_manager->bots[i].active && 
-                ctx->bot_manager->bots[i].status == BOT_RUNNING) {
-                
-                ScalpingBot *bot = &ctx->bot_manager->bots[i];
-                
-                
-                for (int j = 0; j < ctx->portfolio->pair_count; j++) {
-                    TradingPair *pair = &ctx->portfolio->pairs[j];
-                    
-                    char upper_pair[MAX_SYMBOL_LEN];
-                    strncpy(upper_pair, pair->symbol, MAX_SYMBOL_LEN);
-                    for (int k = 0; upper_pair[k]; k++) {
-                        upper_pair[k] = toupper((unsigned char)upper_pair[k]);
-                    }
-                    
-                    char upper_bot[MAX_SYMBOL_LEN];
-                    strncpy(upper_bot, bot->symbol, MAX_SYMBOL_LEN);
-                    for (int k = 0; upper_bot[k]; k++) {
-                        upper_bot[k] = toupper((unsigned char)upper_bot[k]);
-                    }
-                    
-                    if (strcmp(upper_pair, upper_bot) == 0) {
-                        
-                        if (pair->historical_5m_loaded && pair->historical_5m_count > 20) {
-                            bot_process_signal(ctx->bot_manager, i, pair);
-                        }
-                        break;
-                    }
-                }
+        for (int i = 0; i < ctx->portfolio->pair_count; i++) {
+            TradingPair *pair = &ctx->portfolio->pairs[i];
+            if (pair->historical_5m_loaded && pair->historical_5m_count > 20) {
+                bot_dispatch_signal(ctx->bot_manager, pair);
             }
         }
     }
@@ -230,7 +189,7 @@ static void on_refresh_callback(void *user_data) {
     
     for (int i = 0; i < ctx->portfolio->pair_count; i++) {
         TradingPair *pair = &ctx->portfolio->pairs[i];
-        time_t now = time(NULL);
+        time_t now = clock_now(NULL);
         
         
         if (!pair->historical_1h_loaded || (now - pair->last_1h_fetch) > 300) {
@@ -299,6 +258,11 @@ int main(int argc, char *argv[]) {
     }
     
     
+    /* Paper trades pay the spread, walk the book and wait out order latency. */
+    ExecutionModel execution;
+    execution_model_init(&execution, NULL);
+    bot_manager->execution = &execution;
+    
     bot_manager_load(bot_manager);
     
     
@@ -306,10 +270,20 @@ int main(int argc, char *argv[]) {
         .portfolio = portfolio,
         .network = network,
         .bot_manager = bot_manager,
+        .alerts = NULL,
         .ui = NULL
     };
     
     
+    ctx.alerts = alert_engine_create(on_alert, &ctx);
+    char *alerts_path = portfolio_get_config_path("alerts.conf");
+    int alert_count = alert_engine_load(ctx.alerts, alerts_path);
+    if (alert_count > 0) {
+        printf("Loaded %d alerts from %s\n", alert_count, alerts_path);
+    }
+    free(alerts_path);
+    
+    
     UICallbacks callbacks = {
         .on_add_pair = on_add_pair_callback,
         .on_remove_pair = on_remove_pair_callback,
@@ -355,6 +329,7 @@ int main(int argc, char *argv[]) {
     bot_manager_save(bot_manager);
     
     ui_factory_destroy(ui);
+    alert_engine_destroy(ctx.alerts);
     bot_manager_destroy(bot_manager);
     network_manager_destroy(network);
     portfolio_destroy(portfolio);
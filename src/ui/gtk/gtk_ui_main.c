@@ -40,6 +40,7 @@ static void gtk_ui_update_portfolio_display(Portfolio *portfolio, void *user_dat
 static void gtk_ui_update_pair_price(int pair_index, double price, void *user_data);
 static void gtk_ui_show_error(const char *message, void *user_data);
 static void gtk_ui_show_info(const char *message, void *user_data);
+static void gtk_ui_show_alert(const char *message, void *user_data);
 static void gtk_ui_cleanup(void *user_data);
 
 
@@ -101,6 +102,7 @@ UIInterface* ui_gtk_create(Portfolio *portfolio, NetworkManager *network,
     ui->update_pair_price = gtk_ui_update_pair_price;
     ui->show_error = gtk_ui_show_error;
     ui->show_info = gtk_ui_show_info;
+    ui->show_alert = gtk_ui_show_alert;
     ui->cleanup = gtk_ui_cleanup;
     ui->impl_data = app_data;
     
@@ -556,12 +558,15 @@ static void update_display(GTKAppData *app) {
             gtk_box_pack_start(GTK_BOX(enhanced_ta_box), prob_label, FALSE, FALSE, 0);
             
             
-            if (pair->pattern_count > 0 && strlen(pair->detected_patterns) > 0) {
+            char pattern_text[MAX_PATTERN_TEXT];
+            if (format_pattern_hits(pair, pattern_text, sizeof(pattern_text)) > 0) {
                 GtkWidget *pattern_label = gtk_label_new(NULL);
-                char pattern_markup[400];
+                gchar *escaped_patterns = g_markup_escape_text(pattern_text, -1);
+                char pattern_markup[MAX_PATTERN_TEXT * 2];
                 snprintf(pattern_markup, sizeof(pattern_markup),
                         "<span size='small'>[*] Patterns: <span foreground='#bf5af2'><b>%s</b></span></span>",
-                        pair->detected_patterns);
+                        escaped_patterns);
+                g_free(escaped_patterns);
                 gtk_label_set_markup(GTK_LABEL(pattern_label), pattern_markup);
                 gtk_widget_set_halign(pattern_label, GTK_ALIGN_START);
                 gtk_box_pack_start(GTK_BOX(enhanced_ta_box), pattern_label, FALSE, FALSE, 0);
@@ -570,43 +575,12 @@ static void update_display(GTKAppData *app) {
             
             if (pair->historical_1h_loaded && pair->historical_4h_loaded && pair->historical_1d_loaded) {
                 int mtf_trend = calculate_trend_multi_timeframe(pair);
-                const char *trend_arrow_1h = "→";
-                const char *trend_arrow_4h = "→";
-                const char *trend_arrow_1d = "→";
-                
-                
-                if (pair->historical_1h_count >= 20) {
-                    double avg_early = 0.0, avg_recent = 0.0;
-                    for (int j = pair->historical_1h_count - 20; j < pair->historical_1h_count - 10; j++) {
-                        if (j >= 0) avg_early += pair->historical_1h[j];
-                    }
-                    for (int j = pair->historical_1h_count - 10; j < pair->historical_1h_count; j++) {
-                        if (j >= 0) avg_recent += pair->historical_1h[j];
-                    }
-                    trend_arrow_1h = (avg_recent > avg_early * 1.01) ? "↗" : (avg_recent < avg_early * 0.99) ? "↘" : "→";
-                }
-                
-                if (pair->historical_4h_count >= 20) {
-                    double avg_early = 0.0, avg_recent = 0.0;
-                    for (int j = pair->historical_4h_count - 20; j < pair->historical_4h_count - 10; j++) {
-                        if (j >= 0) avg_early += pair->historical_4h[j];
-                    }
-                    for (int j = pair->historical_4h_count - 10; j < pair->historical_4h_count; j++) {
-                        if (j >= 0) avg_recent += pair->historical_4h[j];
-                    }
-                    trend_arrow_4h = (avg_recent > avg_early * 1.01) ? "↗" : (avg_recent < avg_early * 0.99) ? "↘" : "→";
-                }
-                
-                if (pair->historical_1d_count >= 20) {
-                    double avg_early = 0.0, avg_recent = 0.0;
-                    for (int j = pair->historical_1d_count - 20; j < pair->historical_1d_count - 10; j++) {
-                        if (j >= 0) avg_early += pair->historical_1d[j];
-                    }
-                    for (int j = pair->historical_1d_count - 10; j < pair->historical_1d_count; j++) {
-                        if (j >= 0) avg_recent += pair->historical_1d[j];
-                    }
-                    trend_arrow_1d = (avg_recent > avg_early * 1.01) ? "↗" : (avg_recent < avg_early * 0.99) ? "↘" : "→";
-                }
+                int trend_1h = portfolio_series_trend(pair, SERIES_1H);
+                int trend_4h = portfolio_series_trend(pair, SERIES_4H);
+                int trend_1d = portfolio_series_trend(pair, SERIES_1D);
+                const char *trend_arrow_1h = trend_1h == 1 ? "↗" : (trend_1h == -1 ? "↘" : "→");
+                const char *trend_arrow_4h = trend_4h == 1 ? "↗" : (trend_4h == -1 ? "↘" : "→");
+                const char *trend_arrow_1d = trend_1d == 1 ? "↗" : (trend_1d == -1 ? "↘" : "→");
                 
                 const char *alignment_text = mtf_trend == 1 ? "All Bullish!" : 
                                             mtf_trend == -1 ? "All Bearish" : 
@@ -626,15 +600,15 @@ static void update_display(GTKAppData *app) {
             }
             
             
-            if (pair->historical_5m_loaded && strlen(pair->scalp_signal) > 0) {
+            if (pair->historical_5m_loaded) {
                 const char *signal_color;
-                if (strstr(pair->scalp_signal, "BUY")) {
+                if (pair->scalp_signal & SCALP_SIDE_BUY) {
                     signal_color = "#30d158";
-                } else if (strstr(pair->scalp_signal, "SELL")) {
+                } else if (pair->scalp_signal & SCALP_SIDE_SELL) {
                     signal_color = "#ff453a";
-                } else if (strstr(pair->scalp_signal, "HOLD")) {
+                } else if (pair->scalp_signal == SCALP_HOLD) {
                     signal_color = "#ffd60a";
-                } else if (strstr(pair->scalp_signal, "WAIT")) {
+                } else if (pair->scalp_signal == SCALP_WAIT || pair->scalp_signal == SCALP_RANGING) {
                     signal_color = "#8e8e93";
                 } else {
                     signal_color = "#ff9500";
@@ -644,7 +618,7 @@ static void update_display(GTKAppData *app) {
                 char scalp_markup[256];
                 snprintf(scalp_markup, sizeof(scalp_markup),
                         "<span size='small'>[S] <b>Scalp Signal:</b> <span foreground='%s'><b>%s</b></span></span>",
-                        signal_color, pair->scalp_signal);
+                        signal_color, scalp_signal_text(pair->scalp_signal));
                 gtk_label_set_markup(GTK_LABEL(scalp_label), scalp_markup);
                 gtk_widget_set_halign(scalp_label, GTK_ALIGN_START);
                 gtk_box_pack_start(GTK_BOX(enhanced_ta_box), scalp_label, FALSE, FALSE, 0);
@@ -694,6 +668,20 @@ static void gtk_ui_show_info(const char *message, void *user_data) {
     gtk_widget_destroy(dialog);
 }
 
+/* Alerts arrive from network callbacks, so the dialog must not block. */
+static void gtk_ui_show_alert(const char *message, void *user_data) {
+    GTKAppData *app = (GTKAppData *)user_data;
+    
+    GtkWidget *dialog = gtk_message_dialog_new(GTK_WINDOW(app->window),
+                                               GTK_DIALOG_DESTROY_WITH_PARENT,
+                                               GTK_MESSAGE_WARNING,
+                                               GTK_BUTTONS_CLOSE,
+                                               "%s", message);
+    gtk_window_set_title(GTK_WINDOW(dialog), "Alert");
+    g_signal_connect_swapped(dialog, "response", G_CALLBACK(gtk_widget_destroy), dialog);
+    gtk_widget_show_all(dialog);
+}
+
 
 static void on_add_pair_clicked(GtkButton *button, gpointer user_data) {
     GTKAppData *app = (GTKAppData *)user_data;
@@ -1040,6 +1028,73 @@ static void show_optimization_dialog(GTKAppData *app) {
     gtk_box_pack_start(GTK_BOX(main_box), gtk_separator_new(GTK_ORIENTATION_HORIZONTAL), FALSE, FALSE, 4);
     
     
+    DiversificationMetrics diversification;
+    if (portfolio_diversification(app->portfolio, &diversification)) {
+        char sym_a[MAX_SYMBOL_LEN], sym_b[MAX_SYMBOL_LEN];
+        strncpy(sym_a, app->portfolio->pairs[diversification.most_correlated_a].symbol, MAX_SYMBOL_LEN);
+        strncpy(sym_b, app->portfolio->pairs[diversification.most_correlated_b].symbol, MAX_SYMBOL_LEN);
+        for (int i = 0; sym_a[i]; i++) sym_a[i] = toupper((unsigned char)sym_a[i]);
+        for (int i = 0; sym_b[i]; i++) sym_b[i] = toupper((unsigned char)sym_b[i]);
+        
+        const char *corr_color = diversification.average_correlation > 0.7 ? "#ff453a" :
+                                 diversification.average_correlation > 0.4 ? "#ffd60a" : "#30d158";
+        
+        char div_text[768];
+        snprintf(div_text, sizeof(div_text),
+                 "<b>[D] Diversification</b>\n"
+                 "<span size='small'>Daily volatility: <b>%.2f%%</b>  |  Avg correlation: <span foreground='%s'><b>%.2f</b></span>\n"
+                 "Diversification ratio: <b>%.2f</b> (~%.1f independent bets)  |  Most correlated: %s / %s (%.2f)</span>",
+                 diversification.portfolio_volatility * sqrt(24.0) * 100.0,
+                 corr_color, diversification.average_correlation,
+                 diversification.diversification_ratio, diversification.effective_bets,
+                 sym_a, sym_b, diversification.max_correlation);
+        
+        GtkWidget *div_label = gtk_label_new(NULL);
+        gtk_label_set_markup(GTK_LABEL(div_label), div_text);
+        gtk_widget_set_halign(div_label, GTK_ALIGN_START);
+        gtk_widget_set_margin_start(div_label, 8);
+        gtk_box_pack_start(GTK_BOX(main_box), div_label, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(main_box), gtk_separator_new(GTK_ORIENTATION_HORIZONTAL), FALSE, FALSE, 4);
+    }
+    
+    
+    RebalanceSuggestion parity[MAX_PAIRS], min_variance[MAX_PAIRS], mean_variance[MAX_PAIRS];
+    if (portfolio_optimize(app->portfolio, OPTIMIZER_RISK_PARITY, parity) > 1) {
+        portfolio_optimize(app->portfolio, OPTIMIZER_MIN_VARIANCE, min_variance);
+        portfolio_optimize(app->portfolio, OPTIMIZER_MEAN_VARIANCE, mean_variance);
+        
+        char opt_text[4096] = "<b>[O] Suggested Rebalance (risk parity)</b>\n<span size='small'>";
+        char *o = opt_text + strlen(opt_text);
+        char *opt_end = opt_text + sizeof(opt_text) - 16;
+        
+        for (int i = 0; i < app->portfolio->pair_count && o < opt_end; i++) {
+            if (!parity[i].optimized) continue;
+            
+            char upper_sym[MAX_SYMBOL_LEN];
+            strncpy(upper_sym, app->portfolio->pairs[i].symbol, MAX_SYMBOL_LEN);
+            for (int j = 0; upper_sym[j]; j++) upper_sym[j] = toupper((unsigned char)upper_sym[j]);
+            
+            o += snprintf(o, opt_end - o,
+                          "%s: %.1f%% → <b>%.1f%%</b>  <span foreground='%s'>%s %.6f ($%.2f)</span>  "
+                          "<span foreground='#8e8e93'>min-var %.1f%% · mean-var %.1f%%</span>\n",
+                          upper_sym, parity[i].current_weight * 100.0, parity[i].target_weight * 100.0,
+                          parity[i].quantity_delta >= 0 ? "#30d158" : "#ff453a",
+                          parity[i].quantity_delta >= 0 ? "buy" : "sell",
+                          fabs(parity[i].quantity_delta), fabs(parity[i].value_delta),
+                          min_variance[i].target_weight * 100.0, mean_variance[i].target_weight * 100.0);
+        }
+        if (o > opt_end) o = opt_end;
+        snprintf(o, opt_text + sizeof(opt_text) - o, "</span>");
+        
+        GtkWidget *opt_label = gtk_label_new(NULL);
+        gtk_label_set_markup(GTK_LABEL(opt_label), opt_text);
+        gtk_widget_set_halign(opt_label, GTK_ALIGN_START);
+        gtk_widget_set_margin_start(opt_label, 8);
+        gtk_box_pack_start(GTK_BOX(main_box), opt_label, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(main_box), gtk_separator_new(GTK_ORIENTATION_HORIZONTAL), FALSE, FALSE, 4);
+    }
+    
+    
     GtkWidget *strategy_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
     gtk_widget_set_margin_start(strategy_box, 8);
     gtk_widget_set_margin_end(strategy_box, 8);
@@ -1170,7 +1225,7 @@ static void show_optimization_dialog(GTKAppData *app) {
             
             
             if (pair->historical_1h_loaded && pair->historical_1h_count > 20) {
-                char enhanced_ta_text[512];
+                char enhanced_ta_text[MAX_PATTERN_TEXT * 2 + 256];
                 const char *prob_color;
                 const char *prob_confidence;
                 double prob_pct = pair->profit_probability * 100.0;
@@ -1200,12 +1255,17 @@ static void show_optimization_dialog(GTKAppData *app) {
                                          mtf_trend == -1 ? "#ff453a" : 
                                          "#8e8e93";
                 
+                char pattern_text[MAX_PATTERN_TEXT];
+                format_pattern_hits(pair, pattern_text, sizeof(pattern_text));
+                gchar *escaped_patterns = g_markup_escape_text(pattern_text, -1);
+                
                 snprintf(enhanced_ta_text, sizeof(enhanced_ta_text),
                         "<span size='small'>[P] Profit Probability: <span foreground='%s'><b>%.1f%%</b></span> (%s)\n"
                         "[*] Patterns: <b>%s</b>  |  [T] Trend: <span foreground='%s'><b>%s</b></span></span>",
                         prob_color, prob_pct, prob_confidence,
-                        pair->pattern_count > 0 ? pair->detected_patterns : "None",
+                        escaped_patterns,
                         trend_color, trend_status);
+                g_free(escaped_patterns);
                 
                 GtkWidget *enhanced_ta_label = gtk_label_new(NULL);
                 gtk_label_set_markup(GTK_LABEL(enhanced_ta_label), enhanced_ta_text);
@@ -1336,27 +1396,179 @@ typedef struct {
     GtkWidget *dialog;
     NetworkManager *network;
     int pending_requests;
+    GtkWidget *filter_entry;
+    GtkWidget *filter_error;
+    char filter[256];
 } OpportunityFetchData;
 
-static const char* POPULAR_PAIRS[] = {
-    "BTCUSDT", "ETHUSDT", "BNBUSDT", "SOLUSDT", "XRPUSDT",
-    "ADAUSDT", "DOGEUSDT", "MATICUSDT", "DOTUSDT", "AVAXUSDT",
-    "LTCUSDT", "LINKUSDT", "ATOMUSDT", "UNIUSDT", "ARBUSDT"
+#define OPPORTUNITY_MAX 15
+
+/* Screened over every USDT market in one 24h ticker snapshot. The filter
+ * is the default for the dialog's filter entry. The rank adds the legacy
+ * star score (change and volume steps) to a sub-unit volume term that
+ * breaks ties in favour of the more liquid market. */
+#define OPPORTUNITY_FILTER "vol24h > 1e5 && close > 0"
+#define OPPORTUNITY_RANK "(change24h > 5) + (change24h > 2) + (change24h > 0) + 2 * (change24h < -5)" \
+                         " + (vol24h > 1e6) + (vol24h > 1e5) + min(vol24h / 1e12, 0.5)"
+
+enum {
+    OPP_CLOSE,
+    OPP_CHANGE,
+    OPP_VOLUME,
+    OPP_HIGH,
+    OPP_LOW,
+    OPP_COLUMN_COUNT
 };
-static const int POPULAR_PAIRS_COUNT = 15;
 
-static int compare_opportunities(const void *a, const void *b) {
-    const InvestmentOpportunity *opp_a = (const InvestmentOpportunity *)a;
-    const InvestmentOpportunity *opp_b = (const InvestmentOpportunity *)b;
-    
-    if (opp_a->score > opp_b->score) return -1;
-    if (opp_a->score < opp_b->score) return 1;
-    return 0;
-}
+static const char *const opportunity_columns[OPP_COLUMN_COUNT] = {
+    "close", "change24h", "vol24h", "high24h", "low24h"
+};
 
 static void update_opportunities_display(OpportunityFetchData *fetch_data, GtkWidget *main_box, 
                                          GtkWidget *header_label, GtkWidget *separator1);
 
+static void fill_opportunity(InvestmentOpportunity *opp, const char *symbol, double price,
+                             double change, double volume, int score) {
+    strncpy(opp->symbol, symbol, MAX_SYMBOL_LEN - 1);
+    opp->symbol[MAX_SYMBOL_LEN - 1] = '\0';
+    for (int j = 0; opp->symbol[j]; j++) {
+        opp->symbol[j] = tolower((unsigned char)opp->symbol[j]);
+    }
+    
+    opp->current_price = price;
+    opp->price_change_24h = change;
+    opp->volume_24h = volume;
+    opp->score = score;
+    
+    opp->trend = opp->price_change_24h > 2.0 ? 1 : (opp->price_change_24h < -2.0 ? -1 : 0);
+    opp->momentum = opp->price_change_24h;
+    
+    
+    if (opp->price_change_24h < -5.0) {
+        opp->suggested_buy_price = opp->current_price * 1.01;
+        opp->suggested_sell_price = opp->current_price * 1.15;
+    } else if (opp->price_change_24h > 10.0) {
+        opp->suggested_buy_price = opp->current_price * 0.93;
+        opp->suggested_sell_price = opp->current_price * 1.10;
+    } else if (opp->price_change_24h > 5.0) {
+        opp->suggested_buy_price = opp->current_price * 0.97;
+        opp->suggested_sell_price = opp->current_price * 1.12;
+    } else {
+        opp->suggested_buy_price = opp->current_price * 0.95;
+        opp->suggested_sell_price = opp->current_price * 1.10;
+    }
+}
+
+static void add_opportunity_columns(ScreenerTable *table, int *columns) {
+    for (int c = 0; c < OPP_COLUMN_COUNT; c++) {
+        columns[c] = screener_table_column(table, opportunity_columns[c]);
+    }
+}
+
+/* Compiles source against the columns the screen fills, so a bad filter is
+ * reported in the dialog before any market data is fetched. */
+static gboolean check_opportunity_filter(const char *source, char *error, size_t error_size) {
+    ScreenerTable *table = screener_table_create(1);
+    if (!table) {
+        snprintf(error, error_size, "out of memory");
+        return FALSE;
+    }
+    
+    int columns[OPP_COLUMN_COUNT];
+    add_opportunity_columns(table, columns);
+    ScreenerExpr *expr = screener_compile(table, source, error, error_size);
+    gboolean ok = expr != NULL;
+    
+    screener_expr_destroy(expr);
+    screener_table_destroy(table);
+    return ok;
+}
+
+static void show_filter_error(OpportunityFetchData *data, const char *error) {
+    if (!error || !error[0]) {
+        gtk_label_set_text(GTK_LABEL(data->filter_error), "");
+        return;
+    }
+    
+    char *markup = g_markup_printf_escaped("<span size='small' foreground='#ff453a'>%s</span>", error);
+    gtk_label_set_markup(GTK_LABEL(data->filter_error), markup);
+    g_free(markup);
+}
+
+static gboolean is_owned_symbol(const Portfolio *portfolio, const char *symbol) {
+    for (int i = 0; i < portfolio->pair_count; i++) {
+        if (g_ascii_strcasecmp(symbol, portfolio->pairs[i].symbol) == 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* Loads the all-symbol ticker array into a screener table, then keeps the
+ * best ranked markets the portfolio does not hold yet. */
+static void screen_opportunities(OpportunityFetchData *data, struct json_object *tickers) {
+    ScreenerTable *table = screener_table_create((int)json_object_array_length(tickers));
+    if (!table) return;
+    
+    int columns[OPP_COLUMN_COUNT];
+    add_opportunity_columns(table, columns);
+    
+    size_t ticker_count = json_object_array_length(tickers);
+    for (size_t i = 0; i < ticker_count; i++) {
+        struct json_object *ticker = json_object_array_get_idx(tickers, i);
+        struct json_object *symbol_obj, *price_obj, *change_obj, *volume_obj, *high_obj, *low_obj;
+        
+        if (!json_object_object_get_ex(ticker, "symbol", &symbol_obj) ||
+            !json_object_object_get_ex(ticker, "lastPrice", &price_obj) ||
+            !json_object_object_get_ex(ticker, "priceChangePercent", &change_obj) ||
+            !json_object_object_get_ex(ticker, "quoteVolume", &volume_obj)) {
+            continue;
+        }
+        
+        const char *symbol = json_object_get_string(symbol_obj);
+        size_t length = strlen(symbol);
+        if (length <= 4 || strcmp(symbol + length - 4, "USDT") != 0) continue;
+        
+        int row = screener_table_row(table, symbol);
+        screener_table_set(table, row, columns[OPP_CLOSE], json_object_get_double(price_obj));
+        screener_table_set(table, row, columns[OPP_CHANGE], json_object_get_double(change_obj));
+        screener_table_set(table, row, columns[OPP_VOLUME], json_object_get_double(volume_obj));
+        if (json_object_object_get_ex(ticker, "highPrice", &high_obj)) {
+            screener_table_set(table, row, columns[OPP_HIGH], json_object_get_double(high_obj));
+        }
+        if (json_object_object_get_ex(ticker, "lowPrice", &low_obj)) {
+            screener_table_set(table, row, columns[OPP_LOW], json_object_get_double(low_obj));
+        }
+    }
+    
+    char error[128];
+    ScreenerExpr *filter = screener_compile(table, data->filter, error, sizeof(error));
+    ScreenerExpr *rank = screener_compile(table, OPPORTUNITY_RANK, error, sizeof(error));
+    if (filter && rank) {
+        ScreenerMatch matches[OPPORTUNITY_MAX + MAX_PAIRS];
+        int match_count = screener_run(table, filter, rank, matches, OPPORTUNITY_MAX + MAX_PAIRS);
+        
+        for (int i = 0; i < match_count && *data->opp_count < OPPORTUNITY_MAX; i++) {
+            int row = matches[i].row;
+            const char *symbol = screener_table_symbol(table, row);
+            if (is_owned_symbol(data->app->portfolio, symbol)) continue;
+            
+            fill_opportunity(&data->opportunities[*data->opp_count], symbol,
+                             screener_table_get(table, row, columns[OPP_CLOSE]),
+                             screener_table_get(table, row, columns[OPP_CHANGE]),
+                             screener_table_get(table, row, columns[OPP_VOLUME]),
+                             (int)matches[i].rank);
+            (*data->opp_count)++;
+        }
+    } else {
+        show_filter_error(data, error);
+    }
+    
+    screener_expr_destroy(filter);
+    screener_expr_destroy(rank);
+    screener_table_destroy(table);
+}
+
 static void fetch_opportunity_24h_callback(SoupSession *session, SoupMessage *msg, gpointer user_data) {
     OpportunityFetchData *data = (OpportunityFetchData *)user_data;
     
@@ -1375,72 +1587,8 @@ static void fetch_opportunity_24h_callback(SoupSession *session, SoupMessage *ms
     if (msg->status_code == 200) {
         struct json_object *root = json_tokener_parse(msg->response_body->data);
         if (root) {
-            struct json_object *symbol_obj, *price_obj, *change_obj, *volume_obj;
-            
-            if (json_object_object_get_ex(root, "symbol", &symbol_obj) &&
-                json_object_object_get_ex(root, "lastPrice", &price_obj) &&
-                json_object_object_get_ex(root, "priceChangePercent", &change_obj) &&
-                json_object_object_get_ex(root, "volume", &volume_obj)) {
-                
-                const char *symbol = json_object_get_string(symbol_obj);
-                
-                
-                gboolean already_owned = FALSE;
-                for (int i = 0; i < data->app->portfolio->pair_count; i++) {
-                    char upper_symbol[MAX_SYMBOL_LEN];
-                    strncpy(upper_symbol, data->app->portfolio->pairs[i].symbol, MAX_SYMBOL_LEN - 1);
-                    for (int j = 0; upper_symbol[j]; j++) {
-                        upper_symbol[j] = toupper((unsigned char)upper_symbol[j]);
-                    }
-                    if (strcmp(symbol, upper_symbol) == 0) {
-                        already_owned = TRUE;
-                        break;
-                    }
-                }
-                
-                if (!already_owned && *data->opp_count < 15) {
-                    InvestmentOpportunity *opp = &data->opportunities[*data->opp_count];
-                    
-                    
-                    strncpy(opp->symbol, symbol, MAX_SYMBOL_LEN - 1);
-                    for (int j = 0; opp->symbol[j]; j++) {
-                        opp->symbol[j] = tolower((unsigned char)opp->symbol[j]);
-                    }
-                    
-                    opp->current_price = json_object_get_double(price_obj);
-                    opp->price_change_24h = json_object_get_double(change_obj);
-                    opp->volume_24h = json_object_get_double(volume_obj);
-                    
-                    
-                    opp->score = 0;
-                    if (opp->price_change_24h > 5.0) opp->score += 3;
-                    else if (opp->price_change_24h > 2.0) opp->score += 2;
-                    else if (opp->price_change_24h > 0) opp->score += 1;
-                    else if (opp->price_change_24h < -5.0) opp->score += 2; 
-                    
-                    if (opp->volume_24h > 1000000) opp->score += 2;
-                    else if (opp->volume_24h > 100000) opp->score += 1;
-                    
-                    opp->trend = opp->price_change_24h > 2.0 ? 1 : (opp->price_change_24h < -2.0 ? -1 : 0);
-                    opp->momentum = opp->price_change_24h;
-                    
-                    
-                    if (opp->price_change_24h < -5.0) {
-                        opp->suggested_buy_price = opp->current_price * 1.01;
-                        opp->suggested_sell_price = opp->current_price * 1.15;
-                    } else if (opp->price_change_24h > 10.0) {
-                        opp->suggested_buy_price = opp->current_price * 0.93;
-                        opp->suggested_sell_price = opp->current_price * 1.10;
-                    } else if (opp->price_change_24h > 5.0) {
-                        opp->suggested_buy_price = opp->current_price * 0.97;
-                        opp->suggested_sell_price = opp->current_price * 1.12;
-                    } else {
-                        opp->suggested_buy_price = opp->current_price * 0.95;
-                        opp->suggested_sell_price = opp->current_price * 1.10;
-                    }
-                    
-                    (*data->opp_count)++;
-                }
+            if (json_object_is_type(root, json_type_array)) {
+                screen_opportunities(data, root);
             }
             json_object_put(root);
         }
@@ -1453,9 +1601,6 @@ static void fetch_opportunity_24h_callback(SoupSession *session, SoupMessage *ms
         printf("Loaded %d investment opportunities\n", *data->opp_count);
         
         
-        qsort(data->opportunities, *data->opp_count, sizeof(InvestmentOpportunity), compare_opportunities);
-        
-        
         if (data->dialog && GTK_IS_WIDGET(data->dialog)) {
             GtkWidget *content_area = gtk_dialog_get_content_area(GTK_DIALOG(data->dialog));
             GList *children = gtk_container_get_children(GTK_CONTAINER(content_area));
@@ -1487,18 +1632,9 @@ static void fetch_opportunity_24h_callback(SoupSession *session, SoupMessage *ms
 }
 
 static void discover_investment_opportunities(OpportunityFetchData *data) {
-    data->pending_requests = 0;
-    
-    for (int i = 0; i < POPULAR_PAIRS_COUNT; i++) {
-        char url[512];
-        snprintf(url, sizeof(url),
-                "https://api.binance.com/api/v3/ticker/24hr?symbol=%s",
-                POPULAR_PAIRS[i]);
-        
-        SoupMessage *msg = soup_message_new("GET", url);
-        soup_session_queue_message(data->network->session, msg, fetch_opportunity_24h_callback, data);
-        data->pending_requests++;
-    }
+    SoupMessage *msg = soup_message_new("GET", "https://api.binance.com/api/v3/ticker/24hr");
+    soup_session_queue_message(data->network->session, msg, fetch_opportunity_24h_callback, data);
+    data->pending_requests = 1;
 }
 
 static void update_opportunities_display(OpportunityFetchData *fetch_data, GtkWidget *main_box,
@@ -1659,6 +1795,19 @@ static void on_opportunities_dialog_response(GtkDialog *dialog, gint response_id
     OpportunityFetchData *fetch_data = (OpportunityFetchData *)user_data;
     
     if (response_id == GTK_RESPONSE_APPLY) {
+        const char *source = gtk_entry_get_text(GTK_ENTRY(fetch_data->filter_entry));
+        if (!source[0]) {
+            source = OPPORTUNITY_FILTER;
+            gtk_entry_set_text(GTK_ENTRY(fetch_data->filter_entry), source);
+        }
+        
+        char error[128];
+        if (!check_opportunity_filter(source, error, sizeof(error))) {
+            show_filter_error(fetch_data, error);
+            return;
+        }
+        show_filter_error(fetch_data, NULL);
+        g_strlcpy(fetch_data->filter, source, sizeof(fetch_data->filter));
         
         *fetch_data->opp_count = 0;
         
@@ -1715,7 +1864,7 @@ static void on_opportunities_dialog_response(GtkDialog *dialog, gint response_id
 
 static void show_opportunities_dialog(GTKAppData *app) {
     
-    InvestmentOpportunity *opportunities = g_malloc0(15 * sizeof(InvestmentOpportunity));
+    InvestmentOpportunity *opportunities = g_malloc0(OPPORTUNITY_MAX * sizeof(InvestmentOpportunity));
     int *opp_count = g_malloc0(sizeof(int));
     *opp_count = 0;
     
@@ -1746,7 +1895,7 @@ static void show_opportunities_dialog(GTKAppData *app) {
     GtkWidget *header_label = gtk_label_new(NULL);
     gtk_label_set_markup(GTK_LABEL(header_label),
                         "<b><span size='large'>[O] Discover New Investment Opportunities</span></b>\n"
-                        "<span size='small'>Popular crypto assets not currently in your portfolio</span>");
+                        "<span size='small'>Top-ranked USDT markets not currently in your portfolio</span>");
     gtk_widget_set_halign(header_label, GTK_ALIGN_CENTER);
     gtk_box_pack_start(GTK_BOX(main_box), header_label, FALSE, FALSE, 0);
     
@@ -1763,6 +1912,33 @@ static void show_opportunities_dialog(GTKAppData *app) {
     
     gtk_container_add(GTK_CONTAINER(scrolled), main_box);
     gtk_container_add(GTK_CONTAINER(content_area), scrolled);
+    
+    
+    GtkWidget *filter_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+    gtk_container_set_border_width(GTK_CONTAINER(filter_box), 8);
+    GtkWidget *filter_label = gtk_label_new("Filter:");
+    GtkWidget *filter_entry = gtk_entry_new();
+    gtk_entry_set_text(GTK_ENTRY(filter_entry), OPPORTUNITY_FILTER);
+    gtk_entry_set_activates_default(GTK_ENTRY(filter_entry), TRUE);
+    gtk_widget_set_tooltip_text(filter_entry, "e.g. change24h < -5 && vol24h > 1e6. Press Enter to apply.");
+    gtk_box_pack_start(GTK_BOX(filter_box), filter_label, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(filter_box), filter_entry, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(content_area), filter_box, FALSE, FALSE, 0);
+    
+    GtkWidget *filter_note = gtk_label_new(NULL);
+    gtk_label_set_markup(GTK_LABEL(filter_note),
+                        "<span size='small' foreground='#98989d'>Markets you don't track have only their 24h ticker: "
+                        "close, change24h, vol24h, high24h, low24h</span>");
+    gtk_widget_set_halign(filter_note, GTK_ALIGN_START);
+    gtk_widget_set_margin_start(filter_note, 8);
+    gtk_box_pack_start(GTK_BOX(content_area), filter_note, FALSE, FALSE, 0);
+    
+    GtkWidget *filter_error = gtk_label_new(NULL);
+    gtk_widget_set_halign(filter_error, GTK_ALIGN_START);
+    gtk_widget_set_margin_start(filter_error, 8);
+    gtk_box_pack_start(GTK_BOX(content_area), filter_error, FALSE, FALSE, 0);
+    
+    gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_APPLY);
     gtk_widget_show_all(content_area);
     
     
@@ -1773,6 +1949,9 @@ static void show_opportunities_dialog(GTKAppData *app) {
     fetch_data->dialog = dialog;
     fetch_data->network = app->network;
     fetch_data->pending_requests = 0;
+    fetch_data->filter_entry = filter_entry;
+    fetch_data->filter_error = filter_error;
+    g_strlcpy(fetch_data->filter, OPPORTUNITY_FILTER, sizeof(fetch_data->filter));
     
     
     g_signal_connect(dialog, "destroy", G_CALLBACK(on_opportunities_dialog_destroy), fetch_data);
@@ -1978,6 +2157,15 @@ static void on_add_bot_clicked(GtkButton *button, gpointer user_data) {
     gtk_entry_set_placeholder_text(GTK_ENTRY(amount_entry), "e.g., 100");
     
     
+    GtkWidget *strategy_label = gtk_label_new("Strategy:");
+    gtk_widget_set_halign(strategy_label, GTK_ALIGN_START);
+    GtkWidget *strategy_combo = gtk_combo_box_text_new();
+    for (int i = 0; i < bot_strategy_count(); i++) {
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(strategy_combo), bot_strategy_at(i)->name);
+    }
+    gtk_combo_box_set_active(GTK_COMBO_BOX(strategy_combo), 0);
+    
+    
     GtkWidget *info_label = gtk_label_new(NULL);
     gtk_label_set_markup(GTK_LABEL(info_label),
         "<span size='small'><i>Bot will execute mock trades based on scalping signals.\n"
@@ -1991,7 +2179,9 @@ static void on_add_bot_clicked(GtkButton *button, gpointer user_data) {
     gtk_grid_attach(GTK_GRID(grid), balance_entry, 1, 1, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), amount_label, 0, 2, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), amount_entry, 1, 2, 1, 1);
-    gtk_grid_attach(GTK_GRID(grid), info_label, 0, 3, 2, 1);
+    gtk_grid_attach(GTK_GRID(grid), strategy_label, 0, 3, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), strategy_combo, 1, 3, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), info_label, 0, 4, 2, 1);
     
     gtk_container_add(GTK_CONTAINER(content), grid);
     gtk_widget_show_all(dialog);
@@ -2002,12 +2192,13 @@ static void on_add_bot_clicked(GtkButton *button, gpointer user_data) {
         const char *symbol = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(symbol_combo));
         const char *balance_text = gtk_entry_get_text(GTK_ENTRY(balance_entry));
         const char *amount_text = gtk_entry_get_text(GTK_ENTRY(amount_entry));
+        const BotStrategy *strategy = bot_strategy_at(gtk_combo_box_get_active(GTK_COMBO_BOX(strategy_combo)));
         
         double balance = atof(balance_text);
         double amount = atof(amount_text);
         
         if (balance > 0 && amount > 0 && amount <= balance) {
-            int bot_index = bot_add(app->bot_manager, symbol, balance, amount);
+            int bot_index = bot_add_strategy(app->bot_manager, symbol, balance, amount, strategy);
             if (bot_index >= 0) {
                 bot_start(app->bot_manager, bot_index);
                 
@@ -2030,7 +2221,7 @@ static void on_add_bot_clicked(GtkButton *button, gpointer user_data) {
                 gtk_widget_destroy(success);
                 
                 
-                bot_update_statistics(&app->bot_manager->bots[bot_index]);
+                bot_update_statistics(bot_manager_get(app->bot_manager, bot_index));
             } else {
                 GtkWidget *error = gtk_message_dialog_new(
                     GTK_WINDOW(gtk_widget_get_toplevel(GTK_WIDGET(button))),
@@ -2107,10 +2298,9 @@ static void show_bots_dialog(GTKAppData *app) {
     
     
     int active_bots = 0;
-    for (int i = 0; i < MAX_BOTS; i++) {
-        if (!app->bot_manager->bots[i].active) continue;
-        
-        ScalpingBot *bot = &app->bot_manager->bots[i];
+    for (int n = 0; n < app->bot_manager->bot_count; n++) {
+        int i = app->bot_manager->active[n];
+        ScalpingBot *bot = bot_manager_get(app->bot_manager, i);
         active_bots++;
         
         
@@ -2153,7 +2343,8 @@ static void show_bots_dialog(GTKAppData *app) {
         GtkWidget *symbol_label = gtk_label_new(NULL);
         char symbol_markup[128];
         snprintf(symbol_markup, sizeof(symbol_markup),
-                "<b><span size='large'>Bot #%d - %s</span></b>", i + 1, upper_symbol);
+                "<b><span size='large'>Bot #%d - %s</span></b> <span size='small'>%s</span>",
+                i + 1, upper_symbol, bot->strategy->name);
         gtk_label_set_markup(GTK_LABEL(symbol_label), symbol_markup);
         gtk_widget_set_halign(symbol_label, GTK_ALIGN_START);
         gtk_widget_set_hexpand(symbol_label, TRUE);
@@ -2246,17 +2437,15 @@ static void show_bots_dialog(GTKAppData *app) {
             gtk_widget_set_margin_top(trades_label, 4);
             gtk_box_pack_start(GTK_BOX(bot_card), trades_label, FALSE, FALSE, 0);
             
-            int start_idx = bot->trade_count > 5 ? bot->trade_count - 5 : 0;
-            int display_start = (bot->trade_index - (bot->trade_count - start_idx) + MAX_TRADES_HISTORY) % MAX_TRADES_HISTORY;
+            int shown = bot->trade_count > 5 ? 5 : bot->trade_count;
             
-            for (int j = 0; j < (bot->trade_count > 5 ? 5 : bot->trade_count); j++) {
-                int idx = (display_start + j) % MAX_TRADES_HISTORY;
-                TradeRecord *trade = &bot->trades[idx];
+            for (int j = shown - 1; j >= 0; j--) {
+                const TradeRecord *trade = bot_recent_trade(bot, j);
                 
                 char trade_text[400];
                 const char *action_color = strcmp(trade->action, "BUY") == 0 ? "#30d158" : "#ff9500";
                 
-                time_t now = time(NULL);
+                time_t now = clock_now(NULL);
                 int seconds_ago = (int)difftime(now, trade->timestamp);
                 char time_str[64];
                 if (seconds_ago < 60) {
@@ -0,0 +1,394 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/* Replays 5m candles from a kline CSV through backtest_run and prints the
+ * trade log and equity curve, or with -g sweeps parameter ranges over them
+ * and prints the configurations ranked. Rows are open_time,open,high,low,close,volume
+ * with any further columns ignored, as in exchange kline exports; lines
+ * that do not start with a digit are skipped as headers. A row that does
+ * not parse, or one off the 5m grid, stops the load: backtest_run times
+ * fills and annualizes Sharpe for 5m candles. */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "portfolio/backtest.h"
+#include "portfolio/sweep.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LINE_LEN 1024
+#define MAX_SWEEP_RUNS 1000000
+
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] SYMBOL CANDLES.csv\n"
+            "  -s NAME    bot strategy (default %s)\n"
+            "  -x POLICY  fill model: close, taker, maker or auto (default close)\n"
+            "  -b USD     initial balance\n"
+            "  -a USD     trade amount\n"
+            "  -c SEC     cooldown between trades\n"
+            "  -e N       candles per equity point\n"
+            "Sweep options:\n"
+            "  -g NAME=MIN[:MAX[:STEPS]]  sweep a parameter, repeatable\n"
+            "  -n N       draw N random configurations instead of the full grid\n"
+            "  -S SEED    seed for -n\n"
+            "  -r RANK    order by roi, drawdown or sharpe (default roi)\n"
+            "  -t N       configurations to print (default 20)\n"
+            "Parameters:",
+            prog, bot_strategy_default()->name);
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+        fprintf(stderr, " %s", sweep_param_name(p));
+    }
+    fprintf(stderr, "\n");
+}
+
+
+static Candle* load_candles(const char *path, int *count) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return NULL;
+    }
+    
+    int capacity = 4096;
+    Candle *candles = malloc(capacity * sizeof(Candle));
+    char line[LINE_LEN];
+    int n = 0, line_number = 0, gaps = 0;
+    long long min_step = 0;
+    const char *error = NULL;
+    
+    while (candles && fgets(line, sizeof(line), fp)) {
+        line_number++;
+        if (!isdigit((unsigned char)line[0])) continue;
+        
+        Candle c;
+        if (sscanf(line, "%lld,%lf,%lf,%lf,%lf,%lf", &c.open_time, &c.open,
+                   &c.high, &c.low, &c.close, &c.volume) != 6) {
+            error = "row does not parse";
+            break;
+        }
+        
+        /* Newer exports stamp candles in microseconds */
+        if (c.open_time > 100000000000000LL) c.open_time /= 1000;
+        
+        if (n > 0) {
+            long long step = c.open_time - candles[n - 1].open_time;
+            if (step <= 0) {
+                error = "candles out of order";
+                break;
+            }
+            if (step % BACKTEST_CANDLE_MS != 0) {
+                error = "candle is not 5m after the previous one";
+                break;
+            }
+            if (step > BACKTEST_CANDLE_MS) gaps++;
+            if (min_step == 0 || step < min_step) min_step = step;
+        }
+        
+        if (n == capacity) {
+            capacity *= 2;
+            Candle *grown = realloc(candles, capacity * sizeof(Candle));
+            if (!grown) {
+                free(candles);
+                candles = NULL;
+                break;
+            }
+            candles = grown;
+        }
+        candles[n++] = c;
+    }
+    
+    fclose(fp);
+    if (error) {
+        fprintf(stderr, "%s:%d: %s\n", path, line_number, error);
+        free(candles);
+        return NULL;
+    }
+    if (min_step > BACKTEST_CANDLE_MS) {
+        fprintf(stderr, "%s: candles are at least %lld minutes apart, not 5m\n", path, min_step / 60000);
+        free(candles);
+        return NULL;
+    }
+    if (gaps > 0) {
+        fprintf(stderr, "%s: %d gaps of missing candles\n", path, gaps);
+    }
+    *count = n;
+    return candles;
+}
+
+
+static void format_time(long long time_ms, char *buffer, size_t size) {
+    time_t seconds = (time_t)(time_ms / 1000);
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    strftime(buffer, size, "%Y-%m-%d %H:%M", &tm);
+}
+
+
+static bool parse_execution(const char *name, ExecutionModel *model, const ExecutionModel **execution) {
+    if (strcmp(name, "close") == 0) {
+        *execution = NULL;
+        return true;
+    }
+    
+    FillParams params;
+    fill_params_default(&params);
+    if (strcmp(name, "taker") == 0) {
+        params.policy = FILL_TAKER;
+    } else if (strcmp(name, "maker") == 0) {
+        params.policy = FILL_MAKER;
+    } else if (strcmp(name, "auto") == 0) {
+        params.policy = FILL_AUTO;
+    } else {
+        return false;
+    }
+    execution_model_init(model, &params);
+    *execution = model;
+    return true;
+}
+
+
+static void print_result(const BacktestResult *result, double seconds) {
+    char when[32];
+    
+    printf("Trades\n");
+    for (int i = 0; i < result->trade_count; i++) {
+        const TradeRecord *trade = &result->trades[i];
+        format_time((long long)trade->timestamp * 1000, when, sizeof(when));
+        printf("  %s  %-5s %14.6f %14.8f  fee %10.6f  balance %12.2f  %s\n",
+               when, trade->action, trade->price, trade->quantity, trade->fee,
+               trade->balance_after, scalp_signal_text(trade->signal));
+    }
+    
+    printf("\nEquity\n");
+    for (int i = 0; i < result->equity_count; i++) {
+        format_time(result->equity[i].time_ms, when, sizeof(when));
+        printf("  %s  %12.2f\n", when, result->equity[i].equity);
+    }
+    
+    printf("\nCandles:        %ld (%.0f/s)\n", result->candles,
+           seconds > 0 ? result->candles / seconds : 0.0);
+    printf("Final equity:   %.2f\n", result->final_equity);
+    printf("ROI:            %.2f%%\n", result->roi);
+    printf("Max drawdown:   %.2f%%\n", result->max_drawdown * 100.0);
+    printf("Sharpe:         %.3f\n", result->sharpe);
+    printf("Trades:         %d (%d won, %d lost, %d cancelled)\n", result->total_trades,
+           result->winning_trades, result->losing_trades, result->cancelled_orders);
+}
+
+
+static bool parse_range(const char *arg, SweepParam *param, SweepRange *range) {
+    const char *eq = strchr(arg, '=');
+    if (!eq) return false;
+    
+    size_t len = (size_t)(eq - arg);
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+        const char *name = sweep_param_name(p);
+        if (strlen(name) == len && strncmp(arg, name, len) == 0) {
+            *param = p;
+            range->steps = 1;
+            int fields = sscanf(eq + 1, "%lf:%lf:%d", &range->min, &range->max, &range->steps);
+            if (fields == 1) range->max = range->min;
+            /* Without a step count a span is swept at its ends, or drawn from with -n */
+            if (fields == 2 && range->max != range->min) range->steps = 2;
+            return fields >= 1;
+        }
+    }
+    return false;
+}
+
+
+static bool parse_rank(const char *name, SweepRank *rank) {
+    if (strcmp(name, "roi") == 0) {
+        *rank = SWEEP_RANK_ROI;
+    } else if (strcmp(name, "drawdown") == 0) {
+        *rank = SWEEP_RANK_DRAWDOWN;
+    } else if (strcmp(name, "sharpe") == 0) {
+        *rank = SWEEP_RANK_SHARPE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+
+static int run_sweep(const SweepSpace *space, const bool *swept, SweepRank rank, int top,
+                     const char *symbol, const Candle *candles, int count) {
+    long size = sweep_size(space);
+    if (size > MAX_SWEEP_RUNS) {
+        fprintf(stderr, "Sweep has more than %d configurations\n", MAX_SWEEP_RUNS);
+        return 1;
+    }
+    
+    SweepResult *results = malloc((size_t)size * sizeof(SweepResult));
+    if (!results) return 1;
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int runs = sweep_run(worker_pool_default(), space, symbol, candles, count, results, (int)size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    
+    sweep_rank(results, runs, rank);
+    
+    printf("%4s", "#");
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+        if (swept[p]) printf(" %14s", sweep_param_name(p));
+    }
+    printf(" %9s %9s %8s %7s\n", "roi%", "maxdd%", "sharpe", "trades");
+    
+    for (int i = 0; i < runs && i < top && results[i].ok; i++) {
+        const SweepResult *r = &results[i];
+        printf("%4d", i + 1);
+        for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+            if (swept[p]) printf(" %14.6g", r->values[p]);
+        }
+        printf(" %9.2f %9.2f %8.3f %7d\n", r->roi, r->max_drawdown * 100.0, r->sharpe,
+               r->total_trades);
+    }
+    
+    printf("\n%d configurations over %d candles in %.2fs\n", runs, count, seconds);
+    free(results);
+    return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+    BacktestConfig config;
+    backtest_config_default(&config);
+    ExecutionModel model;
+    SweepRange ranges[SWEEP_PARAM_COUNT];
+    bool swept[SWEEP_PARAM_COUNT] = { false };
+    bool sweep = false;
+    int samples = 0;
+    unsigned int seed = 1;
+    SweepRank rank = SWEEP_RANK_ROI;
+    int top = 20;
+    int opt;
+    
+    while ((opt = getopt(argc, argv, "s:x:b:a:c:e:g:n:S:r:t:h")) != -1) {
+        SweepParam param;
+        SweepRange range;
+        switch (opt) {
+            case 's':
+                config.strategy = bot_strategy_find(optarg);
+                if (!config.strategy) {
+                    fprintf(stderr, "Unknown strategy: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'x':
+                if (!parse_execution(optarg, &model, &config.execution)) {
+                    fprintf(stderr, "Unknown fill model: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'b':
+                config.initial_balance = atof(optarg);
+                break;
+            case 'a':
+                config.trade_amount = atof(optarg);
+                break;
+            case 'c':
+                config.cooldown_seconds = atoi(optarg);
+                break;
+            case 'e':
+                config.equity_stride = atoi(optarg);
+                break;
+            case 'g':
+                if (!parse_range(optarg, &param, &range)) {
+                    fprintf(stderr, "Bad range: %s\n", optarg);
+                    return 1;
+                }
+                ranges[param] = range;
+                swept[param] = true;
+                sweep = true;
+                break;
+            case 'n':
+                samples = atoi(optarg);
+                break;
+            case 'S':
+                seed = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                if (!parse_rank(optarg, &rank)) {
+                    fprintf(stderr, "Unknown ranking: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 't':
+                top = atoi(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    
+    if (argc - optind != 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    const char *symbol = argv[optind];
+    int count = 0;
+    Candle *candles = load_candles(argv[optind + 1], &count);
+    if (!candles) return 1;
+    
+    if (sweep) {
+        SweepSpace space;
+        sweep_space_default(&space);
+        sweep_set_range(&space, SWEEP_COOLDOWN, config.cooldown_seconds, config.cooldown_seconds, 1);
+        sweep_set_range(&space, SWEEP_TRADE_AMOUNT, config.trade_amount, config.trade_amount, 1);
+        for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+            if (swept[p]) sweep_set_range(&space, p, ranges[p].min, ranges[p].max, ranges[p].steps);
+        }
+        space.samples = samples;
+        space.seed = seed;
+        space.initial_balance = config.initial_balance;
+        space.execution = config.execution;
+        space.strategy = config.strategy;
+        
+        int status = run_sweep(&space, swept, rank, top, symbol, candles, count);
+        free(candles);
+        return status;
+    }
+    
+    BacktestResult result;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool ok = backtest_run(&config, symbol, candles, count, &result);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free(candles);
+    
+    if (!ok) {
+        fprintf(stderr, "Backtest failed on %d candles\n", count);
+        return 1;
+    }
+    
+    print_result(&result, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+    backtest_result_free(&result);
+    return 0;
+}
@@ -0,0 +1,291 @@
+/*
+ * Kai 2006@
+ *
+ * Copyright (C) 2006 Kai 2006@
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Times the pivot-based chart-pattern detectors against the rescanning
+ * detectors they replaced, which are copied below unchanged. Run with
+ * "make bench". */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "portfolio/portfolio_core.h"
+#include "portfolio/pivot_engine.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_CANDLES 100000
+#define CUBIC_CANDLES 5000
+
+
+typedef bool (*ArrayDetector)(const double *prices, int count, int *pattern_idx);
+typedef bool (*PivotDetector)(const PivotTracker *tracker, int *pattern_idx);
+
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+
+static bool legacy_double_bottom(const double *prices, int count, int *pattern_idx) {
+    if (!prices || count < 20 || !pattern_idx) {
+        return false;
+    }
+    
+    *pattern_idx = -1;
+    for (int i = 10; i < count - 10; i++) {
+        double current_price = prices[i];
+        
+        bool is_local_min = true;
+        for (int j = i - 5; j <= i + 5; j++) {
+            if (j != i && prices[j] < current_price) {
+                is_local_min = false;
+                break;
+            }
+        }
+        if (!is_local_min) continue;
+        
+        for (int j = i + 10; j < count - 5; j++) {
+            double diff_percent = fabs(prices[j] - current_price) / current_price;
+            if (diff_percent < 0.02) {
+                double max_between = current_price;
+                for (int k = i; k <= j; k++) {
+                    if (prices[k] > max_between) {
+                        max_between = prices[k];
+                    }
+                }
+                if ((max_between - current_price) / current_price > 0.03) {
+                    *pattern_idx = j;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+static bool legacy_double_top(const double *prices, int count, int *pattern_idx) {
+    if (!prices || count < 20 || !pattern_idx) {
+        return false;
+    }
+    
+    *pattern_idx = -1;
+    for (int i = 10; i < count - 10; i++) {
+        double current_price = prices[i];
+        
+        bool is_local_max = true;
+        for (int j = i - 5; j <= i + 5; j++) {
+            if (j != i && prices[j] > current_price) {
+                is_local_max = false;
+                break;
+            }
+        }
+        if (!is_local_max) continue;
+        
+        for (int j = i + 10; j < count - 5; j++) {
+            double diff_percent = fabs(prices[j] - current_price) / current_price;
+            if (diff_percent < 0.02) {
+                double min_between = current_price;
+                for (int k = i; k <= j; k++) {
+                    if (prices[k] < min_between) {
+                        min_between = prices[k];
+                    }
+                }
+                if ((current_price - min_between) / current_price > 0.03) {
+                    *pattern_idx = j;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+static bool legacy_head_shoulders(const double *prices, int count, int *pattern_idx) {
+    if (!prices || count < 30 || !pattern_idx) {
+        return false;
+    }
+    
+    *pattern_idx = -1;
+    for (int head = 15; head < count - 15; head++) {
+        double head_price = prices[head];
+        
+        bool is_local_max = true;
+        for (int j = head - 5; j <= head + 5; j++) {
+            if (j != head && prices[j] > head_price) {
+                is_local_max = false;
+                break;
+            }
+        }
+        if (!is_local_max) continue;
+        
+        for (int left = head - 15; left < head - 5; left++) {
+            if (prices[left] < head_price * 0.95) continue;
+            for (int right = head + 5; right < head + 15 && right < count; right++) {
+                if (prices[right] < head_price * 0.95) continue;
+                if (fabs(prices[left] - prices[right]) / prices[left] < 0.03) {
+                    *pattern_idx = right;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+static bool legacy_inverse_head_shoulders(const double *prices, int count, int *pattern_idx) {
+    if (!prices || count < 30 || !pattern_idx) {
+        return false;
+    }
+    
+    *pattern_idx = -1;
+    for (int head = 15; head < count - 15; head++) {
+        double head_price = prices[head];
+        
+        bool is_local_min = true;
+        for (int j = head - 5; j <= head + 5; j++) {
+            if (j != head && prices[j] < head_price) {
+                is_local_min = false;
+                break;
+            }
+        }
+        if (!is_local_min) continue;
+        
+        for (int left = head - 15; left < head - 5; left++) {
+            if (prices[left] > head_price * 1.05) continue;
+            for (int right = head + 5; right < head + 15 && right < count; right++) {
+                if (prices[right] > head_price * 1.05) continue;
+                if (fabs(prices[left] - prices[right]) / prices[left] < 0.03) {
+                    *pattern_idx = right;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+/* A triangle wave of +-amplitude around a price growing by growth per candle. */
+static void zigzag(double *prices, int count, int period, double amplitude, double growth) {
+    double base = 100.0;
+    for (int i = 0; i < count; i++) {
+        double phase = (double)(i % period) / period;
+        double wave = (phase < 0.5) ? 4.0 * phase - 1.0 : 3.0 - 4.0 * phase;
+        prices[i] = base * (1.0 + amplitude * wave);
+        base *= 1.0 + growth;
+    }
+}
+
+
+static void random_walk(double *prices, int count, unsigned int seed) {
+    double price = 100.0;
+    srand(seed);
+    for (int i = 0; i < count; i++) {
+        price *= 1.0 + ((rand() % 2001) - 1000) / 100000.0;
+        prices[i] = price;
+    }
+}
+
+
+/* Best of runs, to keep the fast paths above timer noise. */
+static double time_array(ArrayDetector detector, const double *prices, int count, int runs,
+                         bool *found, int *idx) {
+    double best = INFINITY;
+    for (int r = 0; r < runs; r++) {
+        double start = now_ms();
+        *found = detector(prices, count, idx);
+        double elapsed = now_ms() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+
+static double time_pivot(PivotDetector detector, const PivotTracker *tracker, int runs, bool *found, int *idx) {
+    double best = INFINITY;
+    for (int r = 0; r < runs; r++) {
+        double start = now_ms();
+        *found = detector(tracker, idx);
+        double elapsed = now_ms() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+
+static void compare(const char *series, const double *prices, int count) {
+    static const struct {
+        const char *name;
+        ArrayDetector legacy;
+        ArrayDetector current;
+        PivotDetector pivot;
+    } detectors[] = {
+        { "double bottom", legacy_double_bottom, detect_double_bottom, pivot_detect_double_bottom },
+        { "double top", legacy_double_top, detect_double_top, pivot_detect_double_top },
+        { "head & shoulders", legacy_head_shoulders, detect_head_shoulders, pivot_detect_head_shoulders },
+        { "inverse h&s", legacy_inverse_head_shoulders, detect_inverse_head_shoulders,
+          pivot_detect_inverse_head_shoulders },
+    };
+    
+    PivotTracker tracker = {0};
+    double start = now_ms();
+    pivot_tracker_build(&tracker, prices, count);
+    double build = now_ms() - start;
+    
+    printf("%s, %d candles (tracker build %.2f ms)\n", series, count, build);
+    printf("  %-18s %12s %12s %12s   %s\n", "detector", "old ms", "new ms", "tracked ms", "match old / new");
+    for (size_t d = 0; d < sizeof(detectors) / sizeof(detectors[0]); d++) {
+        bool old_found, new_found, tracked_found;
+        int old_idx, new_idx, tracked_idx;
+        double old_ms = time_array(detectors[d].legacy, prices, count, 1, &old_found, &old_idx);
+        double new_ms = time_array(detectors[d].current, prices, count, 5, &new_found, &new_idx);
+        double tracked_ms = time_pivot(detectors[d].pivot, &tracker, 5, &tracked_found, &tracked_idx);
+        printf("  %-18s %12.3f %12.3f %12.3f   %d@%d / %d@%d\n", detectors[d].name, old_ms, new_ms, tracked_ms,
+               old_found, old_found ? old_idx : -1, new_found, new_found ? new_idx : -1);
+    }
+    printf("\n");
+    pivot_tracker_free(&tracker);
+}
+
+
+int main(void) {
+    double *prices = malloc(BENCH_CANDLES * sizeof(double));
+    if (!prices) return 1;
+    
+    printf("old: the rescanning detectors; new: detect_* building a tracker from scratch;\n"
+           "tracked: pivot_detect_* on a tracker kept current as candles arrive.\n\n");
+    
+    zigzag(prices, BENCH_CANDLES, 40, 0.008, 0.0004);
+    compare("Trending zigzag", prices, BENCH_CANDLES);
+    
+    random_walk(prices, BENCH_CANDLES, 7);
+    compare("Random walk", prices, BENCH_CANDLES);
+    
+    zigzag(prices, CUBIC_CANDLES, 40, 0.008, 0.0);
+    compare("Flat zigzag (the old detectors' cubic case)", prices, CUBIC_CANDLES);
+    
+    free(prices);
+    return 0;
+}